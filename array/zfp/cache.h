@@ -2,14 +2,22 @@
 #define ZFP_CACHE_H
 
 #include "memory.h"
+#include "cachepolicy.h"
+
+#ifdef _OPENMP
+  // striped locks for concurrent access
+  #include <omp.h>
+#endif
 
 #ifdef ZFP_WITH_CACHE_PROFILE
   // maintain stats on hit and miss rates
   #include <iostream>
 #endif
 
-// direct-mapped or two-way skew-associative write-back cache
-template <class Line>
+// write-back cache whose placement and replacement of lines is determined by
+// Policy (see cachepolicy.h); optionally guarded by striped locks for
+// concurrent access by multiple OpenMP threads
+template <class Line, class Policy = CacheDefaultPolicy>
 class Cache {
 public:
   // cache line index (zero is reserved for unused lines)
@@ -86,6 +94,9 @@ public:
 
   // allocate cache with at least minsize lines
   Cache(uint minsize = 0) : tag(0), line(0)
+#ifdef _OPENMP
+    , lock(0), smask(0)
+#endif
   {
     resize(minsize);
 #ifdef ZFP_WITH_CACHE_PROFILE
@@ -97,6 +108,9 @@ public:
 
   // copy constructor--performs a deep copy
   Cache(const Cache& c) : tag(0), line(0)
+#ifdef _OPENMP
+    , lock(0), smask(0)
+#endif
   {
     deep_copy(c);
   }
@@ -104,6 +118,7 @@ public:
   // destructor
   ~Cache()
   {
+    set_concurrent(false);
     deallocate(tag);
     deallocate(line);
 #ifdef ZFP_WITH_CACHE_PROFILE
@@ -127,23 +142,94 @@ public:
   void resize(uint minsize)
   {
     for (mask = minsize ? minsize - 1 : 1; mask & (mask + 1); mask |= mask + 1);
+    while (mask < policy.ways() - 1)
+      mask = 2 * mask + 1;
+    policy.resize(mask + 1);
     reallocate(tag, ((size_t)mask + 1) * sizeof(Tag), 0x100);
     reallocate(line, ((size_t)mask + 1) * sizeof(Line), 0x100);
     clear();
   }
 
+  // enable or disable locking for concurrent access; returns true if locking
+  // is enabled, which requires compilation with OpenMP
+  bool set_concurrent(bool enable)
+  {
+#ifdef _OPENMP
+    if (lock) {
+      for (uint s = 0; s <= smask; s++)
+        omp_destroy_lock(lock + s);
+      delete[] lock;
+      lock = 0;
+    }
+    if (enable) {
+      // use several stripes per thread to reduce lock contention
+      uint n = 8 * uint(omp_get_max_threads());
+      for (smask = n - 1; smask & (smask + 1); smask |= smask + 1);
+      lock = new omp_lock_t[smask + 1];
+      for (uint s = 0; s <= smask; s++)
+        omp_init_lock(lock + s);
+    }
+    return enable;
+#else
+    static_cast<void>(enable);
+    return false;
+#endif
+  }
+
+  // is locking for concurrent access enabled?
+  bool concurrent() const
+  {
+#ifdef _OPENMP
+    return lock != 0;
+#else
+    return false;
+#endif
+  }
+
+  // number of lock stripes (zero if locking is disabled)
+  uint stripes() const { return concurrent() ? stripe_mask() + 1 : 0; }
+
+  // acquire lock(s) on the cache slots where line #x may be stored and return
+  // the stripe of its primary slot; the caller must hold the lock while
+  // calling access() or using the returned line
+  uint acquire(Index x) const
+  {
+    uint i = first_stripe(x);
+#ifdef _OPENMP
+    // lock stripes in ascending order to avoid deadlock
+    uint j = last_stripe(x);
+    if (j < i)
+      omp_set_lock(lock + j);
+    omp_set_lock(lock + i);
+    if (j > i)
+      omp_set_lock(lock + j);
+#endif
+    return i;
+  }
+
+  // release lock(s) acquired for line #x
+  void release(Index x) const
+  {
+#ifdef _OPENMP
+    uint i = first_stripe(x);
+    omp_unset_lock(lock + i);
+    uint j = last_stripe(x);
+    if (j != i)
+      omp_unset_lock(lock + j);
+#else
+    static_cast<void>(x);
+#endif
+  }
+
   // look up cache line #x and return pointer to it if in the cache;
   // otherwise return null
   const Line* lookup(Index x) const
   {
-    uint i = primary(x);
-    if (tag[i].index() == x)
-      return line + i;
-#ifdef ZFP_WITH_CACHE_TWOWAY
-    uint j = secondary(x);
-    if (tag[j].index() == x)
-      return line + j;
-#endif
+    for (uint k = 0; k < policy.ways(); k++) {
+      uint i = policy.slot(x, k);
+      if (tag[i].index() == x)
+        return line + i;
+    }
     return 0;
   }
 
@@ -152,30 +238,21 @@ public:
   // write-back (if the line is in use) and then fetch the requested line
   Tag access(Line*& ptr, Index x, bool write)
   {
-    uint i = primary(x);
-    if (tag[i].index() == x) {
-      ptr = line + i;
-      if (write)
-        tag[i].mark();
+    for (uint k = 0; k < policy.ways(); k++) {
+      uint i = policy.slot(x, k);
+      if (tag[i].index() == x) {
+        ptr = line + i;
+        if (write)
+          tag[i].mark();
+        policy.touch(i);
 #ifdef ZFP_WITH_CACHE_PROFILE
-      hit[0][write]++;
+        hit[k != 0][write]++;
 #endif
-      return tag[i];
-    }
-#ifdef ZFP_WITH_CACHE_TWOWAY
-    uint j = secondary(x);
-    if (tag[j].index() == x) {
-      ptr = line + j;
-      if (write)
-        tag[j].mark();
-#ifdef ZFP_WITH_CACHE_PROFILE
-      hit[1][write]++;
-#endif
-      return tag[j];
+        return tag[i];
+      }
     }
-    // cache line not found; prefer primary and not dirty slots
-    i = tag[j].used() && (!tag[i].dirty() || tag[j].dirty()) ? i : j;
-#endif
+    // cache line not found; let policy choose which line to replace
+    uint i = policy.replace(tag, x);
     ptr = line + i;
     Tag t = tag[i];
     tag[i] = Tag(x, write);
@@ -192,6 +269,7 @@ public:
   {
     for (uint i = 0; i <= mask; i++)
       tag[i].clear();
+    policy.clear();
   }
 
   // flush cache line
@@ -204,11 +282,21 @@ public:
   // return iterator to first cache line
   const_iterator first() { return const_iterator(this); }
 
+  // return line held in slot i, with 0 <= i < size(), and set t to its tag;
+  // unlike first(), this permits slots to be visited in parallel
+  const Line* slot(uint i, Tag& t) const
+  {
+    t = tag[i];
+    return line + i;
+  }
+
 protected:
   // perform a deep copy
   void deep_copy(const Cache& c)
   {
+    set_concurrent(c.concurrent());
     mask = c.mask;
+    policy = c.policy;
     clone(tag, c.tag, mask + 1, 0x100u);
     clone(line, c.line, mask + 1, 0x100u);
 #ifdef ZFP_WITH_CACHE_PROFILE
@@ -223,32 +311,29 @@ protected:
 #endif
   }
 
-  uint primary(Index x) const { return x & mask; }
-  uint secondary(Index x) const
+  // lock stripes of first and last slot where line #x may be stored
+  uint first_stripe(Index x) const { return policy.group(policy.slot(x, 0)) & stripe_mask(); }
+  uint last_stripe(Index x) const { return policy.group(policy.slot(x, policy.ways() - 1)) & stripe_mask(); }
+
+  uint stripe_mask() const
   {
-#ifdef ZFP_WITH_CACHE_FAST_HASH
-    // max entropy hash for 26- to 16-bit mapping (not full avalanche)
-    x -= x <<  7;
-    x ^= x >> 16;
-    x -= x <<  3;
+#ifdef _OPENMP
+    return smask;
 #else
-    // Jenkins hash; see http://burtleburtle.net/bob/hash/integer.html
-    x -= x <<  6;
-    x ^= x >> 17;
-    x -= x <<  9;
-    x ^= x <<  4;
-    x -= x <<  3;
-    x ^= x << 10;
-    x ^= x >> 15;
+    return 0;
 #endif
-    return x & mask;
   }
 
   Index mask; // cache line mask
   Tag* tag;   // cache line tags
   Line* line; // actual decompressed cache lines
+  Policy policy; // placement and replacement policy
+#ifdef _OPENMP
+  omp_lock_t* lock; // striped locks guarding cache slots (or null)
+  uint smask;       // lock stripe mask
+#endif
 #ifdef ZFP_WITH_CACHE_PROFILE
-  uint64 hit[2][2]; // number of primary/secondary read/write hits
+  uint64 hit[2][2]; // number of read/write hits in first/other candidate slots
   uint64 miss[2];   // number of read/write misses
   uint64 back[2];   // number of write-backs due to read/writes
 #endif
@@ -0,0 +1,399 @@
+#ifndef ZFP_CACHE_POLICY_H
+#define ZFP_CACHE_POLICY_H
+
+#include "memory.h"
+
+// Placement and replacement policies for Cache<Line, Policy>.  A policy
+// determines which cache slots may hold line #x and which line to evict on
+// a miss.  Each policy implements
+//
+//   uint ways() const                       number of slots that may hold a line
+//   uint slot(uint x, uint k) const         k-th slot that may hold line #x
+//   uint group(uint i) const                group of slots sharing state with slot i
+//   void resize(uint size)                  allocate state for size slots
+//   void clear()                            reset state of empty cache
+//   void touch(uint i)                      record hit on slot i
+//   uint replace(const Tag* tag, uint x)    pick slot for line #x on a miss
+//
+// Cache sizes are powers of two no smaller than ways().  Slots in the same
+// group are guarded by the same lock, and the slots of line #x must lie in
+// the groups of slot(x, 0) and slot(x, ways() - 1).  Policies with state
+// update it only in touch() and replace(), which the cache calls with the
+// locks of the line held.
+
+// direct-mapped: line #x may only be held in slot x mod size
+class CacheDirectMapped {
+public:
+  CacheDirectMapped() : mask(0) {}
+
+  uint ways() const { return 1; }
+  uint slot(uint x, uint) const { return x & mask; }
+  uint group(uint i) const { return i; }
+  void resize(uint size) { mask = size - 1; }
+  void clear() {}
+  void touch(uint) {}
+
+  template <class Tag>
+  uint replace(const Tag*, uint x) { return x & mask; }
+
+protected:
+  uint mask; // slot mask
+};
+
+// two-way skew-associative: line #x may be held in a primary slot given by
+// its low bits or in a secondary slot given by a hash of x
+class CacheTwoWay {
+public:
+  CacheTwoWay() : mask(0) {}
+
+  uint ways() const { return 2; }
+  uint slot(uint x, uint k) const { return k ? secondary(x) : x & mask; }
+  uint group(uint i) const { return i; }
+  void resize(uint size) { mask = size - 1; }
+  void clear() {}
+  void touch(uint) {}
+
+  // prefer primary and not dirty slots
+  template <class Tag>
+  uint replace(const Tag* tag, uint x)
+  {
+    uint i = x & mask;
+    uint j = secondary(x);
+    return tag[j].used() && (!tag[i].dirty() || tag[j].dirty()) ? i : j;
+  }
+
+protected:
+  uint secondary(uint x) const
+  {
+#ifdef ZFP_WITH_CACHE_FAST_HASH
+    // max entropy hash for 26- to 16-bit mapping (not full avalanche)
+    x -= x <<  7;
+    x ^= x >> 16;
+    x -= x <<  3;
+#else
+    // Jenkins hash; see http://burtleburtle.net/bob/hash/integer.html
+    x -= x <<  6;
+    x ^= x >> 17;
+    x -= x <<  9;
+    x ^= x <<  4;
+    x -= x <<  3;
+    x ^= x << 10;
+    x ^= x >> 15;
+#endif
+    return x & mask;
+  }
+
+  uint mask; // slot mask
+};
+
+// base class for W-way set-associative policies, where line #x may be held
+// in any of the W consecutive slots of its set; W must be a power of two no
+// larger than 256.  Sets are indexed by XOR-folding the line index so that
+// lines separated by a large power-of-two stride, as when sweeping along the
+// slowest varying array dimension, map to different sets.
+template <uint W>
+class CacheSetAssociative {
+public:
+  uint ways() const { return W; }
+  uint slot(uint x, uint k) const { return ((x ^ x >> shift ^ x >> 2 * shift) & smask) * W + k; }
+  uint group(uint i) const { return i / W; }
+
+protected:
+  // compile-time check that W is a power of two in [1, 256]
+  typedef char valid_ways[!W || (W & (W - 1)) || W > 0x100u ? -1 : 1];
+
+  CacheSetAssociative() : size(0), smask(0), shift(0) {}
+
+  void resize(uint n)
+  {
+    size = n;
+    smask = n / W - 1;
+    for (shift = 0; smask >> shift && shift < 15; shift++);
+  }
+
+  // first unused slot in set beginning with slot s, or s + W if set is full
+  template <class Tag>
+  static uint unused(const Tag* tag, uint s)
+  {
+    uint i;
+    for (i = s; i < s + W && tag[i].used(); i++);
+    return i;
+  }
+
+  uint size;  // number of slots
+  uint smask; // set mask
+  uint shift; // number of bits in set index (at most 15)
+};
+
+// W-way set-associative with least-recently-used replacement
+template <uint W = 4>
+class CacheLRU : public CacheSetAssociative<W> {
+public:
+  CacheLRU() : age(0) {}
+  CacheLRU(const CacheLRU& p) : CacheSetAssociative<W>(p), age(0) { clone(age, p.age, p.size); }
+  ~CacheLRU() { deallocate(age); }
+
+  CacheLRU& operator=(const CacheLRU& p)
+  {
+    if (this != &p) {
+      CacheSetAssociative<W>::operator=(p);
+      clone(age, p.age, p.size);
+    }
+    return *this;
+  }
+
+  void resize(uint size)
+  {
+    CacheSetAssociative<W>::resize(size);
+    reallocate(age, size);
+  }
+
+  void clear()
+  {
+    for (uint i = 0; i < this->size; i++)
+      age[i] = uchar(i % W);
+  }
+
+  // make slot i the most recently used one in its set
+  void touch(uint i)
+  {
+    uint s = i - i % W;
+    for (uint j = s; j < s + W; j++)
+      if (age[j] < age[i])
+        age[j]++;
+    age[i] = 0;
+  }
+
+  // replace least recently used line, or fill unused slot if any
+  template <class Tag>
+  uint replace(const Tag* tag, uint x)
+  {
+    uint s = this->slot(x, 0);
+    uint i = this->unused(tag, s);
+    if (i == s + W)
+      for (uint j = i = s; j < s + W; j++)
+        if (age[j] > age[i])
+          i = j;
+    touch(i);
+    return i;
+  }
+
+protected:
+  uchar* age; // recency rank of each slot within its set (zero for most recent)
+};
+
+// W-way set-associative with CLOCK (second chance) replacement; new lines
+// start out unreferenced so that a single sweep through an array does not
+// displace lines that have been accessed more than once
+template <uint W = 4>
+class CacheClock : public CacheSetAssociative<W> {
+public:
+  CacheClock() : ref(0), hand(0) {}
+  CacheClock(const CacheClock& p) : CacheSetAssociative<W>(p), ref(0), hand(0) { deep_copy(p); }
+  ~CacheClock()
+  {
+    deallocate(ref);
+    deallocate(hand);
+  }
+
+  CacheClock& operator=(const CacheClock& p)
+  {
+    if (this != &p) {
+      CacheSetAssociative<W>::operator=(p);
+      deep_copy(p);
+    }
+    return *this;
+  }
+
+  void resize(uint size)
+  {
+    CacheSetAssociative<W>::resize(size);
+    reallocate(ref, size);
+    reallocate(hand, size / W);
+  }
+
+  void clear()
+  {
+    std::fill(ref, ref + this->size, uchar(0));
+    std::fill(hand, hand + this->size / W, uchar(0));
+  }
+
+  void touch(uint i) { ref[i] = 1; }
+
+  // advance clock hand past referenced lines, clearing their reference bits,
+  // and replace first unreferenced line, or fill unused slot if any
+  template <class Tag>
+  uint replace(const Tag* tag, uint x)
+  {
+    uint s = this->slot(x, 0);
+    uint i = this->unused(tag, s);
+    if (i == s + W) {
+      uchar& h = hand[s / W];
+      while (ref[s + h]) {
+        ref[s + h] = 0;
+        h = uchar((h + 1) % W);
+      }
+      i = s + h;
+      h = uchar((h + 1) % W);
+    }
+    ref[i] = 0;
+    return i;
+  }
+
+protected:
+  void deep_copy(const CacheClock& p)
+  {
+    clone(ref, p.ref, p.size);
+    clone(hand, p.hand, p.size / W);
+  }
+
+  uchar* ref;  // reference bit of each slot
+  uchar* hand; // clock hand of each set
+};
+
+// W-way set-associative with adaptive replacement (ARC; Megiddo and Modha,
+// FAST 2003) applied independently to each set.  Resident lines are split
+// into a recency list T1 of lines accessed once and a frequency list T2 of
+// lines accessed more than once; ghost lists B1 and B2 remember the indices
+// of lines recently evicted from T1 and T2.  A miss on a ghost grows the
+// target size of the list that would have kept it, which lets the set adapt
+// between LRU (for reuse) and scan resistance (for streaming sweeps).
+template <uint W = 4>
+class CacheARC : public CacheLRU<W> {
+public:
+  CacheARC() : list(0), ghost(0), target(0) {}
+  CacheARC(const CacheARC& p) : CacheLRU<W>(p), list(0), ghost(0), target(0) { deep_copy(p); }
+  ~CacheARC()
+  {
+    deallocate(list);
+    deallocate(ghost);
+    deallocate(target);
+  }
+
+  CacheARC& operator=(const CacheARC& p)
+  {
+    if (this != &p) {
+      CacheLRU<W>::operator=(p);
+      deep_copy(p);
+    }
+    return *this;
+  }
+
+  void resize(uint size)
+  {
+    CacheLRU<W>::resize(size);
+    reallocate(list, size);
+    reallocate(ghost, 2 * size * sizeof(uint));
+    reallocate(target, size / W);
+  }
+
+  void clear()
+  {
+    CacheLRU<W>::clear();
+    std::fill(list, list + this->size, uchar(0));
+    std::fill(ghost, ghost + 2 * this->size, 0u);
+    std::fill(target, target + this->size / W, uchar(0));
+  }
+
+  // move line in slot i to front of T2
+  void touch(uint i)
+  {
+    list[i] = 1;
+    CacheLRU<W>::touch(i);
+  }
+
+  template <class Tag>
+  uint replace(const Tag* tag, uint x)
+  {
+    uint s = this->slot(x, 0);
+    uint* b1 = ghost + 2 * s;
+    uint* b2 = b1 + W;
+    uchar& p = target[s / W];
+    // count lines in T1 and T2 and find an unused slot
+    uint t[2] = { 0, 0 };
+    uint i = s + W;
+    for (uint j = s; j < s + W; j++)
+      if (tag[j].used())
+        t[list[j]]++;
+      else
+        i = j;
+    // on a ghost hit, adapt target size of T1 and insert x into T2
+    uint n1 = length(b1);
+    uint n2 = length(b2);
+    uint l = 0;
+    if (remove(b1, x)) {
+      p = uchar(std::min(uint(p) + std::max(n2 / n1, 1u), W));
+      l = 1;
+    }
+    else if (remove(b2, x)) {
+      p = uchar(p - std::min(uint(p), std::max(n1 / n2, 1u)));
+      l = 2;
+    }
+    // if set is full, evict least recently used line of T1 if T1 exceeds its
+    // target size and T2 otherwise, and remember its index in B1 or B2
+    if (i == s + W) {
+      uint k = t[0] && (t[0] > p || (l == 2 && t[0] == p) || !t[1]) ? 0 : 1;
+      for (uint j = s; j < s + W; j++)
+        if (list[j] == k && (i == s + W || this->age[j] > this->age[i]))
+          i = j;
+      push(k ? b2 : b1, tag[i].index());
+      t[k]--;
+    }
+    // insert x into T1 on a miss and into T2 on a ghost hit
+    list[i] = uchar(l != 0);
+    t[list[i]]++;
+    CacheLRU<W>::touch(i);
+    // keep |T1| + |B1| <= W
+    for (uint n = length(b1); t[0] + n > W; n--)
+      b1[n - 1] = 0;
+    return i;
+  }
+
+protected:
+  void deep_copy(const CacheARC& p)
+  {
+    clone(list, p.list, p.size);
+    clone(ghost, p.ghost, 2 * p.size);
+    clone(target, p.target, p.size / W);
+  }
+
+  // number of entries in ghost list b
+  static uint length(const uint* b)
+  {
+    uint n;
+    for (n = 0; n < W && b[n]; n++);
+    return n;
+  }
+
+  // remove x from ghost list b; return true if found
+  static bool remove(uint* b, uint x)
+  {
+    for (uint n = 0; n < W && b[n]; n++)
+      if (b[n] == x) {
+        std::copy(b + n + 1, b + W, b + n);
+        b[W - 1] = 0;
+        return true;
+      }
+    return false;
+  }
+
+  // insert x at front of ghost list b, discarding its last entry if full
+  static void push(uint* b, uint x)
+  {
+    std::copy_backward(b, b + W - 1, b + W);
+    b[0] = x;
+  }
+
+  uchar* list;   // list (0 for T1, 1 for T2) of each resident line
+  uint* ghost;   // per set, indices of lines in B1 and B2, most recent first
+  uchar* target; // per set, target size of T1
+};
+
+// default policy selected at compile time
+#ifdef ZFP_WITH_CACHE_TWOWAY
+typedef CacheTwoWay CacheDefaultPolicy;
+#else
+typedef CacheDirectMapped CacheDefaultPolicy;
+#endif
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef ZFP_MAPPING_H
+#define ZFP_MAPPING_H
+
+#include <cstddef>
+#include "zfp/types.h"
+
+// POSIX file mapping of compressed array storage; on other platforms no file
+// can be opened, and arrays keep their compressed data in memory
+#if defined(__unix__) || defined(__APPLE__)
+  #include <unistd.h>
+  #ifdef _POSIX_MAPPED_FILES
+    #define ZFP_ARRAY_MMAP
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+  #endif
+#endif
+
+// open file to be mapped; return its descriptor or -1 upon failure
+inline int
+open_mapped_file(const char* path, bool read_only)
+{
+#ifdef ZFP_ARRAY_MMAP
+  return ::open(path, read_only ? O_RDONLY : O_RDWR | O_CREAT, 0666);
+#else
+  static_cast<void>(path);
+  static_cast<void>(read_only);
+  return -1;
+#endif
+}
+
+// map 'size' bytes of file into memory, extending the file if needed;
+// read-only files are mapped copy-on-write
+inline bool
+map_file(int fd, size_t size, bool read_only, uchar*& buffer)
+{
+  buffer = 0;
+#ifdef ZFP_ARRAY_MMAP
+  if (!size)
+    return true;
+  struct stat st;
+  if (fstat(fd, &st) != 0)
+    return false;
+  if (size_t(st.st_size) < size && (read_only || ftruncate(fd, off_t(size)) != 0))
+    return false;
+  void* p = mmap(0, size, PROT_READ | PROT_WRITE, read_only ? MAP_PRIVATE : MAP_SHARED, fd, 0);
+  if (p == MAP_FAILED)
+    return false;
+  buffer = static_cast<uchar*>(p);
+  return true;
+#else
+  static_cast<void>(fd);
+  static_cast<void>(size);
+  static_cast<void>(read_only);
+  return false;
+#endif
+}
+
+// release mapping of 'size' bytes at buffer
+inline void
+unmap_file(uchar* buffer, size_t size)
+{
+#ifdef ZFP_ARRAY_MMAP
+  if (buffer)
+    munmap(buffer, size);
+#else
+  static_cast<void>(buffer);
+  static_cast<void>(size);
+#endif
+}
+
+// close file opened by open_mapped_file()
+inline void
+close_mapped_file(int fd)
+{
+#ifdef ZFP_ARRAY_MMAP
+  ::close(fd);
+#else
+  static_cast<void>(fd);
+#endif
+}
+
+#endif
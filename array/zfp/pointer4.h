@@ -0,0 +1,54 @@
+// pointer to a 4D array element; this class is nested within zfp::array4
+class pointer {
+public:
+  pointer() : ref(0, 0, 0, 0, 0) {}
+  pointer operator=(const pointer& p) { ref.array = p.ref.array; ref.i = p.ref.i; ref.j = p.ref.j; ref.k = p.ref.k; ref.l = p.ref.l; return *this; }
+  reference operator*() const { return ref; }
+  reference operator[](ptrdiff_t d) const { return *operator+(d); }
+  pointer& operator++() { increment(); return *this; }
+  pointer& operator--() { decrement(); return *this; }
+  pointer operator++(int) { pointer p = *this; increment(); return p; }
+  pointer operator--(int) { pointer p = *this; decrement(); return p; }
+  pointer operator+=(ptrdiff_t d) { set(index() + d); return *this; }
+  pointer operator-=(ptrdiff_t d) { set(index() - d); return *this; }
+  pointer operator+(ptrdiff_t d) const { pointer p = *this; p += d; return p; }
+  pointer operator-(ptrdiff_t d) const { pointer p = *this; p -= d; return p; }
+  ptrdiff_t operator-(const pointer& p) const { return index() - p.index(); }
+  bool operator==(const pointer& p) const { return ref.array == p.ref.array && ref.i == p.ref.i && ref.j == p.ref.j && ref.k == p.ref.k && ref.l == p.ref.l; }
+  bool operator!=(const pointer& p) const { return !operator==(p); }
+
+protected:
+  friend class array4;
+  friend class reference;
+  explicit pointer(reference r) : ref(r) {}
+  explicit pointer(array4* array, uint i, uint j, uint k, uint l) : ref(array, i, j, k, l) {}
+  ptrdiff_t index() const { return ref.i + ref.array->nx * (ref.j + ref.array->ny * (ref.k + ref.array->nz * ref.l)); }
+  void set(ptrdiff_t index) { ref.array->ijkl(ref.i, ref.j, ref.k, ref.l, index); }
+  void increment()
+  {
+    if (++ref.i == ref.array->nx) {
+      ref.i = 0;
+      if (++ref.j == ref.array->ny) {
+        ref.j = 0;
+        if (++ref.k == ref.array->nz) {
+          ref.k = 0;
+          ref.l++;
+        }
+      }
+    }
+  }
+  void decrement()
+  {
+    if (!ref.i--) {
+      ref.i = ref.array->nx - 1;
+      if (!ref.j--) {
+        ref.j = ref.array->ny - 1;
+        if (!ref.k--) {
+          ref.k = ref.array->nz - 1;
+          ref.l--;
+        }
+      }
+    }
+  }
+  reference ref;
+};
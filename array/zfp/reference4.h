@@ -0,0 +1,27 @@
+// reference to a 4D array element; this class is nested within zfp::array4
+class reference {
+public:
+  operator Scalar() const { return array->get(i, j, k, l); }
+  reference operator=(const reference& r) { array->set(i, j, k, l, r.operator Scalar()); return *this; }
+  reference operator=(Scalar val) { array->set(i, j, k, l, val); return *this; }
+  reference operator+=(Scalar val) { array->add(i, j, k, l, val); return *this; }
+  reference operator-=(Scalar val) { array->sub(i, j, k, l, val); return *this; }
+  reference operator*=(Scalar val) { array->mul(i, j, k, l, val); return *this; }
+  reference operator/=(Scalar val) { array->div(i, j, k, l, val); return *this; }
+  pointer operator&() const { return pointer(*this); }
+  // swap two array elements via proxy references
+  friend void swap(reference a, reference b)
+  {
+    Scalar x = a.operator Scalar();
+    Scalar y = b.operator Scalar();
+    b.operator=(x);
+    a.operator=(y);
+  }
+
+protected:
+  friend class array4;
+  friend class iterator;
+  explicit reference(array4* array, uint i, uint j, uint k, uint l) : array(array), i(i), j(j), k(k), l(l) {}
+  array4* array;
+  uint i, j, k, l;
+};
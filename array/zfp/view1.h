@@ -155,7 +155,7 @@ protected:
   {
     CacheLine* p = 0;
     uint b = array->block(i);
-    typename Cache<CacheLine>::Tag t = cache.access(p, b + 1, false);
+    typename Cache<CacheLine, Policy>::Tag t = cache.access(p, b + 1, false);
     uint c = t.index() - 1;
     // fetch cache line; no writeback possible since view is read-only
     if (c != b)
@@ -163,15 +163,42 @@ protected:
     return p;
   }
 
-  // decode block with given index
+  // decode block with given index; variable-size blocks, which views may
+  // relocate when writing back, are accessed by one view at a time
   void decode(uint index, Scalar* block) const
   {
-    stream_rseek(zfp->stream, index * array->blkbits);
+    if (array->variable_rate()) {
+#ifdef _OPENMP
+      #pragma omp critical(zfp_variable_rate)
+#endif
+      {
+        rebind();
+        decode_block(index, block);
+      }
+    }
+    else
+      decode_block(index, block);
+  }
+
+  // decode block with given index from private stream
+  void decode_block(uint index, Scalar* block) const
+  {
+    stream_rseek(zfp->stream, array->block_offset(index));
     Codec::decode_block_1(zfp, block, array->shape ? array->shape[index] : 0);
   }
 
+  // rebind private stream to array storage reallocated by compaction
+  void rebind() const
+  {
+    if (stream_data(zfp->stream) != stream_data(array->zfp->stream) ||
+        stream_capacity(zfp->stream) != stream_capacity(array->zfp->stream)) {
+      stream_close(zfp->stream);
+      zfp->stream = stream_clone(array->zfp->stream);
+    }
+  }
+
   zfp_stream* zfp;                // stream of compressed blocks
-  mutable Cache<CacheLine> cache; // cache of decompressed blocks
+  mutable Cache<CacheLine, Policy> cache; // cache of decompressed blocks
 };
 
 // thread-safe read-write view of private 1D (sub)array
@@ -200,7 +227,7 @@ public:
   // flush cache by compressing all modified cached blocks
   void flush_cache() const
   {
-    for (typename Cache<CacheLine>::const_iterator p = cache.first(); p; p++) {
+    for (typename Cache<CacheLine, Policy>::const_iterator p = cache.first(); p; p++) {
       if (p->tag.dirty()) {
         uint b = p->tag.index() - 1;
         encode(b, p->line->data());
@@ -270,7 +297,7 @@ protected:
   {
     CacheLine* p = 0;
     uint b = array->block(i);
-    typename Cache<CacheLine>::Tag t = cache.access(p, b + 1, write);
+    typename Cache<CacheLine, Policy>::Tag t = cache.access(p, b + 1, write);
     uint c = t.index() - 1;
     if (c != b) {
       // write back occupied cache line if it is dirty
@@ -284,6 +311,14 @@ protected:
   // encode block with given index
   void encode(uint index, const Scalar* block) const
   {
+    // variable-size blocks are stored via the array one view at a time
+    if (array->variable_rate()) {
+#ifdef _OPENMP
+      #pragma omp critical(zfp_variable_rate)
+#endif
+      array->encode(index, block);
+      return;
+    }
     stream_wseek(zfp->stream, index * array->blkbits);
     Codec::encode_block_1(zfp, block, array->shape ? array->shape[index] : 0);
     stream_flush(zfp->stream);
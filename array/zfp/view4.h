@@ -0,0 +1,537 @@
+// 4D array views; these classes are nested within zfp::array4
+
+// abstract view of 4D array (base class)
+class preview {
+public:
+  // rate in bits per value
+  double rate() const { return array->rate(); }
+
+  // dimensions of (sub)array
+  size_t size() const { return size_t(nx) * size_t(ny) * size_t(nz) * size_t(nw); }
+
+  // local to global array indices
+  uint global_x(uint i) const { return x + i; }
+  uint global_y(uint j) const { return y + j; }
+  uint global_z(uint k) const { return z + k; }
+  uint global_w(uint l) const { return w + l; }
+
+protected:
+  // construction and assignment--perform shallow copy of (sub)array
+  explicit preview(array4* array) : array(array), x(0), y(0), z(0), w(0), nx(array->nx), ny(array->ny), nz(array->nz), nw(array->nw) {}
+  explicit preview(array4* array, uint x, uint y, uint z, uint w, uint nx, uint ny, uint nz, uint nw) : array(array), x(x), y(y), z(z), w(w), nx(nx), ny(ny), nz(nz), nw(nw) {}
+  preview& operator=(array4* a)
+  {
+    array = a;
+    x = y = z = w = 0;
+    nx = a->nx;
+    ny = a->ny;
+    nz = a->nz;
+    nw = a->nw;
+    return *this;
+  }
+
+  array4* array;       // underlying container
+  uint x, y, z, w;     // offset into array
+  uint nx, ny, nz, nw; // dimensions of subarray
+};
+
+// generic read-only view into a rectangular subset of a 4D array
+class const_view : public preview {
+protected:
+  using preview::array;
+  using preview::x;
+  using preview::y;
+  using preview::z;
+  using preview::w;
+  using preview::nx;
+  using preview::ny;
+  using preview::nz;
+  using preview::nw;
+public:
+  // construction--perform shallow copy of (sub)array
+  const_view(array4* array) : preview(array) {}
+  const_view(array4* array, uint x, uint y, uint z, uint w, uint nx, uint ny, uint nz, uint nw) : preview(array, x, y, z, w, nx, ny, nz, nw) {}
+
+  // dimensions of (sub)array
+  uint size_x() const { return nx; }
+  uint size_y() const { return ny; }
+  uint size_z() const { return nz; }
+  uint size_w() const { return nw; }
+
+  // (i, j, k, l) accessor
+  Scalar operator()(uint i, uint j, uint k, uint l) const { return array->get(x + i, y + j, z + k, w + l); }
+};
+
+// generic read-write view into a rectangular subset of a 4D array
+class view : public const_view {
+protected:
+  using preview::array;
+  using preview::x;
+  using preview::y;
+  using preview::z;
+  using preview::w;
+  using preview::nx;
+  using preview::ny;
+  using preview::nz;
+  using preview::nw;
+public:
+  // construction--perform shallow copy of (sub)array
+  view(array4* array) : const_view(array) {}
+  view(array4* array, uint x, uint y, uint z, uint w, uint nx, uint ny, uint nz, uint nw) : const_view(array, x, y, z, w, nx, ny, nz, nw) {}
+
+  // (i, j, k, l) accessor from base class
+  using const_view::operator();
+
+  // (i, j, k, l) mutator
+  reference operator()(uint i, uint j, uint k, uint l) { return reference(array, x + i, y + j, z + k, w + l); }
+};
+
+// flat view of 4D array (operator[] returns scalar)
+class flat_view : public view {
+protected:
+  using preview::array;
+  using preview::x;
+  using preview::y;
+  using preview::z;
+  using preview::w;
+  using preview::nx;
+  using preview::ny;
+  using preview::nz;
+  using preview::nw;
+public:
+  // construction--perform shallow copy of (sub)array
+  flat_view(array4* array) : view(array) {}
+  flat_view(array4* array, uint x, uint y, uint z, uint w, uint nx, uint ny, uint nz, uint nw) : view(array, x, y, z, w, nx, ny, nz, nw) {}
+
+  // convert (i, j, k, l) index to flat index
+  uint index(uint i, uint j, uint k, uint l) const { return i + nx * (j + ny * (k + nz * l)); }
+
+  // convert flat index to (i, j, k, l) index
+  void ijkl(uint& i, uint& j, uint& k, uint& l, uint index) const
+  {
+    i = index % nx; index /= nx;
+    j = index % ny; index /= ny;
+    k = index % nz; index /= nz;
+    l = index;
+  }
+
+  // flat index accessors
+  Scalar operator[](uint index) const
+  {
+    uint i, j, k, l;
+    ijkl(i, j, k, l, index);
+    return array->get(x + i, y + j, z + k, w + l);
+  }
+  reference operator[](uint index)
+  {
+    uint i, j, k, l;
+    ijkl(i, j, k, l, index);
+    return reference(array, x + i, y + j, z + k, w + l);
+  }
+};
+
+// forward declaration of friends
+class nested_view1;
+class nested_view2;
+class nested_view3;
+class nested_view4;
+
+// nested view into a 1D rectangular subset of a 4D array
+class nested_view1 : public preview {
+protected:
+  using preview::array;
+  using preview::x;
+  using preview::y;
+  using preview::z;
+  using preview::w;
+  using preview::nx;
+  using preview::ny;
+  using preview::nz;
+  using preview::nw;
+public:
+  // dimensions of (sub)array
+  uint size_x() const { return nx; }
+
+  // [i] accessor and mutator
+  Scalar operator[](uint index) const { return array->get(x + index, y, z, w); }
+  reference operator[](uint index) { return reference(array, x + index, y, z, w); }
+
+  // (i) accessor and mutator
+  Scalar operator()(uint i) const { return array->get(x + i, y, z, w); }
+  reference operator()(uint i) { return reference(array, x + i, y, z, w); }
+
+protected:
+  // construction--perform shallow copy of (sub)array
+  friend class nested_view2;
+  explicit nested_view1(array4* array) : preview(array) {}
+  explicit nested_view1(array4* array, uint x, uint y, uint z, uint w, uint nx, uint ny, uint nz, uint nw) : preview(array, x, y, z, w, nx, ny, nz, nw) {}
+};
+
+// nested view into a 2D rectangular subset of a 4D array
+class nested_view2 : public preview {
+protected:
+  using preview::array;
+  using preview::x;
+  using preview::y;
+  using preview::z;
+  using preview::w;
+  using preview::nx;
+  using preview::ny;
+  using preview::nz;
+  using preview::nw;
+public:
+  // dimensions of (sub)array
+  uint size_x() const { return nx; }
+  uint size_y() const { return ny; }
+
+  // 1D view
+  nested_view1 operator[](uint index) const { return nested_view1(array, x, y + index, z, w, nx, 1, 1, 1); }
+
+  // (i, j) accessor and mutator
+  Scalar operator()(uint i, uint j) const { return array->get(x + i, y + j, z, w); }
+  reference operator()(uint i, uint j) { return reference(array, x + i, y + j, z, w); }
+
+protected:
+  // construction--perform shallow copy of (sub)array
+  friend class nested_view3;
+  explicit nested_view2(array4* array) : preview(array) {}
+  explicit nested_view2(array4* array, uint x, uint y, uint z, uint w, uint nx, uint ny, uint nz, uint nw) : preview(array, x, y, z, w, nx, ny, nz, nw) {}
+};
+
+// nested view into a 3D rectangular subset of a 4D array
+class nested_view3 : public preview {
+protected:
+  using preview::array;
+  using preview::x;
+  using preview::y;
+  using preview::z;
+  using preview::w;
+  using preview::nx;
+  using preview::ny;
+  using preview::nz;
+  using preview::nw;
+public:
+  // dimensions of (sub)array
+  uint size_x() const { return nx; }
+  uint size_y() const { return ny; }
+  uint size_z() const { return nz; }
+
+  // 2D view
+  nested_view2 operator[](uint index) const { return nested_view2(array, x, y, z + index, w, nx, ny, 1, 1); }
+
+  // (i, j, k) accessor and mutator
+  Scalar operator()(uint i, uint j, uint k) const { return array->get(x + i, y + j, z + k, w); }
+  reference operator()(uint i, uint j, uint k) { return reference(array, x + i, y + j, z + k, w); }
+
+protected:
+  // construction--perform shallow copy of (sub)array
+  friend class nested_view4;
+  explicit nested_view3(array4* array) : preview(array) {}
+  explicit nested_view3(array4* array, uint x, uint y, uint z, uint w, uint nx, uint ny, uint nz, uint nw) : preview(array, x, y, z, w, nx, ny, nz, nw) {}
+};
+
+// nested view into a 4D rectangular subset of a 4D array
+class nested_view4 : public preview {
+protected:
+  using preview::array;
+  using preview::x;
+  using preview::y;
+  using preview::z;
+  using preview::w;
+  using preview::nx;
+  using preview::ny;
+  using preview::nz;
+  using preview::nw;
+public:
+  // construction--perform shallow copy of (sub)array
+  nested_view4(array4* array) : preview(array) {}
+  nested_view4(array4* array, uint x, uint y, uint z, uint w, uint nx, uint ny, uint nz, uint nw) : preview(array, x, y, z, w, nx, ny, nz, nw) {}
+
+  // dimensions of (sub)array
+  uint size_x() const { return nx; }
+  uint size_y() const { return ny; }
+  uint size_z() const { return nz; }
+  uint size_w() const { return nw; }
+
+  // 3D view
+  nested_view3 operator[](uint index) const { return nested_view3(array, x, y, z, w + index, nx, ny, nz, 1); }
+
+  // (i, j, k, l) accessor and mutator
+  Scalar operator()(uint i, uint j, uint k, uint l) const { return array->get(x + i, y + j, z + k, w + l); }
+  reference operator()(uint i, uint j, uint k, uint l) { return reference(array, x + i, y + j, z + k, w + l); }
+};
+
+typedef nested_view4 nested_view;
+
+// thread-safe read-only view of 4D (sub)array with private cache
+class private_const_view : public preview {
+protected:
+  using preview::array;
+  using preview::x;
+  using preview::y;
+  using preview::z;
+  using preview::w;
+  using preview::nx;
+  using preview::ny;
+  using preview::nz;
+  using preview::nw;
+public:
+  // construction--perform shallow copy of (sub)array
+  private_const_view(array4* array) :
+    preview(array),
+    cache(array->cache.size())
+  {
+    init();
+  }
+  private_const_view(array4* array, uint x, uint y, uint z, uint w, uint nx, uint ny, uint nz, uint nw) :
+    preview(array, x, y, z, w, nx, ny, nz, nw),
+    cache(array->cache.size())
+  {
+    init();
+  }
+
+  // destructor
+  ~private_const_view()
+  {
+    stream_close(zfp->stream);
+    zfp_stream_close(zfp);
+  }
+
+  // dimensions of (sub)array
+  uint size_x() const { return nx; }
+  uint size_y() const { return ny; }
+  uint size_z() const { return nz; }
+  uint size_w() const { return nw; }
+
+  // cache size in number of bytes
+  size_t cache_size() const { return cache.size() * sizeof(CacheLine); }
+
+  // set minimum cache size in bytes (array dimensions must be known)
+  void set_cache_size(size_t csize)
+  {
+    cache.resize(array->lines(csize, nx, ny, nz, nw));
+  }
+
+  // empty cache without compressing modified cached blocks
+  void clear_cache() const { cache.clear(); }
+
+  // (i, j, k, l) accessor
+  Scalar operator()(uint i, uint j, uint k, uint l) const { return get(x + i, y + j, z + k, w + l); }
+
+protected:
+  // cache line representing one block of decompressed values
+  class CacheLine {
+  public:
+    const Scalar& operator()(uint i, uint j, uint k, uint l) const { return a[index(i, j, k, l)]; }
+    Scalar& operator()(uint i, uint j, uint k, uint l) { return a[index(i, j, k, l)]; }
+    const Scalar* data() const { return a; }
+    Scalar* data() { return a; }
+  protected:
+    static uint index(uint i, uint j, uint k, uint l) { return (i & 3u) + 4 * ((j & 3u) + 4 * ((k & 3u) + 4 * (l & 3u))); }
+    Scalar a[256];
+  };
+
+  // copy private data
+  void init()
+  {
+    // copy compressed stream
+    zfp = zfp_stream_open(0);
+    *zfp = *array->zfp;
+    // copy bit stream
+    zfp->stream = stream_clone(array->zfp->stream);
+  }
+
+  // inspector
+  const Scalar& get(uint i, uint j, uint k, uint l) const
+  {
+    const CacheLine* p = line(i, j, k, l);
+    return (*p)(i, j, k, l);
+  }
+
+  // return cache line for (i, j, k, l); may require write-back and fetch
+  CacheLine* line(uint i, uint j, uint k, uint l) const
+  {
+    CacheLine* p = 0;
+    uint b = array->block(i, j, k, l);
+    typename Cache<CacheLine, Policy>::Tag t = cache.access(p, b + 1, false);
+    uint c = t.index() - 1;
+    // fetch cache line; no writeback possible since view is read-only
+    if (c != b)
+      decode(b, p->data());
+    return p;
+  }
+
+  // decode block with given index; variable-size blocks, which views may
+  // relocate when writing back, are accessed by one view at a time
+  void decode(uint index, Scalar* block) const
+  {
+    if (array->variable_rate()) {
+#ifdef _OPENMP
+      #pragma omp critical(zfp_variable_rate)
+#endif
+      {
+        rebind();
+        decode_block(index, block);
+      }
+    }
+    else
+      decode_block(index, block);
+  }
+
+  // decode block with given index from private stream
+  void decode_block(uint index, Scalar* block) const
+  {
+    stream_rseek(zfp->stream, array->block_offset(index));
+    Codec::decode_block_4(zfp, block, array->shape ? array->shape[index] : 0);
+  }
+
+  // rebind private stream to array storage reallocated by compaction
+  void rebind() const
+  {
+    if (stream_data(zfp->stream) != stream_data(array->zfp->stream) ||
+        stream_capacity(zfp->stream) != stream_capacity(array->zfp->stream)) {
+      stream_close(zfp->stream);
+      zfp->stream = stream_clone(array->zfp->stream);
+    }
+  }
+
+  zfp_stream* zfp;                // stream of compressed blocks
+  mutable Cache<CacheLine, Policy> cache; // cache of decompressed blocks
+};
+
+// thread-safe read-write view of private 4D (sub)array
+class private_view : public private_const_view {
+protected:
+  using preview::array;
+  using preview::x;
+  using preview::y;
+  using preview::z;
+  using preview::w;
+  using preview::nx;
+  using preview::ny;
+  using preview::nz;
+  using preview::nw;
+  using private_const_view::zfp;
+  using private_const_view::cache;
+  using private_const_view::init;
+  using private_const_view::decode;
+  class view_reference;
+  typedef typename private_const_view::CacheLine CacheLine;
+public:
+  // construction--perform shallow copy of (sub)array
+  private_view(array4* array) : private_const_view(array) {}
+  private_view(array4* array, uint x, uint y, uint z, uint w, uint nx, uint ny, uint nz, uint nw) : private_const_view(array, x, y, z, w, nx, ny, nz, nw) {}
+
+  // partition view into count block-aligned pieces, with 0 <= index < count
+  void partition(uint index, uint count)
+  {
+    if (nx > std::max(ny, std::max(nz, nw)))
+      partition(x, nx, index, count);
+    else if (ny > std::max(nx, std::max(nz, nw)))
+      partition(y, ny, index, count);
+    else if (nz > std::max(nx, std::max(ny, nw)))
+      partition(z, nz, index, count);
+    else
+      partition(w, nw, index, count);
+  }
+
+  // flush cache by compressing all modified cached blocks
+  void flush_cache() const
+  {
+    for (typename Cache<CacheLine, Policy>::const_iterator p = cache.first(); p; p++) {
+      if (p->tag.dirty()) {
+        uint b = p->tag.index() - 1;
+        encode(b, p->line->data());
+      }
+      cache.flush(p->line);
+    }
+  }
+
+  // (i, j, k, l) accessor from base class
+  using private_const_view::operator();
+
+  // (i, j, k, l) mutator
+  view_reference operator()(uint i, uint j, uint k, uint l) { return view_reference(this, x + i, y + j, z + k, w + l); }
+
+protected:
+  class view_reference {
+  public:
+    operator Scalar() const { return view->get(i, j, k, l); }
+    view_reference operator=(const view_reference& r) { view->set(i, j, k, l, r.operator Scalar()); return *this; }
+    view_reference operator=(Scalar val) { view->set(i, j, k, l, val); return *this; }
+    view_reference operator+=(Scalar val) { view->add(i, j, k, l, val); return *this; }
+    view_reference operator-=(Scalar val) { view->sub(i, j, k, l, val); return *this; }
+    view_reference operator*=(Scalar val) { view->mul(i, j, k, l, val); return *this; }
+    view_reference operator/=(Scalar val) { view->div(i, j, k, l, val); return *this; }
+    // swap two array elements via proxy references
+    friend void swap(view_reference a, view_reference b)
+    {
+      Scalar x = a.operator Scalar();
+      Scalar y = b.operator Scalar();
+      b.operator=(x);
+      a.operator=(y);
+    }
+
+  protected:
+    friend class private_view;
+    explicit view_reference(private_view* view, uint i, uint j, uint k, uint l) : view(view), i(i), j(j), k(k), l(l) {}
+    private_view* view;
+    uint i, j, k, l;
+  };
+
+  // block-aligned partition of [offset, offset + size): index out of count
+  static void partition(uint& offset, uint& size, uint index, uint count)
+  {
+    uint bmin = offset / 4;
+    uint bmax = (offset + size + 3) / 4;
+    uint xmin = std::max(offset +    0, 4 * (bmin + (bmax - bmin) * (index + 0) / count));
+    uint xmax = std::min(offset + size, 4 * (bmin + (bmax - bmin) * (index + 1) / count));
+    offset = xmin;
+    size = xmax - xmin;
+  }
+
+  // mutator
+  void set(uint i, uint j, uint k, uint l, Scalar val)
+  {
+    CacheLine* p = line(i, j, k, l, true);
+    (*p)(i, j, k, l) = val;
+  }
+
+  // in-place updates
+  void add(uint i, uint j, uint k, uint l, Scalar val) { (*line(i, j, k, l, true))(i, j, k, l) += val; }
+  void sub(uint i, uint j, uint k, uint l, Scalar val) { (*line(i, j, k, l, true))(i, j, k, l) -= val; }
+  void mul(uint i, uint j, uint k, uint l, Scalar val) { (*line(i, j, k, l, true))(i, j, k, l) *= val; }
+  void div(uint i, uint j, uint k, uint l, Scalar val) { (*line(i, j, k, l, true))(i, j, k, l) /= val; }
+
+  // return cache line for (i, j, k, l); may require write-back and fetch
+  CacheLine* line(uint i, uint j, uint k, uint l, bool write) const
+  {
+    CacheLine* p = 0;
+    uint b = array->block(i, j, k, l);
+    typename Cache<CacheLine, Policy>::Tag t = cache.access(p, b + 1, write);
+    uint c = t.index() - 1;
+    if (c != b) {
+      // write back occupied cache line if it is dirty
+      if (t.dirty())
+        encode(c, p->data());
+      decode(b, p->data());
+    }
+    return p;
+  }
+
+  // encode block with given index
+  void encode(uint index, const Scalar* block) const
+  {
+    // variable-size blocks are stored via the array one view at a time
+    if (array->variable_rate()) {
+#ifdef _OPENMP
+      #pragma omp critical(zfp_variable_rate)
+#endif
+      array->encode(index, block);
+      return;
+    }
+    stream_wseek(zfp->stream, index * array->blkbits);
+    Codec::encode_block_4(zfp, block, array->shape ? array->shape[index] : 0);
+    stream_flush(zfp->stream);
+  }
+};
@@ -5,6 +5,10 @@
 #include <climits>
 #include "zfp.h"
 #include "zfp/memory.h"
+#include "zfp/mapping.h"
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
 
 namespace zfp {
 
@@ -14,30 +18,39 @@ protected:
   // default constructor
   array() :
     dims(0), type(zfp_type_none),
-    nx(0), ny(0), nz(0),
-    bx(0), by(0), bz(0),
+    nx(0), ny(0), nz(0), nw(0),
+    bx(0), by(0), bz(0), bw(0),
     blocks(0), blkbits(0),
     bytes(0), data(0),
     zfp(0),
-    shape(0)
+    shape(0),
+    offset(0), capacity(0), used(0),
+    scratch(0),
+    fd(-1), read_only(false)
   {}
 
   // generic array with 'dims' dimensions and scalar type 'type'
   array(uint dims, zfp_type type) :
     dims(dims), type(type),
-    nx(0), ny(0), nz(0),
-    bx(0), by(0), bz(0),
+    nx(0), ny(0), nz(0), nw(0),
+    bx(0), by(0), bz(0), bw(0),
     blocks(0), blkbits(0),
     bytes(0), data(0),
     zfp(zfp_stream_open(0)),
-    shape(0)
+    shape(0),
+    offset(0), capacity(0), used(0),
+    scratch(0),
+    fd(-1), read_only(false)
   {}
 
   // copy constructor--performs a deep copy
   array(const array& a) :
     data(0),
     zfp(0),
-    shape(0)
+    shape(0),
+    offset(0), capacity(0),
+    scratch(0),
+    fd(-1), read_only(false)
   {
     deep_copy(a);
   }
@@ -46,6 +59,7 @@ protected:
   ~array()
   {
     free();
+    close_scratch();
     zfp_stream_close(zfp);
   }
 
@@ -57,26 +71,131 @@ protected:
   }
  
 public:
-  // rate in bits per value
-  double rate() const { return double(blkbits) / block_size(); }
+  // rate in bits per value (average rate of storage in use if variable rate)
+  double rate() const
+  {
+    if (variable_rate())
+      return blocks ? double(used) / (size_t(blocks) * block_size()) : 0.0;
+    return double(blkbits) / block_size();
+  }
 
   // set compression rate in bits per value
   double set_rate(double rate)
   {
     rate = zfp_stream_set_rate(zfp, rate, type, dims, 1);
     blkbits = zfp->maxbits;
+    close_scratch();
     alloc();
     return rate;
   }
 
+  // set fixed-accuracy mode with given absolute error tolerance; blocks are
+  // stored at variable rate, which disables concurrent reads (all previously
+  // stored data will be lost)
+  double set_accuracy(double tolerance)
+  {
+    disable_concurrency();
+    tolerance = zfp_stream_set_accuracy(zfp, tolerance);
+    open_scratch();
+    alloc();
+    return tolerance;
+  }
+
+  // set fixed-precision mode with given number of uncompressed bits per
+  // value; blocks are stored at variable rate, which disables concurrent
+  // reads (previous data will be lost)
+  uint set_precision(uint precision)
+  {
+    disable_concurrency();
+    precision = zfp_stream_set_precision(zfp, precision);
+    open_scratch();
+    alloc();
+    return precision;
+  }
+
+  // are blocks stored at variable rate?
+  bool variable_rate() const { return scratch != 0; }
+
+  // set execution policy of whole-array get(), set(), and flush_cache() and
+  // number of threads (zero for default); zfp_exec_omp requires OpenMP and
+  // applies to fixed-rate arrays only.  Returns true upon success.
+  bool set_execution(zfp_exec_policy policy, uint threads = 0)
+  {
+    switch (policy) {
+      case zfp_exec_serial:
+        return zfp_stream_set_execution(zfp, policy) != 0;
+#ifdef _OPENMP
+      case zfp_exec_omp:
+        return zfp_stream_set_omp_threads(zfp, threads) != 0;
+#endif
+      default:
+        static_cast<void>(threads);
+        return false;
+    }
+  }
+
+  // execution policy of whole-array get(), set(), and flush_cache()
+  zfp_exec_policy execution() const { return zfp_stream_execution(zfp); }
+
+  // attach encoder statistics gathered when compressing blocks (see
+  // zfp_stream_set_stats); returns true upon success
+  bool set_stats(zfp_stats* stats) { return zfp_stream_set_stats(zfp, stats) != 0; }
+
+  // map compressed data to file holding fixed-rate blocks in array order;
+  // the file is extended with zero (empty) blocks if too short unless
+  // opened read-only, in which case modified blocks remain in memory.  The
+  // array takes on the contents of the file; its in-memory compressed data
+  // and modified cached blocks are discarded rather than written to the
+  // file.  Returns true upon success; fails on platforms without POSIX mmap.
+  bool map(const char* path, bool read_only = false)
+  {
+    if (variable_rate())
+      return false;
+    int fd = open_mapped_file(path, read_only);
+    if (fd < 0)
+      return false;
+    uchar* buffer;
+    if (!map_file(fd, bytes, read_only, buffer)) {
+      close_mapped_file(fd);
+      return false;
+    }
+    clear_cache();
+    free_data();
+    close_file();
+    data = buffer;
+    this->fd = fd;
+    this->read_only = read_only;
+    stream_close(zfp->stream);
+    zfp_stream_set_bit_stream(zfp, stream_open(data, bytes));
+    return true;
+  }
+
+  // copy mapped compressed data to memory and close file
+  void unmap()
+  {
+    if (mapped()) {
+      flush_cache();
+      uchar* buffer = static_cast<uchar*>(allocate(bytes, 0x100u));
+      std::copy(data, data + bytes, buffer);
+      free_data();
+      close_file();
+      data = buffer;
+      stream_close(zfp->stream);
+      zfp_stream_set_bit_stream(zfp, stream_open(data, bytes));
+    }
+  }
+
+  // is compressed data mapped to a file?
+  bool mapped() const { return fd >= 0; }
+
   // empty cache without compressing modified cached blocks
   virtual void clear_cache() const = 0;
 
   // flush cache by compressing all modified cached blocks
   virtual void flush_cache() const = 0;
 
-  // number of bytes of compressed data
-  size_t compressed_size() const { return bytes; }
+  // number of bytes of compressed data (in use if variable rate)
+  size_t compressed_size() const { return variable_rate() ? (used + CHAR_BIT - 1) / CHAR_BIT : bytes; }
 
   // pointer to compressed data for read or write access
   uchar* compressed_data() const
@@ -90,29 +209,225 @@ protected:
   // number of values per block
   uint block_size() const { return 1u << (2 * dims); }
 
-  // allocate memory for compressed data
+  // disable concurrent reads, which require fixed-rate storage
+  virtual void disable_concurrency() {}
+
+  // allocate memory for compressed data (or resize mapped fixed-rate file)
   void alloc(bool clear = true)
   {
+    free_data();
     bytes = blocks * blkbits / CHAR_BIT;
-    reallocate(data, bytes, 0x100u);
-    if (clear)
+    if (mapped() && (variable_rate() || !map_file(fd, bytes, read_only, data))) {
+      close_file();
+      clear = true;
+    }
+    if (!mapped())
+      data = static_cast<uchar*>(allocate(bytes, 0x100u));
+    if (clear || variable_rate())
       std::fill(data, data + bytes, 0);
     stream_close(zfp->stream);
     zfp_stream_set_bit_stream(zfp, stream_open(data, bytes));
+    // initially store each variable-rate block as a single zero-bit
+    deallocate(offset);
+    deallocate(capacity);
+    offset = 0;
+    capacity = 0;
+    used = 0;
+    if (variable_rate() && blocks) {
+      offset = static_cast<size_t*>(allocate(blocks * sizeof(size_t)));
+      capacity = static_cast<uint*>(allocate(blocks * sizeof(uint)));
+      for (uint b = 0; b < blocks; b++) {
+        offset[b] = b;
+        capacity[b] = 1;
+      }
+      used = blocks;
+    }
     clear_cache();
   }
 
+  // open stream for encoding one variable-size block
+  void open_scratch()
+  {
+    if (!scratch) {
+      size_t size = ZFP_MAX_BITS / CHAR_BIT + 2 * sizeof(uint64);
+      scratch = zfp_stream_open(stream_open(allocate(size, 0x100u), size));
+    }
+    // allocate storage for at least one bit per block, in whole words
+    blkbits = stream_word_bits;
+  }
+
+  // close stream for encoding variable-size blocks
+  void close_scratch()
+  {
+    if (scratch) {
+      uchar* buffer = static_cast<uchar*>(stream_data(scratch->stream));
+      stream_close(scratch->stream);
+      deallocate(buffer);
+      zfp_stream_close(scratch);
+      scratch = 0;
+    }
+  }
+
+#ifdef _OPENMP
+  // number of threads for whole-array operations (zero if serial)
+  int omp_threads() const
+  {
+    if (zfp_stream_execution(zfp) != zfp_exec_omp || variable_rate())
+      return 0;
+    uint threads = zfp_stream_omp_threads(zfp);
+    return threads ? int(threads) : omp_get_max_threads();
+  }
+#endif
+
+  // open private stream for accessing fixed-rate blocks from one thread;
+  // encoder statistics, if attached, are gathered privately
+  zfp_stream* open_cursor() const
+  {
+    zfp_stream* z = zfp_stream_open(0);
+    *z = *zfp;
+    z->stream = stream_open(data, bytes);
+    if (zfp->stats)
+      z->stats = new zfp_stats();
+    return z;
+  }
+
+  // close stream opened by open_cursor() and merge its statistics
+  void close_cursor(zfp_stream* z) const
+  {
+    if (z->stats) {
+#ifdef _OPENMP
+      #pragma omp critical(zfp_profile)
+#endif
+      add_stats(zfp->stats, z->stats);
+      delete z->stats;
+    }
+    stream_close(z->stream);
+    zfp_stream_close(z);
+  }
+
+  // add encoder statistics src to dst
+  static void add_stats(zfp_stats* dst, const zfp_stats* src)
+  {
+    for (uint i = 0; i < ZFP_STATS_STAGES; i++)
+      dst->cycles[i] += src->cycles[i];
+    dst->blocks += src->blocks;
+    dst->zero_blocks += src->zero_blocks;
+    dst->planes += src->planes;
+    for (uint i = 0; i < ZFP_STATS_BINS; i++)
+      dst->histogram[i] += src->histogram[i];
+  }
+
+  // bit offset of block with given index
+  size_t block_offset(uint index) const { return offset ? offset[index] : index * blkbits; }
+
+  // position stream for encoding block with given index and return it
+  zfp_stream* begin_encode(uint index) const
+  {
+    if (!variable_rate()) {
+      stream_wseek(zfp->stream, index * blkbits);
+      return zfp;
+    }
+    // encode variable-size block into scratch stream using current parameters
+    bitstream* stream = scratch->stream;
+    *scratch = *zfp;
+    scratch->stream = stream;
+    stream_rewind(stream);
+    return scratch;
+  }
+
+  // complete encoding of block with given index
+  void end_encode(uint index) const
+  {
+    if (!variable_rate()) {
+      stream_flush(zfp->stream);
+      return;
+    }
+    size_t bits = stream_wtell(scratch->stream);
+    stream_flush(scratch->stream);
+    // relocate block if it no longer fits in its slot
+    if (bits > capacity[index]) {
+      // leave room for regrowth unless block is stored for the first time
+      size_t size = capacity[index] ? bits + bits / 4 : bits;
+      capacity[index] = 0;
+      offset[index] = allocate_slot(size);
+      capacity[index] = uint(size);
+    }
+    // save bits that follow the block within its last word
+    size_t end = offset[index] + bits;
+    uint tail = uint(-end % stream_word_bits);
+    stream_rseek(zfp->stream, end);
+    uint64 next = stream_read_bits(zfp->stream, tail);
+    // copy block to its slot and restore subsequent bits
+    stream_wseek(zfp->stream, offset[index]);
+    stream_rewind(scratch->stream);
+    stream_copy(zfp->stream, scratch->stream, bits);
+    stream_write_bits(zfp->stream, next, tail);
+    stream_flush(zfp->stream);
+  }
+
+  // release storage of all variable-size blocks before encoding all of them
+  void discard_blocks() const
+  {
+    if (variable_rate()) {
+      std::fill(capacity, capacity + blocks, 0u);
+      used = 0;
+    }
+  }
+
+  // allocate slot of given size, compacting and growing storage when full
+  size_t allocate_slot(size_t size) const
+  {
+    if (used + size > bytes * CHAR_BIT)
+      compact(size);
+    size_t slot = used;
+    used += size;
+    return slot;
+  }
+
+  // move blocks without gaps into new buffer with room for 'size' more bits
+  void compact(size_t size) const
+  {
+    size_t live = 0;
+    for (uint b = 0; b < blocks; b++)
+      live += capacity[b];
+    // double storage in whole stream words
+    size_t n = 2 * (live + size);
+    n = (n + stream_word_bits - 1) / stream_word_bits * stream_word_bits / CHAR_BIT;
+    uchar* buffer = static_cast<uchar*>(allocate(n, 0x100u));
+    bitstream* stream = stream_open(buffer, n);
+    size_t o = 0;
+    for (uint b = 0; b < blocks; b++) {
+      stream_rseek(zfp->stream, offset[b]);
+      stream_copy(stream, zfp->stream, capacity[b]);
+      offset[b] = o;
+      o += capacity[b];
+    }
+    stream_flush(stream);
+    std::fill(buffer + stream_size(stream), buffer + n, 0);
+    stream_close(zfp->stream);
+    deallocate(data);
+    data = buffer;
+    bytes = n;
+    used = o;
+    zfp_stream_set_bit_stream(zfp, stream);
+  }
+
   // free memory associated with compressed data
   void free()
   {
-    nx = ny = nz = 0;
-    bx = by = bz = 0;
+    nx = ny = nz = nw = 0;
+    bx = by = bz = bw = 0;
     blocks = 0;
+    deallocate(offset);
+    deallocate(capacity);
+    offset = 0;
+    capacity = 0;
+    used = 0;
     stream_close(zfp->stream);
     zfp_stream_set_bit_stream(zfp, 0);
+    free_data();
+    close_file();
     bytes = 0;
-    deallocate(data);
-    data = 0;
     deallocate(shape);
     shape = 0;
   }
@@ -126,14 +441,18 @@ protected:
     nx = a.nx;
     ny = a.ny;
     nz = a.nz;
+    nw = a.nw;
     bx = a.bx;
     by = a.by;
     bz = a.bz;
+    bw = a.bw;
     blocks = a.blocks;
     blkbits = a.blkbits;
-    bytes = a.bytes;
 
-    // copy dynamically allocated data
+    // copy dynamically allocated data (to memory if mapped)
+    free_data();
+    close_file();
+    bytes = a.bytes;
     clone(data, a.data, bytes, 0x100u);
     if (zfp) {
       if (zfp->stream)
@@ -144,18 +463,59 @@ protected:
     *zfp = *a.zfp;
     zfp_stream_set_bit_stream(zfp, stream_open(data, bytes));
     clone(shape, a.shape, blocks);
+
+    // copy variable-rate block table
+    if (a.variable_rate()) {
+      open_scratch();
+      clone(offset, a.offset, blocks);
+      clone(capacity, a.capacity, blocks);
+    }
+    else {
+      close_scratch();
+      deallocate(offset);
+      deallocate(capacity);
+      offset = 0;
+      capacity = 0;
+    }
+    used = a.used;
+  }
+
+  // release memory or file mapping of compressed data
+  void free_data() const
+  {
+    if (mapped()) {
+      unmap_file(data, bytes);
+      data = 0;
+      return;
+    }
+    deallocate(data);
+    data = 0;
+  }
+
+  // close file mapped to compressed data
+  void close_file()
+  {
+    if (mapped())
+      close_mapped_file(fd);
+    fd = -1;
   }
 
-  uint dims;           // array dimensionality (1, 2, or 3)
-  zfp_type type;       // scalar type
-  uint nx, ny, nz;     // array dimensions
-  uint bx, by, bz;     // array dimensions in number of blocks
-  uint blocks;         // number of blocks
-  size_t blkbits;      // number of bits per compressed block
-  size_t bytes;        // total bytes of compressed data
-  mutable uchar* data; // pointer to compressed data
-  zfp_stream* zfp;     // compressed stream of blocks
-  uchar* shape;        // precomputed block dimensions (or null if uniform)
+  uint dims;            // array dimensionality (1, 2, 3, or 4)
+  zfp_type type;        // scalar type
+  uint nx, ny, nz, nw;  // array dimensions
+  uint bx, by, bz, bw;  // array dimensions in number of blocks
+  uint blocks;          // number of blocks
+  size_t blkbits;       // number of bits per compressed block (or word size)
+  mutable size_t bytes; // total bytes of compressed data
+  mutable uchar* data;  // pointer to compressed data
+  zfp_stream* zfp;      // compressed stream of blocks
+  uchar* shape;         // precomputed block dimensions (or null if uniform)
+  size_t* offset;       // bit offset of each variable-size block
+  uint* capacity;       // bits reserved for each variable-size block
+  mutable size_t used;  // bits of variable-rate storage in use
+  zfp_stream* scratch;  // stream for encoding variable-size blocks (or null)
+  int fd;               // descriptor of file mapped to compressed data (or -1)
+  bool read_only;       // is mapped file opened read-only?
 };
 
 }
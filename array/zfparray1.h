@@ -10,7 +10,7 @@
 namespace zfp {
 
 // compressed 1D array of scalars
-template < typename Scalar, class Codec = zfp::codec<Scalar> >
+template < typename Scalar, class Codec = zfp::codec<Scalar>, class Policy = CacheDefaultPolicy >
 class array1 : public array {
 public:
   // forward declarations
@@ -38,6 +38,17 @@ public:
       set(p);
   }
 
+  // constructor of n-sample array using rate bits per value and at least
+  // csize bytes of cache, whose compressed data is mapped to the file at
+  // path (see map(); the array is held in memory if mapping fails)
+  array1(const char* path, uint n, double rate, bool read_only = false, size_t csize = 0) :
+    array(1, Codec::type),
+    cache(lines(csize, n))
+  {
+    set_rate(rate);
+    resize(n, !map(path, read_only));
+  }
+
   // copy constructor--performs a deep copy
   array1(const array1& a)
   {
@@ -58,7 +69,12 @@ public:
   }
 
   // virtual destructor
-  virtual ~array1() {}
+  virtual ~array1()
+  {
+    // write modified blocks back to mapped file
+    if (mapped())
+      flush_cache();
+  }
 
   // assignment operator--performs a deep copy
   array1& operator=(const array1& a)
@@ -114,7 +130,13 @@ public:
   // flush cache by compressing all modified cached blocks
   void flush_cache() const
   {
-    for (typename Cache<CacheLine>::const_iterator p = cache.first(); p; p++) {
+#ifdef _OPENMP
+    if (omp_threads()) {
+      flush_parallel();
+      return;
+    }
+#endif
+    for (typename Cache<CacheLine, Policy>::const_iterator p = cache.first(); p; p++) {
       if (p->tag.dirty()) {
         uint b = p->tag.index() - 1;
         encode(b, p->line->data());
@@ -126,6 +148,12 @@ public:
   // decompress array and store at p
   void get(Scalar* p) const
   {
+#ifdef _OPENMP
+    if (omp_threads()) {
+      get_parallel(p);
+      return;
+    }
+#endif
     uint b = 0;
     for (uint i = 0; i < bx; i++, p += 4, b++) {
       const CacheLine* line = cache.lookup(b + 1);
@@ -139,12 +167,65 @@ public:
   // initialize array by copying and compressing data stored at p
   void set(const Scalar* p)
   {
+#ifdef _OPENMP
+    if (omp_threads()) {
+      set_parallel(p);
+      return;
+    }
+#endif
     uint b = 0;
+    discard_blocks();
     for (uint i = 0; i < bx; i++, b++, p += 4)
       encode(b, p, 1);
     cache.clear();
   }
 
+  // decompress subarray [x0, x0 + nx) and store it at p using stride sx;
+  // cached blocks are copied and all others are decoded directly without
+  // being cached
+  void get(uint x0, uint nx, Scalar* p, int sx) const
+  {
+    uint x1 = x0 + nx;
+    for (uint i = x0; i < x1; i = (i & ~3u) + 4) {
+      // intersection of block and subarray
+      uint mx = std::min(x1, (i & ~3u) + 4) - i;
+      uint b = block(i);
+      Scalar* q = p + (ptrdiff_t)(i - x0) * sx;
+      const CacheLine* line = cache.lookup(b + 1);
+      if (line)
+        line->get(q, sx, i, mx);
+      else if (covered(i, mx))
+        decode(b, q, sx);
+      else {
+        CacheLine tmp;
+        decode(b, tmp.data());
+        tmp.get(q, sx, i, mx);
+      }
+    }
+  }
+
+  // compress subarray [x0, x0 + nx) stored at p using stride sx; fully
+  // covered blocks are encoded directly and dropped from the cache, while
+  // the rest are updated in cache
+  void set(uint x0, uint nx, const Scalar* p, int sx)
+  {
+    uint x1 = x0 + nx;
+    for (uint i = x0; i < x1; i = (i & ~3u) + 4) {
+      // intersection of block and subarray
+      uint mx = std::min(x1, (i & ~3u) + 4) - i;
+      uint b = block(i);
+      const Scalar* q = p + (ptrdiff_t)(i - x0) * sx;
+      if (covered(i, mx)) {
+        const CacheLine* cached = cache.lookup(b + 1);
+        if (cached)
+          cache.flush(cached);
+        encode(b, q, sx);
+      }
+      else
+        line(i, true)->set(q, sx, i, mx);
+    }
+  }
+
   // (i) accessors
   Scalar operator()(uint i) const { return get(i); }
   reference operator()(uint i) { return reference(this, i); }
@@ -153,6 +234,26 @@ public:
   Scalar operator[](uint index) const { return get(index); }
   reference operator[](uint index) { return reference(this, index); }
 
+  // apply f(i, block) to each block in array order, where i indexes the
+  // block's first value and block points to its four decoded values.  The
+  // pointer is valid only during the call, which must not access the array.
+  // Values that fall outside the array in a partial block are undefined.
+  template <class Function>
+  void for_each_block(Function f) const
+  {
+    for (uint i = 0; i < nx; i += 4)
+      f(i, static_cast<const Scalar*>(line(i, false)->data()));
+  }
+
+  // as above, but blocks may be modified and are compressed upon eviction
+  // or when the cache is flushed; apply to a const array to only read
+  template <class Function>
+  void for_each_block(Function f)
+  {
+    for (uint i = 0; i < nx; i += 4)
+      f(i, line(i, true)->data());
+  }
+
   // random access iterators
   iterator begin() { return iterator(this, 0); }
   iterator end() { return iterator(this, nx); }
@@ -184,6 +285,18 @@ protected:
           *p = *q;
       }
     }
+    // copy subblock [i, i + nx) to p
+    void get(Scalar* p, int sx, uint i, uint nx) const
+    {
+      for (uint x = 0; x < nx; x++)
+        p[(ptrdiff_t)x * sx] = a[index(i + x)];
+    }
+    // copy p to subblock [i, i + nx)
+    void set(const Scalar* p, int sx, uint i, uint nx)
+    {
+      for (uint x = 0; x < nx; x++)
+        a[index(i + x)] = p[(ptrdiff_t)x * sx];
+    }
   protected:
     static uint index(uint i) { return i & 3u; }
     Scalar a[4];
@@ -223,7 +336,7 @@ protected:
   {
     CacheLine* p = 0;
     uint b = block(i);
-    typename Cache<CacheLine>::Tag t = cache.access(p, b + 1, write);
+    typename Cache<CacheLine, Policy>::Tag t = cache.access(p, b + 1, write);
     uint c = t.index() - 1;
     if (c != b) {
       // write back occupied cache line if it is dirty
@@ -238,33 +351,106 @@ protected:
   // encode block with given index
   void encode(uint index, const Scalar* block) const
   {
-    stream_wseek(zfp->stream, index * blkbits);
-    Codec::encode_block_1(zfp, block, shape ? shape[index] : 0);
-    stream_flush(zfp->stream);
+    zfp_stream* s = begin_encode(index);
+    Codec::encode_block_1(s, block, shape ? shape[index] : 0);
+    end_encode(index);
   }
 
   // encode block with given index from strided array
   void encode(uint index, const Scalar* p, int sx) const
   {
-    stream_wseek(zfp->stream, index * blkbits);
-    Codec::encode_block_strided_1(zfp, p, shape ? shape[index] : 0, sx);
-    stream_flush(zfp->stream);
+    zfp_stream* s = begin_encode(index);
+    Codec::encode_block_strided_1(s, p, shape ? shape[index] : 0, sx);
+    end_encode(index);
   }
 
   // decode block with given index
   void decode(uint index, Scalar* block) const
   {
-    stream_rseek(zfp->stream, index * blkbits);
+    stream_rseek(zfp->stream, block_offset(index));
     Codec::decode_block_1(zfp, block, shape ? shape[index] : 0);
   }
 
   // decode block with given index to strided array
   void decode(uint index, Scalar* p, int sx) const
   {
-    stream_rseek(zfp->stream, index * blkbits);
+    stream_rseek(zfp->stream, block_offset(index));
     Codec::decode_block_strided_1(zfp, p, shape ? shape[index] : 0, sx);
   }
 
+#ifdef _OPENMP
+  // parallel flush_cache() for fixed-rate arrays
+  void flush_parallel() const
+  {
+    int n = int(cache.size());
+    #pragma omp parallel num_threads(omp_threads())
+    {
+      zfp_stream* s = open_cursor();
+      #pragma omp for
+      for (int i = 0; i < n; i++) {
+        typename Cache<CacheLine, Policy>::Tag t;
+        const CacheLine* line = cache.slot(uint(i), t);
+        if (t.dirty()) {
+          uint b = t.index() - 1;
+          stream_wseek(s->stream, b * blkbits);
+          Codec::encode_block_1(s, line->data(), shape ? shape[b] : 0);
+          stream_flush(s->stream);
+        }
+      }
+      close_cursor(s);
+    }
+    cache.clear();
+  }
+
+  // parallel get() for fixed-rate arrays
+  void get_parallel(Scalar* p) const
+  {
+    int n = int(blocks);
+    #pragma omp parallel num_threads(omp_threads())
+    {
+      zfp_stream* s = open_cursor();
+      #pragma omp for
+      for (int b = 0; b < n; b++) {
+        Scalar* q = p + 4 * size_t(b);
+        const CacheLine* line = cache.lookup(b + 1);
+        if (line)
+          line->get(q, 1, shape ? shape[b] : 0);
+        else {
+          stream_rseek(s->stream, b * blkbits);
+          Codec::decode_block_strided_1(s, q, shape ? shape[b] : 0, 1);
+        }
+      }
+      close_cursor(s);
+    }
+  }
+
+  // parallel set() for fixed-rate arrays
+  void set_parallel(const Scalar* p)
+  {
+    int n = int(blocks);
+    #pragma omp parallel num_threads(omp_threads())
+    {
+      zfp_stream* s = open_cursor();
+      #pragma omp for
+      for (int b = 0; b < n; b++) {
+        const Scalar* q = p + 4 * size_t(b);
+        stream_wseek(s->stream, b * blkbits);
+        Codec::encode_block_strided_1(s, q, shape ? shape[b] : 0, 1);
+        stream_flush(s->stream);
+      }
+      close_cursor(s);
+    }
+    cache.clear();
+  }
+#endif
+
+  // is the block whose intersection with a subarray starts at i and has
+  // length mx covered in full?
+  bool covered(uint i, uint mx) const
+  {
+    return !(i & 3u) && i + mx == std::min(i + 4, nx);
+  }
+
   // block index for i
   static uint block(uint i) { return i / 4; }
 
@@ -275,7 +461,7 @@ protected:
     return std::max(n, 1u);
   }
 
-  mutable Cache<CacheLine> cache; // cache of decompressed blocks
+  mutable Cache<CacheLine, Policy> cache; // cache of decompressed blocks
 };
 
 typedef array1<float> array1f;
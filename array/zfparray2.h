@@ -10,7 +10,7 @@
 namespace zfp {
 
 // compressed 2D array of scalars
-template < typename Scalar, class Codec = zfp::codec<Scalar> >
+template < typename Scalar, class Codec = zfp::codec<Scalar>, class Policy = CacheDefaultPolicy >
 class array2 : public array {
 public:
   // forward declarations
@@ -38,6 +38,17 @@ public:
       set(p);
   }
 
+  // constructor of nx * ny array using rate bits per value and at least
+  // csize bytes of cache, whose compressed data is mapped to the file at
+  // path (see map(); the array is held in memory if mapping fails)
+  array2(const char* path, uint nx, uint ny, double rate, bool read_only = false, size_t csize = 0) :
+    array(2, Codec::type),
+    cache(lines(csize, nx, ny))
+  {
+    set_rate(rate);
+    resize(nx, ny, !map(path, read_only));
+  }
+
   // copy constructor--performs a deep copy
   array2(const array2& a)
   {
@@ -58,7 +69,12 @@ public:
   }
 
   // virtual destructor
-  virtual ~array2() {}
+  virtual ~array2()
+  {
+    // write modified blocks back to mapped file
+    if (mapped())
+      flush_cache();
+  }
 
   // assignment operator--performs a deep copy
   array2& operator=(const array2& a)
@@ -118,7 +134,13 @@ public:
   // flush cache by compressing all modified cached blocks
   void flush_cache() const
   {
-    for (typename Cache<CacheLine>::const_iterator p = cache.first(); p; p++) {
+#ifdef _OPENMP
+    if (omp_threads()) {
+      flush_parallel();
+      return;
+    }
+#endif
+    for (typename Cache<CacheLine, Policy>::const_iterator p = cache.first(); p; p++) {
       if (p->tag.dirty()) {
         uint b = p->tag.index() - 1;
         encode(b, p->line->data());
@@ -130,6 +152,12 @@ public:
   // decompress array and store at p
   void get(Scalar* p) const
   {
+#ifdef _OPENMP
+    if (omp_threads()) {
+      get_parallel(p);
+      return;
+    }
+#endif
     uint b = 0;
     for (uint j = 0; j < by; j++, p += 4 * (nx - bx))
       for (uint i = 0; i < bx; i++, p += 4, b++) {
@@ -144,13 +172,72 @@ public:
   // initialize array by copying and compressing data stored at p
   void set(const Scalar* p)
   {
+#ifdef _OPENMP
+    if (omp_threads()) {
+      set_parallel(p);
+      return;
+    }
+#endif
     uint b = 0;
+    discard_blocks();
     for (uint j = 0; j < by; j++, p += 4 * (nx - bx))
       for (uint i = 0; i < bx; i++, p += 4, b++)
         encode(b, p, 1, nx);
     cache.clear();
   }
 
+  // decompress subarray [x0, x0 + nx) x [y0, y0 + ny) and store it at p
+  // using strides sx, sy; cached blocks are copied and all others are
+  // decoded directly without being cached
+  void get(uint x0, uint y0, uint nx, uint ny, Scalar* p, int sx, int sy) const
+  {
+    uint x1 = x0 + nx;
+    uint y1 = y0 + ny;
+    for (uint j = y0; j < y1; j = (j & ~3u) + 4)
+      for (uint i = x0; i < x1; i = (i & ~3u) + 4) {
+        // intersection of block and subarray
+        uint mx = std::min(x1, (i & ~3u) + 4) - i;
+        uint my = std::min(y1, (j & ~3u) + 4) - j;
+        uint b = block(i, j);
+        Scalar* q = p + (ptrdiff_t)(i - x0) * sx + (ptrdiff_t)(j - y0) * sy;
+        const CacheLine* line = cache.lookup(b + 1);
+        if (line)
+          line->get(q, sx, sy, i, j, mx, my);
+        else if (covered(i, j, mx, my))
+          decode(b, q, sx, sy);
+        else {
+          CacheLine tmp;
+          decode(b, tmp.data());
+          tmp.get(q, sx, sy, i, j, mx, my);
+        }
+      }
+  }
+
+  // compress subarray [x0, x0 + nx) x [y0, y0 + ny) stored at p using
+  // strides sx, sy; fully covered blocks are encoded directly and dropped
+  // from the cache, while the rest are updated in cache
+  void set(uint x0, uint y0, uint nx, uint ny, const Scalar* p, int sx, int sy)
+  {
+    uint x1 = x0 + nx;
+    uint y1 = y0 + ny;
+    for (uint j = y0; j < y1; j = (j & ~3u) + 4)
+      for (uint i = x0; i < x1; i = (i & ~3u) + 4) {
+        // intersection of block and subarray
+        uint mx = std::min(x1, (i & ~3u) + 4) - i;
+        uint my = std::min(y1, (j & ~3u) + 4) - j;
+        uint b = block(i, j);
+        const Scalar* q = p + (ptrdiff_t)(i - x0) * sx + (ptrdiff_t)(j - y0) * sy;
+        if (covered(i, j, mx, my)) {
+          const CacheLine* cached = cache.lookup(b + 1);
+          if (cached)
+            cache.flush(cached);
+          encode(b, q, sx, sy);
+        }
+        else
+          line(i, j, true)->set(q, sx, sy, i, j, mx, my);
+      }
+  }
+
   // (i, j) accessors
   Scalar operator()(uint i, uint j) const { return get(i, j); }
   reference operator()(uint i, uint j) { return reference(this, i, j); }
@@ -169,6 +256,29 @@ public:
     return reference(this, i, j);
   }
 
+  // apply f(i, j, block) to each block in array order, where (i, j) is the
+  // block's first value and block points to its decoded 4x4 values, stored
+  // with i varying fastest.  The pointer is valid only during the call, which
+  // must not access the array.  Values that fall outside the array in a
+  // partial block are undefined.
+  template <class Function>
+  void for_each_block(Function f) const
+  {
+    for (uint j = 0; j < ny; j += 4)
+      for (uint i = 0; i < nx; i += 4)
+        f(i, j, static_cast<const Scalar*>(line(i, j, false)->data()));
+  }
+
+  // as above, but blocks may be modified and are compressed upon eviction
+  // or when the cache is flushed; apply to a const array to only read
+  template <class Function>
+  void for_each_block(Function f)
+  {
+    for (uint j = 0; j < ny; j += 4)
+      for (uint i = 0; i < nx; i += 4)
+        f(i, j, line(i, j, true)->data());
+  }
+
   // sequential iterators
   iterator begin() { return iterator(this, 0, 0); }
   iterator end() { return iterator(this, 0, ny); }
@@ -203,6 +313,20 @@ protected:
             *p = *q;
       }
     }
+    // copy subblock [i, i + nx) x [j, j + ny) to p
+    void get(Scalar* p, int sx, int sy, uint i, uint j, uint nx, uint ny) const
+    {
+      for (uint y = 0; y < ny; y++)
+        for (uint x = 0; x < nx; x++)
+          p[(ptrdiff_t)x * sx + (ptrdiff_t)y * sy] = a[index(i + x, j + y)];
+    }
+    // copy p to subblock [i, i + nx) x [j, j + ny)
+    void set(const Scalar* p, int sx, int sy, uint i, uint j, uint nx, uint ny)
+    {
+      for (uint y = 0; y < ny; y++)
+        for (uint x = 0; x < nx; x++)
+          a[index(i + x, j + y)] = p[(ptrdiff_t)x * sx + (ptrdiff_t)y * sy];
+    }
   protected:
     static uint index(uint i, uint j) { return (i & 3u) + 4 * (j & 3u); }
     Scalar a[16];
@@ -242,7 +366,7 @@ protected:
   {
     CacheLine* p = 0;
     uint b = block(i, j);
-    typename Cache<CacheLine>::Tag t = cache.access(p, b + 1, write);
+    typename Cache<CacheLine, Policy>::Tag t = cache.access(p, b + 1, write);
     uint c = t.index() - 1;
     if (c != b) {
       // write back occupied cache line if it is dirty
@@ -257,33 +381,110 @@ protected:
   // encode block with given index
   void encode(uint index, const Scalar* block) const
   {
-    stream_wseek(zfp->stream, index * blkbits);
-    Codec::encode_block_2(zfp, block, shape ? shape[index] : 0);
-    stream_flush(zfp->stream);
+    zfp_stream* s = begin_encode(index);
+    Codec::encode_block_2(s, block, shape ? shape[index] : 0);
+    end_encode(index);
   }
 
   // encode block with given index from strided array
   void encode(uint index, const Scalar* p, int sx, int sy) const
   {
-    stream_wseek(zfp->stream, index * blkbits);
-    Codec::encode_block_strided_2(zfp, p, shape ? shape[index] : 0, sx, sy);
-    stream_flush(zfp->stream);
+    zfp_stream* s = begin_encode(index);
+    Codec::encode_block_strided_2(s, p, shape ? shape[index] : 0, sx, sy);
+    end_encode(index);
   }
 
   // decode block with given index
   void decode(uint index, Scalar* block) const
   {
-    stream_rseek(zfp->stream, index * blkbits);
+    stream_rseek(zfp->stream, block_offset(index));
     Codec::decode_block_2(zfp, block, shape ? shape[index] : 0);
   }
 
   // decode block with given index to strided array
   void decode(uint index, Scalar* p, int sx, int sy) const
   {
-    stream_rseek(zfp->stream, index * blkbits);
+    stream_rseek(zfp->stream, block_offset(index));
     Codec::decode_block_strided_2(zfp, p, shape ? shape[index] : 0, sx, sy);
   }
 
+#ifdef _OPENMP
+  // parallel flush_cache() for fixed-rate arrays
+  void flush_parallel() const
+  {
+    int n = int(cache.size());
+    #pragma omp parallel num_threads(omp_threads())
+    {
+      zfp_stream* s = open_cursor();
+      #pragma omp for
+      for (int i = 0; i < n; i++) {
+        typename Cache<CacheLine, Policy>::Tag t;
+        const CacheLine* line = cache.slot(uint(i), t);
+        if (t.dirty()) {
+          uint b = t.index() - 1;
+          stream_wseek(s->stream, b * blkbits);
+          Codec::encode_block_2(s, line->data(), shape ? shape[b] : 0);
+          stream_flush(s->stream);
+        }
+      }
+      close_cursor(s);
+    }
+    cache.clear();
+  }
+
+  // parallel get() for fixed-rate arrays
+  void get_parallel(Scalar* p) const
+  {
+    int n = int(blocks);
+    #pragma omp parallel num_threads(omp_threads())
+    {
+      zfp_stream* s = open_cursor();
+      #pragma omp for
+      for (int b = 0; b < n; b++) {
+        uint x = 4 * (uint(b) % bx);
+        uint y = 4 * (uint(b) / bx);
+        Scalar* q = p + x + size_t(nx) * y;
+        const CacheLine* line = cache.lookup(b + 1);
+        if (line)
+          line->get(q, 1, nx, shape ? shape[b] : 0);
+        else {
+          stream_rseek(s->stream, b * blkbits);
+          Codec::decode_block_strided_2(s, q, shape ? shape[b] : 0, 1, nx);
+        }
+      }
+      close_cursor(s);
+    }
+  }
+
+  // parallel set() for fixed-rate arrays
+  void set_parallel(const Scalar* p)
+  {
+    int n = int(blocks);
+    #pragma omp parallel num_threads(omp_threads())
+    {
+      zfp_stream* s = open_cursor();
+      #pragma omp for
+      for (int b = 0; b < n; b++) {
+        uint x = 4 * (uint(b) % bx);
+        uint y = 4 * (uint(b) / bx);
+        const Scalar* q = p + x + size_t(nx) * y;
+        stream_wseek(s->stream, b * blkbits);
+        Codec::encode_block_strided_2(s, q, shape ? shape[b] : 0, 1, nx);
+        stream_flush(s->stream);
+      }
+      close_cursor(s);
+    }
+    cache.clear();
+  }
+#endif
+
+  // is the block whose intersection with a subarray starts at (i, j) and has
+  // dimensions mx * my covered in full?
+  bool covered(uint i, uint j, uint mx, uint my) const
+  {
+    return !((i | j) & 3u) && i + mx == std::min(i + 4, nx) && j + my == std::min(j + 4, ny);
+  }
+
   // block index for (i, j)
   uint block(uint i, uint j) const { return (i / 4) + bx * (j / 4); }
 
@@ -302,7 +503,7 @@ protected:
     return std::max(n, 1u);
   }
 
-  mutable Cache<CacheLine> cache; // cache of decompressed blocks
+  mutable Cache<CacheLine, Policy> cache; // cache of decompressed blocks
 };
 
 typedef array2<float> array2f;
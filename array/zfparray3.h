@@ -10,7 +10,7 @@
 namespace zfp {
 
 // compressed 3D array of scalars
-template < typename Scalar, class Codec = zfp::codec<Scalar> >
+template < typename Scalar, class Codec = zfp::codec<Scalar>, class Policy = CacheDefaultPolicy >
 class array3 : public array {
 public:
   // forward declarations
@@ -24,13 +24,14 @@ public:
   #include "zfp/view3.h"
 
   // default constructor
-  array3() : array(3, Codec::type) {}
+  array3() : array(3, Codec::type), cursor(0) {}
 
   // constructor of nx * ny * nz array using rate bits per value, at least
   // csize bytes of cache, and optionally initialized from flat array p
   array3(uint nx, uint ny, uint nz, double rate, const Scalar* p = 0, size_t csize = 0) :
     array(3, Codec::type),
-    cache(lines(csize, nx, ny, nz))
+    cache(lines(csize, nx, ny, nz)),
+    cursor(0)
   {
     set_rate(rate);
     resize(nx, ny, nz, p == 0);
@@ -38,8 +39,21 @@ public:
       set(p);
   }
 
+  // constructor of nx * ny * nz array using rate bits per value and at least
+  // csize bytes of cache, whose compressed data is mapped to the file at
+  // path (see map(); the array is held in memory if mapping fails)
+  array3(const char* path, uint nx, uint ny, uint nz, double rate, bool read_only = false, size_t csize = 0) :
+    array(3, Codec::type),
+    cache(lines(csize, nx, ny, nz)),
+    cursor(0)
+  {
+    set_rate(rate);
+    resize(nx, ny, nz, !map(path, read_only));
+  }
+
   // copy constructor--performs a deep copy
-  array3(const array3& a)
+  array3(const array3& a) :
+    cursor(0)
   {
     deep_copy(a);
   }
@@ -48,7 +62,8 @@ public:
   template <class View>
   array3(const View& v) :
     array(3, Codec::type),
-    cache(lines(0, v.size_x(), v.size_y(), v.size_z()))
+    cache(lines(0, v.size_x(), v.size_y(), v.size_z())),
+    cursor(0)
   {
     set_rate(v.rate());
     resize(v.size_x(), v.size_y(), v.size_z(), true);
@@ -58,7 +73,13 @@ public:
   }
 
   // virtual destructor
-  virtual ~array3() {}
+  virtual ~array3()
+  {
+    // write modified blocks back to mapped file
+    if (mapped())
+      flush_cache();
+    free_cursors();
+  }
 
   // assignment operator--performs a deep copy
   array3& operator=(const array3& a)
@@ -116,13 +137,34 @@ public:
     cache.resize(lines(csize, nx, ny, nz));
   }
 
+  // enable or disable thread-safe concurrent reads via const accessors and
+  // views, which then share decompressed blocks; returns true if enabled
+  // (requires OpenMP and fixed rate).  Mutators must not be called
+  // concurrently.
+  bool set_concurrent(bool enable)
+  {
+    free_cursors();
+    enable = cache.set_concurrent(enable && !variable_rate());
+    alloc_cursors();
+    return enable;
+  }
+
+  // are concurrent reads enabled?
+  bool concurrent() const { return cache.concurrent(); }
+
   // empty cache without compressing modified cached blocks
   void clear_cache() const { cache.clear(); }
 
   // flush cache by compressing all modified cached blocks
   void flush_cache() const
   {
-    for (typename Cache<CacheLine>::const_iterator p = cache.first(); p; p++) {
+#ifdef _OPENMP
+    if (omp_threads()) {
+      flush_parallel();
+      return;
+    }
+#endif
+    for (typename Cache<CacheLine, Policy>::const_iterator p = cache.first(); p; p++) {
       if (p->tag.dirty()) {
         uint b = p->tag.index() - 1;
         encode(b, p->line->data());
@@ -134,6 +176,12 @@ public:
   // decompress array and store at p
   void get(Scalar* p) const
   {
+#ifdef _OPENMP
+    if (omp_threads()) {
+      get_parallel(p);
+      return;
+    }
+#endif
     uint b = 0;
     for (uint k = 0; k < bz; k++, p += 4 * nx * (ny - by))
       for (uint j = 0; j < by; j++, p += 4 * (nx - bx))
@@ -149,7 +197,14 @@ public:
   // initialize array by copying and compressing data stored at p
   void set(const Scalar* p)
   {
+#ifdef _OPENMP
+    if (omp_threads()) {
+      set_parallel(p);
+      return;
+    }
+#endif
     uint b = 0;
+    discard_blocks();
     for (uint k = 0; k < bz; k++, p += 4 * nx * (ny - by))
       for (uint j = 0; j < by; j++, p += 4 * (nx - bx))
         for (uint i = 0; i < bx; i++, p += 4, b++)
@@ -157,6 +212,65 @@ public:
     cache.clear();
   }
 
+  // decompress subarray [x0, x0 + nx) x [y0, y0 + ny) x [z0, z0 + nz) and
+  // store it at p using strides sx, sy, sz; cached blocks are copied and
+  // all others are decoded directly without being cached
+  void get(uint x0, uint y0, uint z0, uint nx, uint ny, uint nz, Scalar* p, int sx, int sy, int sz) const
+  {
+    uint x1 = x0 + nx;
+    uint y1 = y0 + ny;
+    uint z1 = z0 + nz;
+    for (uint k = z0; k < z1; k = (k & ~3u) + 4)
+      for (uint j = y0; j < y1; j = (j & ~3u) + 4)
+        for (uint i = x0; i < x1; i = (i & ~3u) + 4) {
+          // intersection of block and subarray
+          uint mx = std::min(x1, (i & ~3u) + 4) - i;
+          uint my = std::min(y1, (j & ~3u) + 4) - j;
+          uint mz = std::min(z1, (k & ~3u) + 4) - k;
+          uint b = block(i, j, k);
+          Scalar* q = p + (ptrdiff_t)(i - x0) * sx + (ptrdiff_t)(j - y0) * sy + (ptrdiff_t)(k - z0) * sz;
+          const CacheLine* line = cache.lookup(b + 1);
+          if (line)
+            line->get(q, sx, sy, sz, i, j, k, mx, my, mz);
+          else if (covered(i, j, k, mx, my, mz))
+            decode(b, q, sx, sy, sz);
+          else {
+            CacheLine tmp;
+            decode(b, tmp.data());
+            tmp.get(q, sx, sy, sz, i, j, k, mx, my, mz);
+          }
+        }
+  }
+
+  // compress subarray [x0, x0 + nx) x [y0, y0 + ny) x [z0, z0 + nz) stored
+  // at p using strides sx, sy, sz; fully covered blocks are encoded
+  // directly and dropped from the cache, while the rest are updated in
+  // cache
+  void set(uint x0, uint y0, uint z0, uint nx, uint ny, uint nz, const Scalar* p, int sx, int sy, int sz)
+  {
+    uint x1 = x0 + nx;
+    uint y1 = y0 + ny;
+    uint z1 = z0 + nz;
+    for (uint k = z0; k < z1; k = (k & ~3u) + 4)
+      for (uint j = y0; j < y1; j = (j & ~3u) + 4)
+        for (uint i = x0; i < x1; i = (i & ~3u) + 4) {
+          // intersection of block and subarray
+          uint mx = std::min(x1, (i & ~3u) + 4) - i;
+          uint my = std::min(y1, (j & ~3u) + 4) - j;
+          uint mz = std::min(z1, (k & ~3u) + 4) - k;
+          uint b = block(i, j, k);
+          const Scalar* q = p + (ptrdiff_t)(i - x0) * sx + (ptrdiff_t)(j - y0) * sy + (ptrdiff_t)(k - z0) * sz;
+          if (covered(i, j, k, mx, my, mz)) {
+            const CacheLine* cached = cache.lookup(b + 1);
+            if (cached)
+              cache.flush(cached);
+            encode(b, q, sx, sy, sz);
+          }
+          else
+            line(i, j, k, true)->set(q, sx, sy, sz, i, j, k, mx, my, mz);
+        }
+  }
+
   // (i, j, k) accessors
   Scalar operator()(uint i, uint j, uint k) const { return get(i, j, k); }
   reference operator()(uint i, uint j, uint k) { return reference(this, i, j, k); }
@@ -178,6 +292,32 @@ public:
     return reference(this, i, j, k);
   }
 
+  // apply f(i, j, k, block) to each block in array order, where (i, j, k)
+  // is the block's first value and block points to its decoded 4x4x4 values,
+  // stored with i varying fastest.  The pointer is valid only during the
+  // call, which must not access the array.  Values that fall outside the
+  // array in a partial block are undefined.  Not thread-safe, even when
+  // concurrent reads are enabled.
+  template <class Function>
+  void for_each_block(Function f) const
+  {
+    for (uint k = 0; k < nz; k += 4)
+      for (uint j = 0; j < ny; j += 4)
+        for (uint i = 0; i < nx; i += 4)
+          f(i, j, k, static_cast<const Scalar*>(line(i, j, k, false)->data()));
+  }
+
+  // as above, but blocks may be modified and are compressed upon eviction
+  // or when the cache is flushed; apply to a const array to only read
+  template <class Function>
+  void for_each_block(Function f)
+  {
+    for (uint k = 0; k < nz; k += 4)
+      for (uint j = 0; j < ny; j += 4)
+        for (uint i = 0; i < nx; i += 4)
+          f(i, j, k, line(i, j, k, true)->data());
+  }
+
   // sequential iterators
   iterator begin() { return iterator(this, 0, 0, 0); }
   iterator end() { return iterator(this, 0, 0, nz); }
@@ -215,6 +355,22 @@ protected:
               *p = *q;
       }
     }
+    // copy subblock [i, i + nx) x [j, j + ny) x [k, k + nz) to p
+    void get(Scalar* p, int sx, int sy, int sz, uint i, uint j, uint k, uint nx, uint ny, uint nz) const
+    {
+      for (uint z = 0; z < nz; z++)
+        for (uint y = 0; y < ny; y++)
+          for (uint x = 0; x < nx; x++)
+            p[(ptrdiff_t)x * sx + (ptrdiff_t)y * sy + (ptrdiff_t)z * sz] = a[index(i + x, j + y, k + z)];
+    }
+    // copy p to subblock [i, i + nx) x [j, j + ny) x [k, k + nz)
+    void set(const Scalar* p, int sx, int sy, int sz, uint i, uint j, uint k, uint nx, uint ny, uint nz)
+    {
+      for (uint z = 0; z < nz; z++)
+        for (uint y = 0; y < ny; y++)
+          for (uint x = 0; x < nx; x++)
+            a[index(i + x, j + y, k + z)] = p[(ptrdiff_t)x * sx + (ptrdiff_t)y * sy + (ptrdiff_t)z * sz];
+    }
   protected:
     static uint index(uint i, uint j, uint k) { return (i & 3u) + 4 * ((j & 3u) + 4 * (k & 3u)); }
     Scalar a[64];
@@ -226,16 +382,48 @@ protected:
     // copy base class members
     array::deep_copy(a);
     // copy cache
+    free_cursors();
     cache = a.cache;
+    alloc_cursors();
   }
 
   // inspector
   Scalar get(uint i, uint j, uint k) const
   {
+    if (cache.concurrent())
+      return get_shared(i, j, k);
     const CacheLine* p = line(i, j, k, false);
     return (*p)(i, j, k);
   }
 
+  // thread-safe inspector; locks cache line while fetching and reading it
+  Scalar get_shared(uint i, uint j, uint k) const
+  {
+    CacheLine* p = 0;
+    uint b = block(i, j, k);
+    uint s = cache.acquire(b + 1);
+    typename Cache<CacheLine, Policy>::Tag t = cache.access(p, b + 1, false);
+    uint c = t.index() - 1;
+    if (c != b) {
+      // use bit stream cursor owned by lock stripe
+      zfp_stream* z = stripe_cursor(s);
+      // write back occupied cache line if it is dirty
+      if (t.dirty() && variable_rate())
+        encode(c, p->data());
+      else if (t.dirty()) {
+        stream_wseek(z->stream, c * blkbits);
+        Codec::encode_block_3(z, p->data(), shape ? shape[c] : 0);
+        stream_flush(z->stream);
+      }
+      // fetch cache line
+      stream_rseek(z->stream, block_offset(b));
+      Codec::decode_block_3(z, p->data(), shape ? shape[b] : 0);
+    }
+    Scalar val = (*p)(i, j, k);
+    cache.release(b + 1);
+    return val;
+  }
+
   // mutator
   void set(uint i, uint j, uint k, Scalar val)
   {
@@ -254,7 +442,7 @@ protected:
   {
     CacheLine* p = 0;
     uint b = block(i, j, k);
-    typename Cache<CacheLine>::Tag t = cache.access(p, b + 1, write);
+    typename Cache<CacheLine, Policy>::Tag t = cache.access(p, b + 1, write);
     uint c = t.index() - 1;
     if (c != b) {
       // write back occupied cache line if it is dirty
@@ -269,33 +457,157 @@ protected:
   // encode block with given index
   void encode(uint index, const Scalar* block) const
   {
-    stream_wseek(zfp->stream, index * blkbits);
-    Codec::encode_block_3(zfp, block, shape ? shape[index] : 0);
-    stream_flush(zfp->stream);
+    zfp_stream* s = begin_encode(index);
+    Codec::encode_block_3(s, block, shape ? shape[index] : 0);
+    end_encode(index);
   }
 
   // encode block with given index from strided array
   void encode(uint index, const Scalar* p, int sx, int sy, int sz) const
   {
-    stream_wseek(zfp->stream, index * blkbits);
-    Codec::encode_block_strided_3(zfp, p, shape ? shape[index] : 0, sx, sy, sz);
-    stream_flush(zfp->stream);
+    zfp_stream* s = begin_encode(index);
+    Codec::encode_block_strided_3(s, p, shape ? shape[index] : 0, sx, sy, sz);
+    end_encode(index);
   }
 
   // decode block with given index
   void decode(uint index, Scalar* block) const
   {
-    stream_rseek(zfp->stream, index * blkbits);
+    stream_rseek(zfp->stream, block_offset(index));
     Codec::decode_block_3(zfp, block, shape ? shape[index] : 0);
   }
 
   // decode block with given index to strided array
   void decode(uint index, Scalar* p, int sx, int sy, int sz) const
   {
-    stream_rseek(zfp->stream, index * blkbits);
+    stream_rseek(zfp->stream, block_offset(index));
     Codec::decode_block_strided_3(zfp, p, shape ? shape[index] : 0, sx, sy, sz);
   }
 
+  // disable concurrent reads before switching to variable-rate storage
+  virtual void disable_concurrency() { set_concurrent(false); }
+
+  // allocate one bit stream cursor per cache lock stripe
+  void alloc_cursors()
+  {
+    uint n = cache.stripes();
+    if (n) {
+      cursor = new zfp_stream*[n];
+      std::fill(cursor, cursor + n, static_cast<zfp_stream*>(0));
+    }
+  }
+
+  // free bit stream cursors
+  void free_cursors()
+  {
+    if (cursor) {
+      for (uint s = 0; s < cache.stripes(); s++)
+        if (cursor[s]) {
+          stream_close(cursor[s]->stream);
+          zfp_stream_close(cursor[s]);
+        }
+      delete[] cursor;
+      cursor = 0;
+    }
+  }
+
+  // return up-to-date cursor for lock stripe s (caller must hold its lock)
+  zfp_stream* stripe_cursor(uint s) const
+  {
+    zfp_stream*& z = cursor[s];
+    if (!z)
+      z = zfp_stream_open(0);
+    bitstream* stream = z->stream;
+    // rebind stream if compressed data has been reallocated
+    if (!stream || stream_data(stream) != data || stream_capacity(stream) != bytes) {
+      stream_close(stream);
+      stream = stream_open(data, bytes);
+    }
+    // copy current compression parameters
+    *z = *zfp;
+    z->stream = stream;
+    return z;
+  }
+
+#ifdef _OPENMP
+  // parallel flush_cache() for fixed-rate arrays
+  void flush_parallel() const
+  {
+    int n = int(cache.size());
+    #pragma omp parallel num_threads(omp_threads())
+    {
+      zfp_stream* s = open_cursor();
+      #pragma omp for
+      for (int i = 0; i < n; i++) {
+        typename Cache<CacheLine, Policy>::Tag t;
+        const CacheLine* line = cache.slot(uint(i), t);
+        if (t.dirty()) {
+          uint b = t.index() - 1;
+          stream_wseek(s->stream, b * blkbits);
+          Codec::encode_block_3(s, line->data(), shape ? shape[b] : 0);
+          stream_flush(s->stream);
+        }
+      }
+      close_cursor(s);
+    }
+    cache.clear();
+  }
+
+  // parallel get() for fixed-rate arrays
+  void get_parallel(Scalar* p) const
+  {
+    int n = int(blocks);
+    #pragma omp parallel num_threads(omp_threads())
+    {
+      zfp_stream* s = open_cursor();
+      #pragma omp for
+      for (int b = 0; b < n; b++) {
+        uint x = 4 * (uint(b) % bx);
+        uint y = 4 * (uint(b) / bx % by);
+        uint z = 4 * (uint(b) / bx / by);
+        Scalar* q = p + x + size_t(nx) * (y + size_t(ny) * z);
+        const CacheLine* line = cache.lookup(b + 1);
+        if (line)
+          line->get(q, 1, nx, nx * ny, shape ? shape[b] : 0);
+        else {
+          stream_rseek(s->stream, b * blkbits);
+          Codec::decode_block_strided_3(s, q, shape ? shape[b] : 0, 1, nx, nx * ny);
+        }
+      }
+      close_cursor(s);
+    }
+  }
+
+  // parallel set() for fixed-rate arrays
+  void set_parallel(const Scalar* p)
+  {
+    int n = int(blocks);
+    #pragma omp parallel num_threads(omp_threads())
+    {
+      zfp_stream* s = open_cursor();
+      #pragma omp for
+      for (int b = 0; b < n; b++) {
+        uint x = 4 * (uint(b) % bx);
+        uint y = 4 * (uint(b) / bx % by);
+        uint z = 4 * (uint(b) / bx / by);
+        const Scalar* q = p + x + size_t(nx) * (y + size_t(ny) * z);
+        stream_wseek(s->stream, b * blkbits);
+        Codec::encode_block_strided_3(s, q, shape ? shape[b] : 0, 1, nx, nx * ny);
+        stream_flush(s->stream);
+      }
+      close_cursor(s);
+    }
+    cache.clear();
+  }
+#endif
+
+  // is the block whose intersection with a subarray starts at (i, j, k) and has
+  // dimensions mx * my * mz covered in full?
+  bool covered(uint i, uint j, uint k, uint mx, uint my, uint mz) const
+  {
+    return !((i | j | k) & 3u) && i + mx == std::min(i + 4, nx) && j + my == std::min(j + 4, ny) && k + mz == std::min(k + 4, nz);
+  }
+
   // block index for (i, j, k)
   uint block(uint i, uint j, uint k) const { return (i / 4) + bx * ((j / 4) + by * (k / 4)); }
 
@@ -316,7 +628,8 @@ protected:
     return std::max(n, 1u);
   }
 
-  mutable Cache<CacheLine> cache; // cache of decompressed blocks
+  mutable Cache<CacheLine, Policy> cache; // cache of decompressed blocks
+  zfp_stream** cursor;            // per-stripe streams for concurrent reads
 };
 
 typedef array3<float> array3f;
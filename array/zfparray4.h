@@ -0,0 +1,664 @@
+#ifndef ZFP_ARRAY4_H
+#define ZFP_ARRAY4_H
+
+#include <cstddef>
+#include <iterator>
+#include "zfparray.h"
+#include "zfpcodec.h"
+#include "zfp/cache.h"
+
+namespace zfp {
+
+// compressed 4D array of scalars
+template < typename Scalar, class Codec = zfp::codec<Scalar>, class Policy = CacheDefaultPolicy >
+class array4 : public array {
+public:
+  // forward declarations
+  class reference;
+  class pointer;
+  class iterator;
+  class view;
+  #include "zfp/reference4.h"
+  #include "zfp/pointer4.h"
+  #include "zfp/iterator4.h"
+  #include "zfp/view4.h"
+
+  // default constructor
+  array4() : array(4, Codec::type), cursor(0) {}
+
+  // constructor of nx * ny * nz * nw array using rate bits per value, at
+  // least csize bytes of cache, and optionally initialized from flat array p
+  array4(uint nx, uint ny, uint nz, uint nw, double rate, const Scalar* p = 0, size_t csize = 0) :
+    array(4, Codec::type),
+    cache(lines(csize, nx, ny, nz, nw)),
+    cursor(0)
+  {
+    set_rate(rate);
+    resize(nx, ny, nz, nw, p == 0);
+    if (p)
+      set(p);
+  }
+
+  // constructor of nx * ny * nz * nw array using rate bits per value and at
+  // least csize bytes of cache, whose compressed data is mapped to the file
+  // at path (see map(); the array is held in memory if mapping fails)
+  array4(const char* path, uint nx, uint ny, uint nz, uint nw, double rate, bool read_only = false, size_t csize = 0) :
+    array(4, Codec::type),
+    cache(lines(csize, nx, ny, nz, nw)),
+    cursor(0)
+  {
+    set_rate(rate);
+    resize(nx, ny, nz, nw, !map(path, read_only));
+  }
+
+  // copy constructor--performs a deep copy
+  array4(const array4& a) :
+    cursor(0)
+  {
+    deep_copy(a);
+  }
+
+  // construction from view--perform deep copy of (sub)array
+  template <class View>
+  array4(const View& v) :
+    array(4, Codec::type),
+    cache(lines(0, v.size_x(), v.size_y(), v.size_z(), v.size_w())),
+    cursor(0)
+  {
+    set_rate(v.rate());
+    resize(v.size_x(), v.size_y(), v.size_z(), v.size_w(), true);
+    // initialize array in its preferred order
+    for (iterator it = begin(); it != end(); ++it)
+      *it = v(it.i(), it.j(), it.k(), it.l());
+  }
+
+  // virtual destructor
+  virtual ~array4()
+  {
+    // write modified blocks back to mapped file
+    if (mapped())
+      flush_cache();
+    free_cursors();
+  }
+
+  // assignment operator--performs a deep copy
+  array4& operator=(const array4& a)
+  {
+    if (this != &a)
+      deep_copy(a);
+    return *this;
+  }
+
+  // total number of elements in array
+  size_t size() const { return size_t(nx) * size_t(ny) * size_t(nz) * size_t(nw); }
+
+  // array dimensions
+  uint size_x() const { return nx; }
+  uint size_y() const { return ny; }
+  uint size_z() const { return nz; }
+  uint size_w() const { return nw; }
+
+  // resize the array (all previously stored data will be lost)
+  void resize(uint nx, uint ny, uint nz, uint nw, bool clear = true)
+  {
+    if (nx == 0 || ny == 0 || nz == 0 || nw == 0)
+      free();
+    else {
+      this->nx = nx;
+      this->ny = ny;
+      this->nz = nz;
+      this->nw = nw;
+      bx = (nx + 3) / 4;
+      by = (ny + 3) / 4;
+      bz = (nz + 3) / 4;
+      bw = (nw + 3) / 4;
+      blocks = bx * by * bz * bw;
+      alloc(clear);
+
+      // precompute block dimensions
+      deallocate(shape);
+      if ((nx | ny | nz | nw) & 3u) {
+        shape = (uchar*)allocate(blocks);
+        uchar* p = shape;
+        for (uint l = 0; l < bw; l++)
+          for (uint k = 0; k < bz; k++)
+            for (uint j = 0; j < by; j++)
+              for (uint i = 0; i < bx; i++)
+                *p++ = (i == bx - 1 ? -nx & 3u : 0) + 4 * ((j == by - 1 ? -ny & 3u : 0) + 4 * ((k == bz - 1 ? -nz & 3u : 0) + 4 * (l == bw - 1 ? -nw & 3u : 0)));
+      }
+      else
+        shape = 0;
+    }
+  }
+
+  // cache size in number of bytes
+  size_t cache_size() const { return cache.size() * sizeof(CacheLine); }
+
+  // set minimum cache size in bytes (array dimensions must be known)
+  void set_cache_size(size_t csize)
+  {
+    flush_cache();
+    cache.resize(lines(csize, nx, ny, nz, nw));
+  }
+
+  // enable or disable thread-safe concurrent reads via const accessors and
+  // views, which then share decompressed blocks; returns true if enabled
+  // (requires OpenMP and fixed rate).  Mutators must not be called
+  // concurrently.
+  bool set_concurrent(bool enable)
+  {
+    free_cursors();
+    enable = cache.set_concurrent(enable && !variable_rate());
+    alloc_cursors();
+    return enable;
+  }
+
+  // are concurrent reads enabled?
+  bool concurrent() const { return cache.concurrent(); }
+
+  // empty cache without compressing modified cached blocks
+  void clear_cache() const { cache.clear(); }
+
+  // flush cache by compressing all modified cached blocks
+  void flush_cache() const
+  {
+#ifdef _OPENMP
+    if (omp_threads()) {
+      flush_parallel();
+      return;
+    }
+#endif
+    for (typename Cache<CacheLine, Policy>::const_iterator p = cache.first(); p; p++) {
+      if (p->tag.dirty()) {
+        uint b = p->tag.index() - 1;
+        encode(b, p->line->data());
+      }
+      cache.flush(p->line);
+    }
+  }
+
+  // decompress array and store at p
+  void get(Scalar* p) const
+  {
+#ifdef _OPENMP
+    if (omp_threads()) {
+      get_parallel(p);
+      return;
+    }
+#endif
+    uint b = 0;
+    for (uint l = 0; l < bw; l++, p += 4 * nx * ny * (nz - bz))
+      for (uint k = 0; k < bz; k++, p += 4 * nx * (ny - by))
+        for (uint j = 0; j < by; j++, p += 4 * (nx - bx))
+          for (uint i = 0; i < bx; i++, p += 4, b++) {
+            const CacheLine* line = cache.lookup(b + 1);
+            if (line)
+              line->get(p, 1, nx, nx * ny, nx * ny * nz, shape ? shape[b] : 0);
+            else
+              decode(b, p, 1, nx, nx * ny, nx * ny * nz);
+          }
+  }
+
+  // initialize array by copying and compressing data stored at p
+  void set(const Scalar* p)
+  {
+#ifdef _OPENMP
+    if (omp_threads()) {
+      set_parallel(p);
+      return;
+    }
+#endif
+    uint b = 0;
+    discard_blocks();
+    for (uint l = 0; l < bw; l++, p += 4 * nx * ny * (nz - bz))
+      for (uint k = 0; k < bz; k++, p += 4 * nx * (ny - by))
+        for (uint j = 0; j < by; j++, p += 4 * (nx - bx))
+          for (uint i = 0; i < bx; i++, p += 4, b++)
+            encode(b, p, 1, nx, nx * ny, nx * ny * nz);
+    cache.clear();
+  }
+
+  // decompress subarray [x0, x0 + nx) x [y0, y0 + ny) x [z0, z0 + nz) x
+  // [w0, w0 + nw) and store it at p using strides sx, sy, sz, sw; cached
+  // blocks are copied and all others are decoded directly without being
+  // cached
+  void get(uint x0, uint y0, uint z0, uint w0, uint nx, uint ny, uint nz, uint nw, Scalar* p, int sx, int sy, int sz, int sw) const
+  {
+    uint x1 = x0 + nx;
+    uint y1 = y0 + ny;
+    uint z1 = z0 + nz;
+    uint w1 = w0 + nw;
+    for (uint l = w0; l < w1; l = (l & ~3u) + 4)
+      for (uint k = z0; k < z1; k = (k & ~3u) + 4)
+        for (uint j = y0; j < y1; j = (j & ~3u) + 4)
+          for (uint i = x0; i < x1; i = (i & ~3u) + 4) {
+            // intersection of block and subarray
+            uint mx = std::min(x1, (i & ~3u) + 4) - i;
+            uint my = std::min(y1, (j & ~3u) + 4) - j;
+            uint mz = std::min(z1, (k & ~3u) + 4) - k;
+            uint mw = std::min(w1, (l & ~3u) + 4) - l;
+            uint b = block(i, j, k, l);
+            Scalar* q = p + (ptrdiff_t)(i - x0) * sx + (ptrdiff_t)(j - y0) * sy + (ptrdiff_t)(k - z0) * sz + (ptrdiff_t)(l - w0) * sw;
+            const CacheLine* line = cache.lookup(b + 1);
+            if (line)
+              line->get(q, sx, sy, sz, sw, i, j, k, l, mx, my, mz, mw);
+            else if (covered(i, j, k, l, mx, my, mz, mw))
+              decode(b, q, sx, sy, sz, sw);
+            else {
+              CacheLine tmp;
+              decode(b, tmp.data());
+              tmp.get(q, sx, sy, sz, sw, i, j, k, l, mx, my, mz, mw);
+            }
+          }
+  }
+
+  // compress subarray [x0, x0 + nx) x [y0, y0 + ny) x [z0, z0 + nz) x
+  // [w0, w0 + nw) stored at p using strides sx, sy, sz, sw; fully covered
+  // blocks are encoded directly and dropped from the cache, while the rest
+  // are updated in cache
+  void set(uint x0, uint y0, uint z0, uint w0, uint nx, uint ny, uint nz, uint nw, const Scalar* p, int sx, int sy, int sz, int sw)
+  {
+    uint x1 = x0 + nx;
+    uint y1 = y0 + ny;
+    uint z1 = z0 + nz;
+    uint w1 = w0 + nw;
+    for (uint l = w0; l < w1; l = (l & ~3u) + 4)
+      for (uint k = z0; k < z1; k = (k & ~3u) + 4)
+        for (uint j = y0; j < y1; j = (j & ~3u) + 4)
+          for (uint i = x0; i < x1; i = (i & ~3u) + 4) {
+            // intersection of block and subarray
+            uint mx = std::min(x1, (i & ~3u) + 4) - i;
+            uint my = std::min(y1, (j & ~3u) + 4) - j;
+            uint mz = std::min(z1, (k & ~3u) + 4) - k;
+            uint mw = std::min(w1, (l & ~3u) + 4) - l;
+            uint b = block(i, j, k, l);
+            const Scalar* q = p + (ptrdiff_t)(i - x0) * sx + (ptrdiff_t)(j - y0) * sy + (ptrdiff_t)(k - z0) * sz + (ptrdiff_t)(l - w0) * sw;
+            if (covered(i, j, k, l, mx, my, mz, mw)) {
+              const CacheLine* cached = cache.lookup(b + 1);
+              if (cached)
+                cache.flush(cached);
+              encode(b, q, sx, sy, sz, sw);
+            }
+            else
+              line(i, j, k, l, true)->set(q, sx, sy, sz, sw, i, j, k, l, mx, my, mz, mw);
+          }
+  }
+
+  // (i, j, k, l) accessors
+  Scalar operator()(uint i, uint j, uint k, uint l) const { return get(i, j, k, l); }
+  reference operator()(uint i, uint j, uint k, uint l) { return reference(this, i, j, k, l); }
+
+  // flat index corresponding to (i, j, k, l)
+  uint index(uint i, uint j, uint k, uint l) const { return i + nx * (j + ny * (k + nz * l)); }
+
+  // flat index accessors
+  Scalar operator[](uint index) const
+  {
+    uint i, j, k, l;
+    ijkl(i, j, k, l, index);
+    return get(i, j, k, l);
+  }
+  reference operator[](uint index)
+  {
+    uint i, j, k, l;
+    ijkl(i, j, k, l, index);
+    return reference(this, i, j, k, l);
+  }
+
+  // apply f(i, j, k, l, block) to each block in array order, where
+  // (i, j, k, l) is the block's first value and block points to its decoded
+  // 4x4x4x4 values, stored with i varying fastest.  The pointer is valid only
+  // during the call, which must not access the array.  Values that fall
+  // outside the array in a partial block are undefined.  Not thread-safe,
+  // even when concurrent reads are enabled.
+  template <class Function>
+  void for_each_block(Function f) const
+  {
+    for (uint l = 0; l < nw; l += 4)
+      for (uint k = 0; k < nz; k += 4)
+        for (uint j = 0; j < ny; j += 4)
+          for (uint i = 0; i < nx; i += 4)
+            f(i, j, k, l, static_cast<const Scalar*>(line(i, j, k, l, false)->data()));
+  }
+
+  // as above, but blocks may be modified and are compressed upon eviction
+  // or when the cache is flushed; apply to a const array to only read
+  template <class Function>
+  void for_each_block(Function f)
+  {
+    for (uint l = 0; l < nw; l += 4)
+      for (uint k = 0; k < nz; k += 4)
+        for (uint j = 0; j < ny; j += 4)
+          for (uint i = 0; i < nx; i += 4)
+            f(i, j, k, l, line(i, j, k, l, true)->data());
+  }
+
+  // sequential iterators
+  iterator begin() { return iterator(this, 0, 0, 0, 0); }
+  iterator end() { return iterator(this, 0, 0, 0, nw); }
+
+protected:
+  // cache line representing one block of decompressed values
+  class CacheLine {
+  public:
+    Scalar operator()(uint i, uint j, uint k, uint l) const { return a[index(i, j, k, l)]; }
+    Scalar& operator()(uint i, uint j, uint k, uint l) { return a[index(i, j, k, l)]; }
+    const Scalar* data() const { return a; }
+    Scalar* data() { return a; }
+    // copy cache line
+    void get(Scalar* p, int sx, int sy, int sz, int sw) const
+    {
+      const Scalar* q = a;
+      for (uint w = 0; w < 4; w++, p += sw - 4 * sz)
+        for (uint z = 0; z < 4; z++, p += sz - 4 * sy)
+          for (uint y = 0; y < 4; y++, p += sy - 4 * sx)
+            for (uint x = 0; x < 4; x++, p += sx, q++)
+              *p = *q;
+    }
+    void get(Scalar* p, int sx, int sy, int sz, int sw, uint shape) const
+    {
+      if (!shape)
+        get(p, sx, sy, sz, sw);
+      else {
+        // determine block dimensions
+        uint nx = 4 - (shape & 3u); shape >>= 2;
+        uint ny = 4 - (shape & 3u); shape >>= 2;
+        uint nz = 4 - (shape & 3u); shape >>= 2;
+        uint nw = 4 - (shape & 3u); shape >>= 2;
+        const Scalar* q = a;
+        for (uint w = 0; w < nw; w++, p += sw - (ptrdiff_t)nz * sz, q += 64 - 16 * nz)
+          for (uint z = 0; z < nz; z++, p += sz - (ptrdiff_t)ny * sy, q += 16 - 4 * ny)
+            for (uint y = 0; y < ny; y++, p += sy - (ptrdiff_t)nx * sx, q += 4 - nx)
+              for (uint x = 0; x < nx; x++, p += sx, q++)
+                *p = *q;
+      }
+    }
+    // copy subblock [i, i + nx) x [j, j + ny) x [k, k + nz) x [l, l + nw) to p
+    void get(Scalar* p, int sx, int sy, int sz, int sw, uint i, uint j, uint k, uint l, uint nx, uint ny, uint nz, uint nw) const
+    {
+      for (uint w = 0; w < nw; w++)
+        for (uint z = 0; z < nz; z++)
+          for (uint y = 0; y < ny; y++)
+            for (uint x = 0; x < nx; x++)
+              p[(ptrdiff_t)x * sx + (ptrdiff_t)y * sy + (ptrdiff_t)z * sz + (ptrdiff_t)w * sw] = a[index(i + x, j + y, k + z, l + w)];
+    }
+    // copy p to subblock [i, i + nx) x [j, j + ny) x [k, k + nz) x [l, l + nw)
+    void set(const Scalar* p, int sx, int sy, int sz, int sw, uint i, uint j, uint k, uint l, uint nx, uint ny, uint nz, uint nw)
+    {
+      for (uint w = 0; w < nw; w++)
+        for (uint z = 0; z < nz; z++)
+          for (uint y = 0; y < ny; y++)
+            for (uint x = 0; x < nx; x++)
+              a[index(i + x, j + y, k + z, l + w)] = p[(ptrdiff_t)x * sx + (ptrdiff_t)y * sy + (ptrdiff_t)z * sz + (ptrdiff_t)w * sw];
+    }
+  protected:
+    static uint index(uint i, uint j, uint k, uint l) { return (i & 3u) + 4 * ((j & 3u) + 4 * ((k & 3u) + 4 * (l & 3u))); }
+    Scalar a[256];
+  };
+
+  // perform a deep copy
+  void deep_copy(const array4& a)
+  {
+    // copy base class members
+    array::deep_copy(a);
+    // copy cache
+    free_cursors();
+    cache = a.cache;
+    alloc_cursors();
+  }
+
+  // inspector
+  Scalar get(uint i, uint j, uint k, uint l) const
+  {
+    if (cache.concurrent())
+      return get_shared(i, j, k, l);
+    const CacheLine* p = line(i, j, k, l, false);
+    return (*p)(i, j, k, l);
+  }
+
+  // thread-safe inspector; locks cache line while fetching and reading it
+  Scalar get_shared(uint i, uint j, uint k, uint l) const
+  {
+    CacheLine* p = 0;
+    uint b = block(i, j, k, l);
+    uint s = cache.acquire(b + 1);
+    typename Cache<CacheLine, Policy>::Tag t = cache.access(p, b + 1, false);
+    uint c = t.index() - 1;
+    if (c != b) {
+      // use bit stream cursor owned by lock stripe
+      zfp_stream* z = stripe_cursor(s);
+      // write back occupied cache line if it is dirty
+      if (t.dirty() && variable_rate())
+        encode(c, p->data());
+      else if (t.dirty()) {
+        stream_wseek(z->stream, c * blkbits);
+        Codec::encode_block_4(z, p->data(), shape ? shape[c] : 0);
+        stream_flush(z->stream);
+      }
+      // fetch cache line
+      stream_rseek(z->stream, block_offset(b));
+      Codec::decode_block_4(z, p->data(), shape ? shape[b] : 0);
+    }
+    Scalar val = (*p)(i, j, k, l);
+    cache.release(b + 1);
+    return val;
+  }
+
+  // mutator
+  void set(uint i, uint j, uint k, uint l, Scalar val)
+  {
+    CacheLine* p = line(i, j, k, l, true);
+    (*p)(i, j, k, l) = val;
+  }
+
+  // in-place updates
+  void add(uint i, uint j, uint k, uint l, Scalar val) { (*line(i, j, k, l, true))(i, j, k, l) += val; }
+  void sub(uint i, uint j, uint k, uint l, Scalar val) { (*line(i, j, k, l, true))(i, j, k, l) -= val; }
+  void mul(uint i, uint j, uint k, uint l, Scalar val) { (*line(i, j, k, l, true))(i, j, k, l) *= val; }
+  void div(uint i, uint j, uint k, uint l, Scalar val) { (*line(i, j, k, l, true))(i, j, k, l) /= val; }
+
+  // return cache line for (i, j, k, l); may require write-back and fetch
+  CacheLine* line(uint i, uint j, uint k, uint l, bool write) const
+  {
+    CacheLine* p = 0;
+    uint b = block(i, j, k, l);
+    typename Cache<CacheLine, Policy>::Tag t = cache.access(p, b + 1, write);
+    uint c = t.index() - 1;
+    if (c != b) {
+      // write back occupied cache line if it is dirty
+      if (t.dirty())
+        encode(c, p->data());
+      // fetch cache line
+      decode(b, p->data());
+    }
+    return p;
+  }
+
+  // encode block with given index
+  void encode(uint index, const Scalar* block) const
+  {
+    zfp_stream* s = begin_encode(index);
+    Codec::encode_block_4(s, block, shape ? shape[index] : 0);
+    end_encode(index);
+  }
+
+  // encode block with given index from strided array
+  void encode(uint index, const Scalar* p, int sx, int sy, int sz, int sw) const
+  {
+    zfp_stream* s = begin_encode(index);
+    Codec::encode_block_strided_4(s, p, shape ? shape[index] : 0, sx, sy, sz, sw);
+    end_encode(index);
+  }
+
+  // decode block with given index
+  void decode(uint index, Scalar* block) const
+  {
+    stream_rseek(zfp->stream, block_offset(index));
+    Codec::decode_block_4(zfp, block, shape ? shape[index] : 0);
+  }
+
+  // decode block with given index to strided array
+  void decode(uint index, Scalar* p, int sx, int sy, int sz, int sw) const
+  {
+    stream_rseek(zfp->stream, block_offset(index));
+    Codec::decode_block_strided_4(zfp, p, shape ? shape[index] : 0, sx, sy, sz, sw);
+  }
+
+  // disable concurrent reads before switching to variable-rate storage
+  virtual void disable_concurrency() { set_concurrent(false); }
+
+  // allocate one bit stream cursor per cache lock stripe
+  void alloc_cursors()
+  {
+    uint n = cache.stripes();
+    if (n) {
+      cursor = new zfp_stream*[n];
+      std::fill(cursor, cursor + n, static_cast<zfp_stream*>(0));
+    }
+  }
+
+  // free bit stream cursors
+  void free_cursors()
+  {
+    if (cursor) {
+      for (uint s = 0; s < cache.stripes(); s++)
+        if (cursor[s]) {
+          stream_close(cursor[s]->stream);
+          zfp_stream_close(cursor[s]);
+        }
+      delete[] cursor;
+      cursor = 0;
+    }
+  }
+
+  // return up-to-date cursor for lock stripe s (caller must hold its lock)
+  zfp_stream* stripe_cursor(uint s) const
+  {
+    zfp_stream*& z = cursor[s];
+    if (!z)
+      z = zfp_stream_open(0);
+    bitstream* stream = z->stream;
+    // rebind stream if compressed data has been reallocated
+    if (!stream || stream_data(stream) != data || stream_capacity(stream) != bytes) {
+      stream_close(stream);
+      stream = stream_open(data, bytes);
+    }
+    // copy current compression parameters
+    *z = *zfp;
+    z->stream = stream;
+    return z;
+  }
+
+#ifdef _OPENMP
+  // parallel flush_cache() for fixed-rate arrays
+  void flush_parallel() const
+  {
+    int n = int(cache.size());
+    #pragma omp parallel num_threads(omp_threads())
+    {
+      zfp_stream* s = open_cursor();
+      #pragma omp for
+      for (int i = 0; i < n; i++) {
+        typename Cache<CacheLine, Policy>::Tag t;
+        const CacheLine* line = cache.slot(uint(i), t);
+        if (t.dirty()) {
+          uint b = t.index() - 1;
+          stream_wseek(s->stream, b * blkbits);
+          Codec::encode_block_4(s, line->data(), shape ? shape[b] : 0);
+          stream_flush(s->stream);
+        }
+      }
+      close_cursor(s);
+    }
+    cache.clear();
+  }
+
+  // parallel get() for fixed-rate arrays
+  void get_parallel(Scalar* p) const
+  {
+    int n = int(blocks);
+    #pragma omp parallel num_threads(omp_threads())
+    {
+      zfp_stream* s = open_cursor();
+      #pragma omp for
+      for (int b = 0; b < n; b++) {
+        uint x = 4 * (uint(b) % bx);
+        uint y = 4 * (uint(b) / bx % by);
+        uint z = 4 * (uint(b) / bx / by % bz);
+        uint w = 4 * (uint(b) / bx / by / bz);
+        Scalar* q = p + x + size_t(nx) * (y + size_t(ny) * (z + size_t(nz) * w));
+        const CacheLine* line = cache.lookup(b + 1);
+        if (line)
+          line->get(q, 1, nx, nx * ny, nx * ny * nz, shape ? shape[b] : 0);
+        else {
+          stream_rseek(s->stream, b * blkbits);
+          Codec::decode_block_strided_4(s, q, shape ? shape[b] : 0, 1, nx, nx * ny, nx * ny * nz);
+        }
+      }
+      close_cursor(s);
+    }
+  }
+
+  // parallel set() for fixed-rate arrays
+  void set_parallel(const Scalar* p)
+  {
+    int n = int(blocks);
+    #pragma omp parallel num_threads(omp_threads())
+    {
+      zfp_stream* s = open_cursor();
+      #pragma omp for
+      for (int b = 0; b < n; b++) {
+        uint x = 4 * (uint(b) % bx);
+        uint y = 4 * (uint(b) / bx % by);
+        uint z = 4 * (uint(b) / bx / by % bz);
+        uint w = 4 * (uint(b) / bx / by / bz);
+        const Scalar* q = p + x + size_t(nx) * (y + size_t(ny) * (z + size_t(nz) * w));
+        stream_wseek(s->stream, b * blkbits);
+        Codec::encode_block_strided_4(s, q, shape ? shape[b] : 0, 1, nx, nx * ny, nx * ny * nz);
+        stream_flush(s->stream);
+      }
+      close_cursor(s);
+    }
+    cache.clear();
+  }
+#endif
+
+  // is the block whose intersection with a subarray starts at (i, j, k, l) and has
+  // dimensions mx * my * mz * mw covered in full?
+  bool covered(uint i, uint j, uint k, uint l, uint mx, uint my, uint mz, uint mw) const
+  {
+    return !((i | j | k | l) & 3u) && i + mx == std::min(i + 4, nx) && j + my == std::min(j + 4, ny) && k + mz == std::min(k + 4, nz) && l + mw == std::min(l + 4, nw);
+  }
+
+  // block index for (i, j, k, l)
+  uint block(uint i, uint j, uint k, uint l) const { return (i / 4) + bx * ((j / 4) + by * ((k / 4) + bz * (l / 4))); }
+
+  // convert flat index to (i, j, k, l)
+  void ijkl(uint& i, uint& j, uint& k, uint& l, uint index) const
+  {
+    i = index % nx;
+    index /= nx;
+    j = index % ny;
+    index /= ny;
+    k = index % nz;
+    index /= nz;
+    l = index;
+  }
+
+  // number of cache lines corresponding to size (or suggested size if zero)
+  static uint lines(size_t size, uint nx, uint ny, uint nz, uint nw)
+  {
+    uint n = uint(((size ? size : 8 * size_t(nx) * ny * nz * sizeof(Scalar)) + sizeof(CacheLine) - 1) / sizeof(CacheLine));
+    return std::max(n, 1u);
+  }
+
+  mutable Cache<CacheLine, Policy> cache; // cache of decompressed blocks
+  zfp_stream** cursor;            // per-stripe streams for concurrent reads
+};
+
+typedef array4<float> array4f;
+typedef array4<double> array4d;
+
+}
+
+#endif
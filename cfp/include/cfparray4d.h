@@ -0,0 +1,41 @@
+#ifndef CFP_ARRAY_4D
+#define CFP_ARRAY_4D
+
+#include <stddef.h>
+#include "zfp/types.h"
+
+struct cfp_array4d;
+typedef struct cfp_array4d cfp_array4d;
+
+typedef struct {
+  cfp_array4d* (*ctor_default)();
+  cfp_array4d* (*ctor)(uint nx, uint ny, uint nz, uint nw, double rate, const double* p, size_t csize);
+  cfp_array4d* (*ctor_copy)(const cfp_array4d* src);
+  void (*dtor)(cfp_array4d* self);
+
+  void (*deep_copy)(cfp_array4d* self, const cfp_array4d* src);
+
+  double (*rate)(const cfp_array4d* self);
+  double (*set_rate)(cfp_array4d* self, double rate);
+  size_t (*cache_size)(const cfp_array4d* self);
+  void (*set_cache_size)(cfp_array4d* self, size_t csize);
+  void (*clear_cache)(const cfp_array4d* self);
+  void (*flush_cache)(const cfp_array4d* self);
+  size_t (*compressed_size)(const cfp_array4d* self);
+  uchar* (*compressed_data)(const cfp_array4d* self);
+  size_t (*size)(const cfp_array4d* self);
+  uint (*size_x)(const cfp_array4d* self);
+  uint (*size_y)(const cfp_array4d* self);
+  uint (*size_z)(const cfp_array4d* self);
+  uint (*size_w)(const cfp_array4d* self);
+  void (*resize)(cfp_array4d* self, uint nx, uint ny, uint nz, uint nw, int clear);
+
+  void (*get_array)(const cfp_array4d* self, double* p);
+  void (*set_array)(cfp_array4d* self, const double* p);
+  double (*get_flat)(const cfp_array4d* self, uint i);
+  void (*set_flat)(cfp_array4d* self, uint i, double val);
+  double (*get)(const cfp_array4d* self, uint i, uint j, uint k, uint l);
+  void (*set)(cfp_array4d* self, uint i, uint j, uint k, uint l, double val);
+} cfp_array4d_api;
+
+#endif
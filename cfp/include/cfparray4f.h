@@ -0,0 +1,41 @@
+#ifndef CFP_ARRAY_4F
+#define CFP_ARRAY_4F
+
+#include <stddef.h>
+#include "zfp/types.h"
+
+struct cfp_array4f;
+typedef struct cfp_array4f cfp_array4f;
+
+typedef struct {
+  cfp_array4f* (*ctor_default)();
+  cfp_array4f* (*ctor)(uint nx, uint ny, uint nz, uint nw, double rate, const float* p, size_t csize);
+  cfp_array4f* (*ctor_copy)(const cfp_array4f* src);
+  void (*dtor)(cfp_array4f* self);
+
+  void (*deep_copy)(cfp_array4f* self, const cfp_array4f* src);
+
+  double (*rate)(const cfp_array4f* self);
+  double (*set_rate)(cfp_array4f* self, double rate);
+  size_t (*cache_size)(const cfp_array4f* self);
+  void (*set_cache_size)(cfp_array4f* self, size_t csize);
+  void (*clear_cache)(const cfp_array4f* self);
+  void (*flush_cache)(const cfp_array4f* self);
+  size_t (*compressed_size)(const cfp_array4f* self);
+  uchar* (*compressed_data)(const cfp_array4f* self);
+  size_t (*size)(const cfp_array4f* self);
+  uint (*size_x)(const cfp_array4f* self);
+  uint (*size_y)(const cfp_array4f* self);
+  uint (*size_z)(const cfp_array4f* self);
+  uint (*size_w)(const cfp_array4f* self);
+  void (*resize)(cfp_array4f* self, uint nx, uint ny, uint nz, uint nw, int clear);
+
+  void (*get_array)(const cfp_array4f* self, float* p);
+  void (*set_array)(cfp_array4f* self, const float* p);
+  float (*get_flat)(const cfp_array4f* self, uint i);
+  void (*set_flat)(cfp_array4f* self, uint i, float val);
+  float (*get)(const cfp_array4f* self, uint i, uint j, uint k, uint l);
+  void (*set)(cfp_array4f* self, uint i, uint j, uint k, uint l, float val);
+} cfp_array4f_api;
+
+#endif
@@ -7,6 +7,8 @@
 #include "cfparray2d.h"
 #include "cfparray3f.h"
 #include "cfparray3d.h"
+#include "cfparray4f.h"
+#include "cfparray4d.h"
 
 #include "zfp/system.h"
 
@@ -17,6 +19,8 @@ typedef struct {
   cfp_array2d_api array2d;
   cfp_array3f_api array3f;
   cfp_array3d_api array3d;
+  cfp_array4f_api array4f;
+  cfp_array4d_api array4d;
 } cfp_api;
 
 #ifndef CFP_NAMESPACE
@@ -6,6 +6,8 @@
 #include "cfparray2d.cpp"
 #include "cfparray3f.cpp"
 #include "cfparray3d.cpp"
+#include "cfparray4f.cpp"
+#include "cfparray4d.cpp"
 
 export_ const cfp_api CFP_NAMESPACE = {
   // array1f
@@ -180,4 +182,66 @@ export_ const cfp_api CFP_NAMESPACE = {
     cfp_array3d_get,
     cfp_array3d_set,
   },
+  // array4f
+  {
+    cfp_array4f_ctor_default,
+    cfp_array4f_ctor,
+    cfp_array4f_ctor_copy,
+    cfp_array4f_dtor,
+
+    cfp_array4f_deep_copy,
+
+    cfp_array4f_rate,
+    cfp_array4f_set_rate,
+    cfp_array4f_cache_size,
+    cfp_array4f_set_cache_size,
+    cfp_array4f_clear_cache,
+    cfp_array4f_flush_cache,
+    cfp_array4f_compressed_size,
+    cfp_array4f_compressed_data,
+    cfp_array4f_size,
+    cfp_array4f_size_x,
+    cfp_array4f_size_y,
+    cfp_array4f_size_z,
+    cfp_array4f_size_w,
+    cfp_array4f_resize,
+
+    cfp_array4f_get_array,
+    cfp_array4f_set_array,
+    cfp_array4f_get_flat,
+    cfp_array4f_set_flat,
+    cfp_array4f_get,
+    cfp_array4f_set,
+  },
+  // array4d
+  {
+    cfp_array4d_ctor_default,
+    cfp_array4d_ctor,
+    cfp_array4d_ctor_copy,
+    cfp_array4d_dtor,
+
+    cfp_array4d_deep_copy,
+
+    cfp_array4d_rate,
+    cfp_array4d_set_rate,
+    cfp_array4d_cache_size,
+    cfp_array4d_set_cache_size,
+    cfp_array4d_clear_cache,
+    cfp_array4d_flush_cache,
+    cfp_array4d_compressed_size,
+    cfp_array4d_compressed_data,
+    cfp_array4d_size,
+    cfp_array4d_size_x,
+    cfp_array4d_size_y,
+    cfp_array4d_size_z,
+    cfp_array4d_size_w,
+    cfp_array4d_resize,
+
+    cfp_array4d_get_array,
+    cfp_array4d_set_array,
+    cfp_array4d_get_flat,
+    cfp_array4d_set_flat,
+    cfp_array4d_get,
+    cfp_array4d_set,
+  },
 };
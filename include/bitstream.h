@@ -48,6 +48,9 @@ uint stream_write_bit(bitstream* stream, uint bit);
 /* read 0 <= n <= 64 bits */
 uint64 stream_read_bits(bitstream* stream, uint n);
 
+/* skip at most n zero-bits and the one-bit ending the run; return zero count */
+uint stream_skip_zeros(bitstream* stream, uint n);
+
 /* write 0 <= n <= 64 low bits of value and return remaining bits */
 uint64 stream_write_bits(bitstream* stream, uint64 value, uint n);
 
@@ -112,24 +112,52 @@
 #define ZFP_HEADER_MAX_BITS 148 /* max number of header bits */
 #define ZFP_MODE_SHORT_MAX  ((1u << ZFP_MODE_SHORT_BITS) - 2)
 
+/* number of bits per chunk index entry (see zfp_stream_set_index) */
+#define ZFP_INDEX_BITS       64
+
+/* chunk index layouts (see zfp_stream_set_index) */
+#define ZFP_INDEX_NONE        0 /* no index */
+#define ZFP_INDEX_PACKED      1 /* chunks are concatenated bit for bit */
+#define ZFP_INDEX_ALIGNED     2 /* chunks begin on stream word boundaries */
+
+/* chunk options (see zfp_frame_writer_append) */
+#define ZFP_FRAME_CHECKSUM  0x1u /* store Adler-32 checksum of chunk data */
+
 /* types ------------------------------------------------------------------- */
 
 /* execution policy */
 typedef enum {
-  zfp_exec_serial = 0, /* serial execution (default) */
-  zfp_exec_omp    = 1, /* OpenMP multi-threaded execution */
-  zfp_exec_cuda   = 2  /* CUDA parallel execution */
+  zfp_exec_serial  = 0, /* serial execution (default) */
+  zfp_exec_omp     = 1, /* OpenMP multi-threaded execution */
+  zfp_exec_cuda    = 2, /* CUDA parallel execution */
+  zfp_exec_threads = 3  /* thread pool or user task multi-threaded execution */
 } zfp_exec_policy;
 
 /* OpenMP execution parameters */
 typedef struct {
   uint threads;    /* number of requested threads */
-  uint chunk_size; /* number of blocks per chunk (1D only) */
+  uint chunk_size; /* number of blocks per chunk */
 } zfp_exec_params_omp;
 
+/* function that runs task(data) asynchronously, e.g. on a task runtime */
+typedef void (*zfp_submit_func)(
+  void* user,             /* user data */
+  void (*task)(void*),    /* task to run */
+  void* data              /* argument to task */
+);
+
+/* thread pool execution parameters */
+typedef struct {
+  uint threads;           /* number of requested threads */
+  uint chunk_size;        /* number of blocks per chunk */
+  zfp_submit_func submit; /* task submission (null for internal pool) */
+  void* user;             /* user data passed to submit */
+} zfp_exec_params_threads;
+
 /* execution parameters */
 typedef union {
-  zfp_exec_params_omp omp; /* OpenMP parameters */
+  zfp_exec_params_omp omp;         /* OpenMP parameters */
+  zfp_exec_params_threads threads; /* thread pool parameters */
 } zfp_exec_params;
 
 typedef struct {
@@ -137,6 +165,35 @@ typedef struct {
   zfp_exec_params params; /* execution parameters */
 } zfp_execution;
 
+/* codec kernel (instruction set that block transform and coder target) */
+typedef enum {
+  zfp_kernel_generic = 0, /* baseline instruction set of the build */
+  zfp_kernel_avx2    = 1, /* x86-64 AVX2 */
+  zfp_kernel_avx512  = 2  /* x86-64 AVX-512 (F, BW, DQ, VL) */
+} zfp_kernel;
+
+/* number of codec stages timed and of bits per block histogram bins */
+#define ZFP_STATS_STAGES  5
+#define ZFP_STATS_BINS   16
+
+/* codec stage timed by zfp_stats (see ZFP_WITH_PROFILE) */
+typedef enum {
+  zfp_stage_exponent = 0, /* common block exponent (exponent_block) */
+  zfp_stage_cast     = 1, /* block-floating-point transform (fwd_cast) */
+  zfp_stage_xform    = 2, /* decorrelating transform (fwd_xform) */
+  zfp_stage_order    = 3, /* coefficient reordering (fwd_order) */
+  zfp_stage_code     = 4  /* embedded coding (encode_ints) */
+} zfp_stage;
+
+/* encoder statistics gathered when built with ZFP_WITH_PROFILE */
+typedef struct {
+  uint64 cycles[ZFP_STATS_STAGES];  /* processor cycles spent per stage */
+  uint64 blocks;                    /* number of blocks encoded */
+  uint64 zero_blocks;               /* floating-point blocks coded as all zeros */
+  uint64 planes;                    /* number of bit planes coded */
+  uint64 histogram[ZFP_STATS_BINS]; /* blocks of 2^i to 2^(i+1)-1 bits */
+} zfp_stats;
+
 /* compressed stream; use accessors to get/set members */
 typedef struct {
   uint minbits;       /* minimum number of bits to store per block */
@@ -145,6 +202,10 @@ typedef struct {
   int minexp;         /* minimum floating point bit plane number to store */
   bitstream* stream;  /* compressed bit stream */
   zfp_execution exec; /* execution policy and parameters */
+  int index;          /* nonzero if stream embeds chunk offset index */
+  zfp_kernel kernel;  /* codec kernel variant */
+  zfp_stats* stats;   /* encoder statistics (or null) */
+  double* timings;    /* per-thread busy time of last OpenMP call (or null) */
 } zfp_stream;
 
 /* compression mode */
@@ -153,7 +214,8 @@ typedef enum {
   zfp_mode_expert          = 1, /* expert mode (4 params set manually) */
   zfp_mode_fixed_rate      = 2, /* fixed rate mode */
   zfp_mode_fixed_precision = 3, /* fixed precision mode */
-  zfp_mode_fixed_accuracy  = 4  /* fixed accuracy mode */
+  zfp_mode_fixed_accuracy  = 4, /* fixed accuracy mode */
+  zfp_mode_reversible      = 5  /* reversible (lossless) mode */
 } zfp_mode;
 
 /* scalar type */
@@ -173,6 +235,28 @@ typedef struct {
   void* data;          /* pointer to array data */
 } zfp_field;
 
+/* sink of compressed data; returns number of bytes consumed */
+typedef size_t (*zfp_write_func)(
+  void* user,       /* user data */
+  const void* data, /* compressed data */
+  size_t size       /* number of bytes */
+);
+
+/* source of compressed data; returns number of bytes read (zero at end) */
+typedef size_t (*zfp_read_func)(
+  void* user,       /* user data */
+  void* data,       /* buffer to fill */
+  size_t size       /* maximum number of bytes */
+);
+
+/* streaming compressor and decompressor (opaque) */
+typedef struct zfp_slab_writer zfp_slab_writer;
+typedef struct zfp_slab_reader zfp_slab_reader;
+
+/* writer and reader of chunked frames (opaque) */
+typedef struct zfp_frame_writer zfp_frame_writer;
+typedef struct zfp_frame_reader zfp_frame_reader;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -234,13 +318,19 @@ zfp_stream_params(
   int* minexp               /* minimum base-2 exponent; error <= 2^minexp */
 );
 
+/* is a chunk offset index embedded ahead of the compressed blocks? */
+int                        /* index layout (ZFP_INDEX_NONE if disabled) */
+zfp_stream_index(
+  const zfp_stream* stream /* compressed stream */
+);
+
 /* byte size of sequentially compressed stream (call after compression) */
 size_t                     /* actual number of bytes of compressed storage */
 zfp_stream_compressed_size(
   const zfp_stream* stream /* compressed stream */
 );
 
-/* conservative estimate of compressed size in bytes */
+/* conservative estimate of compressed size in bytes (set policy first) */
 size_t                      /* maximum number of bytes of compressed storage */
 zfp_stream_maximum_size(
   const zfp_stream* stream, /* compressed stream */
@@ -280,6 +370,12 @@ zfp_stream_set_accuracy(
   double tolerance    /* desired error tolerance */
 );
 
+/* set reversible (lossless) compression mode */
+void
+zfp_stream_set_reversible(
+  zfp_stream* stream /* compressed stream */
+);
+
 /* set all compression parameters from compact representation */
 /* compression params are only set on stream upon success */
 zfp_mode              /* non (zfp_mode_null) upon success */
@@ -298,6 +394,31 @@ zfp_stream_set_params(
   int minexp          /* minimum base-2 exponent; error <= 2^minexp */
 );
 
+/*
+Enable or disable embedding of a chunk offset index.  When enabled,
+zfp_compress writes, at the current stream position (e.g. right after the
+header), the number of independently compressed chunks followed by the bit
+offset of each chunk but the first relative to the end of the index, each
+stored as a ZFP_INDEX_BITS-bit integer.  The index allows variable-rate
+(fixed-precision, fixed-accuracy, and expert mode) streams to be decompressed
+in parallel.  Serial compression emits a single chunk.  Reader and writer
+must agree on whether the index is present and on its layout.
+
+With ZFP_INDEX_PACKED (or any other nonzero value), chunks are concatenated
+without gaps.  With ZFP_INDEX_ALIGNED, the first chunk begins on the stream
+word boundary following the index, each chunk is zero-padded to a whole
+number of words, and offsets are relative to the first chunk.  Aligned
+chunks are moved rather than bit-shifted into place by parallel compressors,
+which compress directly into the output buffer when it holds at least
+zfp_stream_maximum_size bytes.  The slab reader supports only single-chunk
+aligned streams.
+*/
+int                   /* nonzero upon success */
+zfp_stream_set_index(
+  zfp_stream* stream, /* compressed stream */
+  int layout          /* ZFP_INDEX_NONE, ZFP_INDEX_PACKED, or ZFP_INDEX_ALIGNED */
+);
+
 /* high-level API: execution policy ---------------------------------------- */
 
 /* current execution policy */
@@ -312,7 +433,7 @@ zfp_stream_omp_threads(
   const zfp_stream* stream /* compressed stream */
 );
 
-/* number of blocks per OpenMP chunk (1D only) */
+/* number of blocks per OpenMP chunk */
 uint                       /* number of blocks per chunk (0 for default) */
 zfp_stream_omp_chunk_size(
   const zfp_stream* stream /* compressed stream */
@@ -332,13 +453,125 @@ zfp_stream_set_omp_threads(
   uint threads        /* number of OpenMP threads to use (0 for default) */
 );
 
-/* set OpenMP execution policy and number of blocks per chunk (1D only) */
+/*
+Set OpenMP execution policy and number of blocks per chunk.  Chunks are
+assigned dynamically to threads as they become idle.  By default, fixed-rate
+streams use one chunk per thread, while variable-rate streams, whose blocks
+vary in cost, use eight chunks per thread.
+*/
 int                   /* nonzero upon success */
 zfp_stream_set_omp_chunk_size(
   zfp_stream* stream, /* compressed stream */
   uint chunk_size     /* number of blocks per chunk (0 for default) */
 );
 
+/*
+Set OpenMP execution policy and request per-thread timings.  Each OpenMP
+(de)compression call stores in seconds[i] the time thread i spent
+processing chunks, which exposes load imbalance.  The array must have room
+for one entry per thread (see zfp_stream_set_omp_threads).  Pass null to
+disable timing.
+*/
+int                   /* nonzero upon success */
+zfp_stream_set_omp_timings(
+  zfp_stream* stream, /* compressed stream */
+  double* seconds     /* per-thread busy time in seconds (or null) */
+);
+
+/* per-thread busy times of last OpenMP (de)compression call */
+const double*              /* array passed to zfp_stream_set_omp_timings */
+zfp_stream_omp_timings(
+  const zfp_stream* stream /* compressed stream */
+);
+
+/* number of threads to use with thread pool execution */
+uint                       /* number of threads (0 for default) */
+zfp_stream_thread_count(
+  const zfp_stream* stream /* compressed stream */
+);
+
+/* number of blocks per chunk with thread pool execution */
+uint                       /* number of blocks per chunk (0 for default) */
+zfp_stream_thread_chunk_size(
+  const zfp_stream* stream /* compressed stream */
+);
+
+/* set thread pool execution policy and number of threads */
+int                   /* nonzero upon success */
+zfp_stream_set_thread_count(
+  zfp_stream* stream, /* compressed stream */
+  uint threads        /* number of threads to use (0 for default) */
+);
+
+/* set thread pool execution policy and number of blocks per chunk */
+int                   /* nonzero upon success */
+zfp_stream_set_thread_chunk_size(
+  zfp_stream* stream, /* compressed stream */
+  uint chunk_size     /* number of blocks per chunk (0 for default) */
+);
+
+/*
+Set thread pool execution policy with tasks run via the given function
+instead of zfp's persistent internal pool of threads.  Chunks of blocks
+are processed by the calling thread and by up to threads - 1 submitted
+tasks, each claiming the next unprocessed chunk until none remain, so
+zfp_compress and zfp_decompress return once all chunks are done even if
+some tasks have not yet started.  A null function selects the internal
+pool.
+*/
+int                       /* nonzero upon success */
+zfp_stream_set_thread_submit(
+  zfp_stream* stream,     /* compressed stream */
+  zfp_submit_func submit, /* task submission function (or null) */
+  void* user              /* user data passed to submit */
+);
+
+/* high-level API: codec kernel -------------------------------------------- */
+
+/*
+When built with ZFP_WITH_KERNELS, the block transform and embedded coder
+are compiled once per supported instruction set, and zfp_stream_open
+selects the fastest kernel the processor supports.  All kernels produce
+identical compressed streams.  The kernel applies to every (de)compression
+call with the stream, including the low-level block encoder and decoder.
+*/
+
+/* codec kernel used by stream */
+zfp_kernel                 /* codec kernel variant */
+zfp_stream_kernel(
+  const zfp_stream* stream /* compressed stream */
+);
+
+/* force codec kernel, e.g. to compare kernels */
+int                   /* nonzero upon success */
+zfp_stream_set_kernel(
+  zfp_stream* stream, /* compressed stream */
+  zfp_kernel kernel   /* kernel that build and processor must support */
+);
+
+/* high-level API: encoder statistics -------------------------------------- */
+
+/*
+When built with ZFP_WITH_PROFILE, blocks encoded with a stream that has
+statistics attached add to them.  Parallel compression gathers statistics
+per chunk of blocks and merges them once the chunk is done.  Statistics
+are never cleared by zfp.  Without ZFP_WITH_PROFILE, the encoder gathers
+nothing and costs nothing.
+*/
+
+/* statistics attached to stream */
+zfp_stats*                 /* encoder statistics (or null) */
+zfp_stream_stats(
+  const zfp_stream* stream /* compressed stream */
+);
+
+/* attach statistics to stream */
+int                   /* nonzero upon success */
+zfp_stream_set_stats(
+  zfp_stream* stream, /* compressed stream */
+  zfp_stats* stats    /* zero-initialized statistics (or null to detach) */
+);
+
 /* high-level API: uncompressed array construction/destruction ------------- */
 
 /* allocate field struct */
@@ -542,6 +775,56 @@ zfp_decompress(
   zfp_field* field    /* field metadata */
 );
 
+/*
+Decompress only the blocks of a 1D, 2D, or 3D field that intersect the box
+[x0, x0 + nx) x [y0, y0 + ny) x [z0, z0 + nz), which must lie within the
+field.  The field gives the scalar type and dimensions of the entire
+compressed field; its pointer and strides (by default contiguous with
+dimensions nx * ny * nz) describe where to store the box.  Starting at the
+first block (or chunk index), blocks are located directly in fixed-rate
+mode; in variable-rate mode, the blocks preceding each needed block in its
+chunk are decoded and discarded, so an index with many chunks speeds up
+access.  Coordinates beyond the field dimensionality are ignored.
+*/
+size_t                /* bytes of compressed storage read (zero upon failure) */
+zfp_decompress_region(
+  zfp_stream* stream, /* compressed stream */
+  zfp_field* field,   /* field metadata; data and strides describe box */
+  uint x0,            /* box origin */
+  uint y0,
+  uint z0,
+  uint nx,            /* box dimensions */
+  uint ny,
+  uint nz
+);
+
+/*
+Compress field in fixed-rate mode using a progressive layout, which begins
+on a word boundary.  The embedded encoding of each block is cut into slices
+of one stream word, and the field is stored one layer of slices at a time
+(the first slice of every block, then the second, and so on), so that any
+prefix of the stream holds the most significant bits of all blocks.
+*/
+size_t                    /* cumulative number of bytes of compressed storage */
+zfp_compress_progressive(
+  zfp_stream* stream,     /* compressed stream */
+  const zfp_field* field  /* field metadata */
+);
+
+/*
+Decompress field stored in progressive layout using only its first bytes
+of compressed data (e.g. a partially received stream).  Each block is
+reconstructed from all of its bits within this budget, which yields the
+same result as fixed-rate compression at the corresponding lower rate when
+the budget is a whole number of layers.
+*/
+size_t                /* cumulative number of bytes of compressed storage */
+zfp_decompress_progressive(
+  zfp_stream* stream, /* compressed stream */
+  zfp_field* field,   /* field metadata */
+  size_t bytes        /* maximum number of compressed bytes to read */
+);
+
 /* write compression parameters and field metadata (optional) */
 size_t                    /* number of bits written or zero upon failure */
 zfp_write_header(
@@ -558,6 +841,170 @@ zfp_read_header(
   uint mask           /* information to read */
 );
 
+/* high-level API: streaming compression ---------------------------------- */
+
+/*
+Open streaming compressor of field, whose data pointer is ignored.  The
+field is compressed serially one slab of four layers at a time along its
+slowest varying dimension (values in 1D, rows in 2D, planes in 3D, volumes
+in 4D), and completed words of compressed data are passed to the write
+callback as soon as they become available.  Only the compression parameters
+and index setting of the given stream are used, and the header elements in
+mask are emitted first.  Memory use is bounded by one compressed slab.  The
+concatenated output is identical to that of zfp_write_header followed by
+serial zfp_compress.
+*/
+zfp_slab_writer*          /* streaming compressor or NULL upon failure */
+zfp_slab_writer_open(
+  zfp_stream* stream,     /* compression parameters */
+  const zfp_field* field, /* field metadata */
+  uint mask,              /* information to write in header */
+  zfp_write_func write,   /* sink of compressed data */
+  void* user              /* user data passed to sink */
+);
+
+/*
+Compress next slab of four layers (fewer for the last slab).  The slab is
+laid out like the field, i.e. using the field strides when nonzero.
+*/
+int                        /* nonzero upon success */
+zfp_slab_writer_append(
+  zfp_slab_writer* writer, /* streaming compressor */
+  const void* data         /* pointer to first value in slab */
+);
+
+/* write final word, if all slabs were appended, and close compressor */
+size_t                     /* total bytes of compressed storage (zero upon failure) */
+zfp_slab_writer_close(
+  zfp_slab_writer* writer  /* streaming compressor */
+);
+
+/* high-level API: streaming decompression -------------------------------- */
+
+/*
+Open streaming decompressor, which reads compressed data incrementally
+from the read callback and reconstructs the field serially one slab of four
+layers at a time (see zfp_slab_writer_open).  The header elements in mask
+are read first and, when present, update the field metadata and compression
+parameters of the given stream; otherwise these must be set by the caller.
+The field strides, when nonzero, describe the layout of each slab.  Memory
+use is bounded by one compressed slab, though the source may be read up to
+one compressed slab beyond the end of the compressed stream.
+*/
+zfp_slab_reader*          /* streaming decompressor or NULL upon failure */
+zfp_slab_reader_open(
+  zfp_stream* stream,     /* compression parameters */
+  zfp_field* field,       /* field metadata */
+  uint mask,              /* information to read from header */
+  zfp_read_func read,     /* source of compressed data */
+  void* user              /* user data passed to source */
+);
+
+/* decompress next slab of four layers (fewer for the last slab) */
+uint                       /* number of layers decompressed (zero at end) */
+zfp_slab_reader_read(
+  zfp_slab_reader* reader, /* streaming decompressor */
+  void* data               /* pointer to first value in slab */
+);
+
+/* close decompressor */
+size_t                     /* total bytes of compressed storage consumed */
+zfp_slab_reader_close(
+  zfp_slab_reader* reader  /* streaming decompressor */
+);
+
+/* high-level API: chunked frames ----------------------------------------- */
+
+/*
+A frame is a sequence of independently decodable chunks followed by a
+trailer, all aligned on stream word boundaries.  Each chunk holds a full
+header (magic, field metadata, and compression mode) zero-padded to
+ZFP_HEADER_MAX_BITS rounded up to a whole word, a 64-bit size in bytes of
+the compressed data, 32-bit chunk flags (checksum and chunk index layout),
+a 32-bit checksum (or zero), and the compressed data.  The trailer holds
+the 64-bit byte offset of each chunk relative to the start of the frame,
+the number of chunks, and a 64-bit tag.  Each chunk occupies at most
+zfp_stream_maximum_size + 32 bytes and the trailer 8 * (chunks + 2) bytes.
+*/
+
+/*
+Open writer of frame that begins at the current (word aligned) write
+position of the stream.  If bytes is nonzero, the stream already holds a
+frame of that size there, whose chunks are retained and whose trailer is
+overwritten by subsequently appended chunks.
+*/
+zfp_frame_writer*     /* frame writer or NULL upon failure */
+zfp_frame_writer_open(
+  zfp_stream* stream, /* compressed stream */
+  size_t bytes        /* size of existing frame (zero for new frame) */
+);
+
+/*
+Compress field as one chunk using the current compression parameters,
+index setting, and execution policy of the stream, which may change
+between chunks.
+*/
+size_t                     /* bytes of compressed chunk (zero upon failure) */
+zfp_frame_writer_append(
+  zfp_frame_writer* writer, /* frame writer */
+  const zfp_field* field,   /* field to compress */
+  uint flags                /* chunk options (e.g. ZFP_FRAME_CHECKSUM) */
+);
+
+/* write trailer, close writer, and position stream past frame */
+size_t                     /* total bytes of frame */
+zfp_frame_writer_close(
+  zfp_frame_writer* writer /* frame writer */
+);
+
+/*
+Open reader of frame of given size that begins at the current (word
+aligned) read position of the stream, and position stream past frame.
+Chunks are located via the trailer.  If the trailer is missing or
+damaged, e.g. due to truncation, chunks are instead located by walking the
+chunk headers from the start of the frame, keeping the complete chunks
+whose headers and checksums are valid.  Only the execution policy of the
+stream is used.
+*/
+zfp_frame_reader*     /* frame reader or NULL upon failure */
+zfp_frame_reader_open(
+  zfp_stream* stream, /* compressed stream */
+  size_t bytes        /* size of frame */
+);
+
+/* number of chunks in frame */
+uint                             /* number of chunks */
+zfp_frame_reader_chunks(
+  const zfp_frame_reader* reader /* frame reader */
+);
+
+/* set scalar type and dimensions of field to those of chunk */
+int                               /* nonzero upon success */
+zfp_frame_reader_field(
+  const zfp_frame_reader* reader, /* frame reader */
+  uint chunk,                     /* chunk index */
+  zfp_field* field                /* field metadata */
+);
+
+/*
+Decompress chunk into field, whose type and dimensions must match those of
+the chunk, after verifying its checksum, if any.  Distinct chunks may be
+decompressed concurrently.  Variable-rate chunks without an index are
+decompressed serially.
+*/
+size_t                            /* bytes of compressed chunk (zero upon failure) */
+zfp_frame_reader_decompress(
+  const zfp_frame_reader* reader, /* frame reader */
+  uint chunk,                     /* chunk index */
+  zfp_field* field                /* field to decompress */
+);
+
+/* close frame reader */
+void
+zfp_frame_reader_close(
+  zfp_frame_reader* reader /* frame reader */
+);
+
 /* low-level API: stream manipulation -------------------------------------- */
 
 /* flush bit stream--must be called after last encode call or between seeks */
@@ -587,7 +1034,12 @@ array.  In the latter case, p points to the first scalar; (nx, ny, nz) specify
 the size of the block, with 1 <= nx, ny, nz <= 4; and (sx, sy, sz) specify the
 strides, i.e. the number of scalars to advance to get to the next scalar along
 each dimension.  The functions return the number of bits of compressed storage
-needed for the compressed block.
+needed for the compressed block.  The zfp_encode_blocks functions compress
+count consecutive contiguous blocks, e.g. as produced by an application that
+stores its data in blocked order, and return the total number of bits.  They
+transform batches of blocks and extract the bit planes of up to 64 values
+(16 1D, 4 2D, or one 3D block) at once, and produce the same stream as the
+single-block functions.
 */
 
 /* encode 1D contiguous block of 4 values */
@@ -596,6 +1048,12 @@ uint zfp_encode_block_int64_1(zfp_stream* stream, const int64* block);
 uint zfp_encode_block_float_1(zfp_stream* stream, const float* block);
 uint zfp_encode_block_double_1(zfp_stream* stream, const double* block);
 
+/* encode 1D sequence of count contiguous blocks of 4 values */
+size_t zfp_encode_blocks_int32_1(zfp_stream* stream, const int32* blocks, uint count);
+size_t zfp_encode_blocks_int64_1(zfp_stream* stream, const int64* blocks, uint count);
+size_t zfp_encode_blocks_float_1(zfp_stream* stream, const float* blocks, uint count);
+size_t zfp_encode_blocks_double_1(zfp_stream* stream, const double* blocks, uint count);
+
 /* encode 1D complete or partial block from strided array */
 uint zfp_encode_block_strided_int32_1(zfp_stream* stream, const int32* p, int sx);
 uint zfp_encode_block_strided_int64_1(zfp_stream* stream, const int64* p, int sx);
@@ -612,6 +1070,12 @@ uint zfp_encode_block_int64_2(zfp_stream* stream, const int64* block);
 uint zfp_encode_block_float_2(zfp_stream* stream, const float* block);
 uint zfp_encode_block_double_2(zfp_stream* stream, const double* block);
 
+/* encode 2D sequence of count contiguous blocks of 4x4 values */
+size_t zfp_encode_blocks_int32_2(zfp_stream* stream, const int32* blocks, uint count);
+size_t zfp_encode_blocks_int64_2(zfp_stream* stream, const int64* blocks, uint count);
+size_t zfp_encode_blocks_float_2(zfp_stream* stream, const float* blocks, uint count);
+size_t zfp_encode_blocks_double_2(zfp_stream* stream, const double* blocks, uint count);
+
 /* encode 2D complete or partial block from strided array */
 uint zfp_encode_partial_block_strided_int32_2(zfp_stream* stream, const int32* p, uint nx, uint ny, int sx, int sy);
 uint zfp_encode_partial_block_strided_int64_2(zfp_stream* stream, const int64* p, uint nx, uint ny, int sx, int sy);
@@ -628,6 +1092,12 @@ uint zfp_encode_block_int64_3(zfp_stream* stream, const int64* block);
 uint zfp_encode_block_float_3(zfp_stream* stream, const float* block);
 uint zfp_encode_block_double_3(zfp_stream* stream, const double* block);
 
+/* encode 3D sequence of count contiguous blocks of 4x4x4 values */
+size_t zfp_encode_blocks_int32_3(zfp_stream* stream, const int32* blocks, uint count);
+size_t zfp_encode_blocks_int64_3(zfp_stream* stream, const int64* blocks, uint count);
+size_t zfp_encode_blocks_float_3(zfp_stream* stream, const float* blocks, uint count);
+size_t zfp_encode_blocks_double_3(zfp_stream* stream, const double* blocks, uint count);
+
 /* encode 3D complete or partial block from strided array */
 uint zfp_encode_block_strided_int32_3(zfp_stream* stream, const int32* p, int sx, int sy, int sz);
 uint zfp_encode_block_strided_int64_3(zfp_stream* stream, const int64* p, int sx, int sy, int sz);
@@ -644,6 +1114,12 @@ uint zfp_encode_block_int64_4(zfp_stream* stream, const int64* block);
 uint zfp_encode_block_float_4(zfp_stream* stream, const float* block);
 uint zfp_encode_block_double_4(zfp_stream* stream, const double* block);
 
+/* encode 4D sequence of count contiguous blocks of 4x4x4x4 values */
+size_t zfp_encode_blocks_int32_4(zfp_stream* stream, const int32* blocks, uint count);
+size_t zfp_encode_blocks_int64_4(zfp_stream* stream, const int64* blocks, uint count);
+size_t zfp_encode_blocks_float_4(zfp_stream* stream, const float* blocks, uint count);
+size_t zfp_encode_blocks_double_4(zfp_stream* stream, const double* blocks, uint count);
+
 /* encode 4D complete or partial block from strided array */
 uint zfp_encode_block_strided_int32_4(zfp_stream* stream, const int32* p, int sx, int sy, int sz, int sw);
 uint zfp_encode_block_strided_int64_4(zfp_stream* stream, const int64* p, int sx, int sy, int sz, int sw);
@@ -658,7 +1134,8 @@ uint zfp_encode_partial_block_strided_double_4(zfp_stream* stream, const double*
 
 /*
 Each function below decompresses a single block and returns the number of bits
-of compressed storage consumed.  See corresponding encoder functions above for
+of compressed storage consumed.  The zfp_decode_blocks functions decompress
+count consecutive blocks.  See corresponding encoder functions above for
 further details.
 */
 
@@ -668,6 +1145,12 @@ uint zfp_decode_block_int64_1(zfp_stream* stream, int64* block);
 uint zfp_decode_block_float_1(zfp_stream* stream, float* block);
 uint zfp_decode_block_double_1(zfp_stream* stream, double* block);
 
+/* decode 1D sequence of count contiguous blocks of 4 values */
+size_t zfp_decode_blocks_int32_1(zfp_stream* stream, int32* blocks, uint count);
+size_t zfp_decode_blocks_int64_1(zfp_stream* stream, int64* blocks, uint count);
+size_t zfp_decode_blocks_float_1(zfp_stream* stream, float* blocks, uint count);
+size_t zfp_decode_blocks_double_1(zfp_stream* stream, double* blocks, uint count);
+
 /* decode 1D complete or partial block from strided array */
 uint zfp_decode_block_strided_int32_1(zfp_stream* stream, int32* p, int sx);
 uint zfp_decode_block_strided_int64_1(zfp_stream* stream, int64* p, int sx);
@@ -684,6 +1167,12 @@ uint zfp_decode_block_int64_2(zfp_stream* stream, int64* block);
 uint zfp_decode_block_float_2(zfp_stream* stream, float* block);
 uint zfp_decode_block_double_2(zfp_stream* stream, double* block);
 
+/* decode 2D sequence of count contiguous blocks of 4x4 values */
+size_t zfp_decode_blocks_int32_2(zfp_stream* stream, int32* blocks, uint count);
+size_t zfp_decode_blocks_int64_2(zfp_stream* stream, int64* blocks, uint count);
+size_t zfp_decode_blocks_float_2(zfp_stream* stream, float* blocks, uint count);
+size_t zfp_decode_blocks_double_2(zfp_stream* stream, double* blocks, uint count);
+
 /* decode 2D complete or partial block from strided array */
 uint zfp_decode_block_strided_int32_2(zfp_stream* stream, int32* p, int sx, int sy);
 uint zfp_decode_block_strided_int64_2(zfp_stream* stream, int64* p, int sx, int sy);
@@ -700,6 +1189,12 @@ uint zfp_decode_block_int64_3(zfp_stream* stream, int64* block);
 uint zfp_decode_block_float_3(zfp_stream* stream, float* block);
 uint zfp_decode_block_double_3(zfp_stream* stream, double* block);
 
+/* decode 3D sequence of count contiguous blocks of 4x4x4 values */
+size_t zfp_decode_blocks_int32_3(zfp_stream* stream, int32* blocks, uint count);
+size_t zfp_decode_blocks_int64_3(zfp_stream* stream, int64* blocks, uint count);
+size_t zfp_decode_blocks_float_3(zfp_stream* stream, float* blocks, uint count);
+size_t zfp_decode_blocks_double_3(zfp_stream* stream, double* blocks, uint count);
+
 /* decode 3D complete or partial block from strided array */
 uint zfp_decode_block_strided_int32_3(zfp_stream* stream, int32* p, int sx, int sy, int sz);
 uint zfp_decode_block_strided_int64_3(zfp_stream* stream, int64* p, int sx, int sy, int sz);
@@ -716,6 +1211,12 @@ uint zfp_decode_block_int64_4(zfp_stream* stream, int64* block);
 uint zfp_decode_block_float_4(zfp_stream* stream, float* block);
 uint zfp_decode_block_double_4(zfp_stream* stream, double* block);
 
+/* decode 4D sequence of count contiguous blocks of 4x4x4x4 values */
+size_t zfp_decode_blocks_int32_4(zfp_stream* stream, int32* blocks, uint count);
+size_t zfp_decode_blocks_int64_4(zfp_stream* stream, int64* blocks, uint count);
+size_t zfp_decode_blocks_float_4(zfp_stream* stream, float* blocks, uint count);
+size_t zfp_decode_blocks_double_4(zfp_stream* stream, double* blocks, uint count);
+
 /* decode 4D complete or partial block from strided array */
 uint zfp_decode_block_strided_int32_4(zfp_stream* stream, int32* p, int sx, int sy, int sz, int sw);
 uint zfp_decode_block_strided_int64_4(zfp_stream* stream, int64* p, int sx, int sy, int sz, int sw);
@@ -29,8 +29,9 @@ The following assumptions and restrictions apply:
      size_t stream_align(stream);
      uint stream_read_bit(stream);
      uint64 stream_read_bits(stream, n);
+     uint stream_skip_zeros(stream, n);
 
-   Each of the above read calls has a corresponding write call:
+   Except for stream_skip_zeros, each of the above read calls has a corresponding write call:
 
      size_t stream_size(stream);
      size_t stream_wtell(stream);
@@ -157,6 +158,25 @@ stream_write_word(bitstream* s, word value)
 #endif
 }
 
+/* count trailing zeros of nonzero word */
+static uint
+stream_ctz_word(word x)
+{
+#ifdef __GNUC__
+  return (uint)__builtin_ctzll(x);
+#else
+  /* de Bruijn sequence lookup of isolated least significant one-bit */
+  static const uchar table[64] = {
+     0,  1, 48,  2, 57, 49, 28,  3, 61, 58, 50, 42, 38, 29, 17,  4,
+    62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12,  5,
+    63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+    46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19,  9, 13,  8,  7,  6,
+  };
+  uint64 y = x;
+  return table[((y & (0 - y)) * UINT64C(0x03f79d71b4cb0a89)) >> 58];
+#endif
+}
+
 /* public functions -------------------------------------------------------- */
 
 /* pointer to beginning of stream */
@@ -265,6 +285,40 @@ stream_read_bits(bitstream* s, uint n)
   return value;
 }
 
+/* skip at most n zero-bits and the one-bit ending the run; return zero count */
+inline_ uint
+stream_skip_zeros(bitstream* s, uint n)
+{
+  uint z = 0;
+  while (z < n) {
+    uint c;
+    if (!s->bits) {
+      s->buffer = stream_read_word(s);
+      s->bits = wsize;
+    }
+    if (!s->buffer) {
+      /* all buffered bits are zero */
+      c = s->bits < n - z ? s->bits : n - z;
+      s->bits -= c;
+    }
+    else {
+      c = stream_ctz_word(s->buffer);
+      if (c < n - z) {
+        /* consume run of zeros and terminating one-bit */
+        s->bits -= c + 1;
+        s->buffer >>= c;
+        s->buffer >>= 1;
+        return z + c;
+      }
+      c = n - z;
+      s->bits -= c;
+      s->buffer >>= c;
+    }
+    z += c;
+  }
+  return z;
+}
+
 /* write 0 <= n <= 64 low bits of value and return remaining bits */
 inline_ uint64
 stream_write_bits(bitstream* s, uint64 value, uint n)
@@ -17,9 +17,37 @@ static uint
 chunk_count_omp(const zfp_stream* stream, uint blocks, uint threads)
 {
   uint chunk_size = stream->exec.params.omp.chunk_size;
-  /* if no chunk size is specified, assign one chunk per thread */
-  uint chunks = chunk_size ? (blocks + chunk_size - 1) / chunk_size : threads;
+  /* if no chunk size is specified, assign one chunk per thread in fixed-rate
+     mode and several smaller chunks per thread to balance variable rates */
+  uint chunks = chunk_size ? (blocks + chunk_size - 1) / chunk_size : stream->minbits == stream->maxbits ? threads : 8 * threads;
   return MIN(chunks, blocks);
 }
 
+/* clear per-thread timings, if requested */
+static void
+timer_reset_omp(const zfp_stream* stream, uint threads)
+{
+  double* seconds = stream->timings;
+  uint i;
+  if (seconds)
+    for (i = 0; i < threads; i++)
+      seconds[i] = 0;
+}
+
+/* start timing work by calling thread */
+static double
+timer_start_omp(const zfp_stream* stream)
+{
+  return stream->timings ? omp_get_wtime() : 0;
+}
+
+/* add time since start to calling thread's total */
+static void
+timer_stop_omp(const zfp_stream* stream, double start)
+{
+  double* seconds = stream->timings;
+  if (seconds)
+    seconds[omp_get_thread_num()] += omp_get_wtime() - start;
+}
+
 #endif
@@ -1,5 +1,3 @@
-#ifdef _OPENMP
-
 /* block index at which chunk begins */
 static uint
 chunk_offset(uint blocks, uint chunks, uint chunk)
@@ -7,80 +5,266 @@ chunk_offset(uint blocks, uint chunks, uint chunk)
   return (uint)((blocks * (uint64)chunk) / chunks);
 }
 
-/* initialize per-thread bit streams for parallel compression */
-static bitstream**
-compress_init_par(zfp_stream* stream, const zfp_field* field, uint chunks, uint blocks)
+/* index of chunk that contains block */
+static uint
+chunk_index(uint blocks, uint chunks, uint block)
 {
-  bitstream** bs;
-  size_t size;
-  int copy = 0;
-  uint i;
+  return (uint)(((block + 1) * (uint64)chunks - 1) / blocks);
+}
 
-  /* determine maximum size buffer needed per thread */
-  zfp_field f = *field;
+/* number of blocks in field */
+static uint
+field_blocks(const zfp_field* field)
+{
+  uint blocks = 1;
   switch (zfp_field_dimensionality(field)) {
-    case 1:
-      f.nx = 4 * (blocks + chunks - 1) / chunks;
-      break;
+    case 4:
+      blocks *= (field->nw + 3) / 4;
+      /* FALLTHROUGH */
+    case 3:
+      blocks *= (field->nz + 3) / 4;
+      /* FALLTHROUGH */
     case 2:
-      f.nx = 4;
-      f.ny = 4 * (blocks + chunks - 1) / chunks;
+      blocks *= (field->ny + 3) / 4;
+      /* FALLTHROUGH */
+    case 1:
+      blocks *= (field->nx + 3) / 4;
       break;
-    case 3:
-      f.nx = 4;
-      f.ny = 4;
-      f.nz = 4 * (blocks + chunks - 1) / chunks;
+  }
+  return blocks;
+}
+
+#if defined(_OPENMP) || defined(ZFP_WITH_THREADS)
+
+/* determine bit offsets at which to compress chunks directly into stream */
+static int
+chunk_place_par(const zfp_stream* stream, const zfp_field* field, uint chunks, uint blocks, size_t* place)
+{
+  bitstream* dst = stream->stream;
+  uint bits = block_maximum_bits(stream, zfp_field_dimensionality(field), field->type);
+  size_t base = stream_wtell(dst);
+  size_t pad = 0;
+  uint i;
+
+  switch (stream->index) {
+    case ZFP_INDEX_NONE:
+      /* in fixed-rate mode, chunks are contiguous when word aligned */
+      if (stream->minbits != stream->maxbits || bits % stream_word_bits || base % stream_word_bits)
+        return 0;
       break;
-    case 4:
-      f.nx = 4;
-      f.ny = 4;
-      f.nz = 4;
-      f.nw = 4 * (blocks + chunks - 1) / chunks;
+    case ZFP_INDEX_ALIGNED:
+      /* reserve worst-case space for each chunk following index */
+      base = align_offset(base + (size_t)chunks * ZFP_INDEX_BITS);
+      pad = bits % stream_word_bits ? stream_word_bits : 0;
       break;
     default:
+      /* chunk index must precede chunks, whose sizes are not yet known */
       return 0;
   }
-  size = zfp_stream_maximum_size(stream, &f);
+  for (i = 0; i <= chunks; i++)
+    place[i] = base + (size_t)chunk_offset(blocks, chunks, i) * bits / stream_word_bits * stream_word_bits + i * pad;
 
-  /* avoid copies in fixed-rate mode when each bitstream is word aligned */
-  copy |= stream->minbits != stream->maxbits;
-  copy |= (stream->maxbits % stream_word_bits) != 0;
-  copy |= (stream_wtell(stream->stream) % stream_word_bits) != 0;
+  /* compress in place only if stream buffer is large enough */
+  return place[chunks] <= CHAR_BIT * stream_capacity(dst);
+}
+
+/* initialize per-thread bit streams for parallel compression */
+static bitstream**
+compress_init_par(zfp_stream* stream, const zfp_field* field, uint chunks, uint blocks)
+{
+  bitstream** bs;
+  size_t* place = (size_t*)malloc((chunks + 1) * sizeof(size_t));
+  size_t size = 0;
+  int copy = !chunk_place_par(stream, field, chunks, blocks, place);
+  uint i;
+
+  /* determine maximum size buffer needed per thread */
+  if (copy) {
+    zfp_field f = *field;
+    switch (zfp_field_dimensionality(field)) {
+      case 1:
+        f.nx = 4 * (blocks + chunks - 1) / chunks;
+        break;
+      case 2:
+        f.nx = 4;
+        f.ny = 4 * (blocks + chunks - 1) / chunks;
+        break;
+      case 3:
+        f.nx = 4;
+        f.ny = 4;
+        f.nz = 4 * (blocks + chunks - 1) / chunks;
+        break;
+      case 4:
+        f.nx = 4;
+        f.ny = 4;
+        f.nz = 4;
+        f.nw = 4 * (blocks + chunks - 1) / chunks;
+        break;
+      default:
+        free(place);
+        return 0;
+    }
+    size = zfp_stream_maximum_size(stream, &f);
+  }
 
   /* set up buffer for each thread to compress to */
   bs = (bitstream**)malloc(chunks * sizeof(bitstream*));
   for (i = 0; i < chunks; i++) {
-    uint block = chunk_offset(blocks, chunks, i);
-    void* buffer = copy ? malloc(size) : (uchar*)stream_data(stream->stream) + stream_size(stream->stream) + block * stream->maxbits / CHAR_BIT;
-    bs[i] = stream_open(buffer, size);
+    if (copy)
+      bs[i] = stream_open(malloc(size), size);
+    else
+      bs[i] = stream_open((uchar*)stream_data(stream->stream) + place[i] / CHAR_BIT, (place[i + 1] - place[i]) / CHAR_BIT);
   }
+  free(place);
 
   return bs;
 }
 
+/* copy bits [begin, end) of concatenated stream from chunk stored at offset */
+static void
+copy_chunk_par(bitstream* dst, bitstream* src, size_t offset, size_t begin, size_t end)
+{
+  stream_wseek(dst, begin);
+  stream_rseek(src, begin - offset);
+  stream_copy(dst, src, end - begin);
+  stream_flush(dst);
+}
+
 /* flush and concatenate bit streams if needed */
 static void
-compress_finish_par(zfp_stream* stream, bitstream** src, uint chunks)
+compress_finish_par(zfp_stream* stream, const zfp_field* field, bitstream** src, uint chunks, uint blocks)
 {
   bitstream* dst = zfp_stream_bit_stream(stream);
-  int copy = (stream_data(dst) != stream_data(*src));
-  size_t offset = stream_wtell(dst);
+  uchar* data = (uchar*)stream_data(dst);
+  int aligned = (stream->index == ZFP_INDEX_ALIGNED);
+  size_t* offset = (size_t*)malloc((chunks + 1) * sizeof(size_t));
+  size_t* place = (size_t*)malloc((chunks + 1) * sizeof(size_t));
+  int copy = !chunk_place_par(stream, field, chunks, blocks, place);
+  int chunk;
   uint i;
+  /* emit index of chunk offsets relative to first chunk */
+  if (stream->index) {
+    size_t bits = 0;
+    stream_write_bits(dst, chunks, ZFP_INDEX_BITS);
+    for (i = 1; i < chunks; i++) {
+      bits += aligned ? align_offset(stream_wtell(src[i - 1])) : stream_wtell(src[i - 1]);
+      stream_write_bits(dst, bits, ZFP_INDEX_BITS);
+    }
+    /* first aligned chunk begins on word boundary */
+    if (aligned)
+      stream_flush(dst);
+  }
+  /* determine where each chunk begins */
+  offset[0] = stream_wtell(dst);
   for (i = 0; i < chunks; i++) {
-    size_t bits = stream_wtell(src[i]);
-    offset += bits;
+    offset[i + 1] = offset[i] + (aligned ? align_offset(stream_wtell(src[i])) : stream_wtell(src[i]));
     stream_flush(src[i]);
-    /* concatenate streams if they are not already contiguous */
-    if (copy) {
-      stream_rewind(src[i]);
-      stream_copy(dst, src[i], bits);
-      free(stream_data(src[i]));
+  }
+  if (!copy) {
+    /* move chunks compressed in place down over unused space */
+    for (i = 0; i < chunks; i++)
+      if (offset[i] != place[i])
+        memmove(data + offset[i] / CHAR_BIT, data + place[i] / CHAR_BIT, (offset[i + 1] - offset[i]) / CHAR_BIT);
+  }
+  else if (aligned) {
+    /* in parallel, copy whole words of each chunk */
+#ifdef _OPENMP
+    #pragma omp parallel for num_threads(thread_count_omp(stream)) if (stream->exec.policy == zfp_exec_omp)
+#endif
+    for (chunk = 0; chunk < (int)chunks; chunk++)
+      memcpy(data + offset[chunk] / CHAR_BIT, stream_data(src[chunk]), (offset[chunk + 1] - offset[chunk]) / CHAR_BIT);
+  }
+  else {
+    /* make any buffered bits preceding first chunk visible in memory */
+    stream_flush(dst);
+    /* in parallel, copy words that hold bits from only one chunk */
+#ifdef _OPENMP
+    #pragma omp parallel for num_threads(thread_count_omp(stream)) if (stream->exec.policy == zfp_exec_omp)
+#endif
+    for (chunk = 0; chunk < (int)chunks; chunk++) {
+      size_t begin = align_offset(offset[chunk + 0]);
+      size_t end = offset[chunk + 1] / stream_word_bits * stream_word_bits;
+      if (begin < end) {
+        bitstream* s = stream_clone(dst);
+        copy_chunk_par(s, src[chunk], offset[chunk], begin, end);
+        stream_close(s);
+      }
     }
+    /* serially fill in words shared by consecutive chunks */
+    for (i = 0; i < chunks; i++) {
+      size_t begin = align_offset(offset[i + 0]);
+      size_t end = offset[i + 1] / stream_word_bits * stream_word_bits;
+      if (begin < end) {
+        if (offset[i] < begin)
+          copy_chunk_par(dst, src[i], offset[i], offset[i], begin);
+        if (end < offset[i + 1])
+          copy_chunk_par(dst, src[i], offset[i], end, offset[i + 1]);
+      }
+      else if (offset[i] < offset[i + 1])
+        copy_chunk_par(dst, src[i], offset[i], offset[i], offset[i + 1]);
+    }
+  }
+  for (i = 0; i < chunks; i++) {
+    if (copy)
+      free(stream_data(src[i]));
     stream_close(src[i]);
   }
   free(src);
-  if (!copy)
-    stream_wseek(dst, offset);
+  stream_wseek(dst, offset[chunks]);
+  free(place);
+  free(offset);
+}
+
+/* initialize per-thread bit streams for parallel decompression */
+static bitstream**
+decompress_init_par(zfp_stream* stream, uint* chunks, uint blocks)
+{
+  bitstream** bs;
+  size_t base;
+  uint i;
+
+  /* number of chunks recorded in index overrides requested number; it has
+     been validated by zfp_decompress to be in [1, blocks] */
+  if (stream->index) {
+    *chunks = (uint)stream_read_bits(stream->stream, ZFP_INDEX_BITS);
+    base = stream_rtell(stream->stream) + (size_t)(*chunks - 1) * ZFP_INDEX_BITS;
+    /* aligned chunks begin on word boundary following index */
+    if (stream->index == ZFP_INDEX_ALIGNED)
+      base = align_offset(base);
+  }
+  else
+    base = stream_rtell(stream->stream);
+
+  /* seek to first block of each chunk */
+  bs = (bitstream**)malloc(*chunks * sizeof(bitstream*));
+  for (i = 0; i < *chunks; i++) {
+    size_t offset;
+    if (stream->index)
+      /* chunk offsets are stored in index */
+      offset = i ? (size_t)stream_read_bits(stream->stream, ZFP_INDEX_BITS) : 0;
+    else {
+      /* each block occupies exactly maxbits bits in fixed-rate mode */
+      uint block = chunk_offset(blocks, *chunks, i);
+      offset = (size_t)block * stream->maxbits;
+    }
+    bs[i] = stream_clone(stream->stream);
+    stream_rseek(bs[i], base + offset);
+  }
+
+  return bs;
+}
+
+/* deallocate per-thread bit streams and advance past last decoded block */
+static void
+decompress_finish_par(zfp_stream* stream, bitstream** src, uint chunks)
+{
+  bitstream* dst = zfp_stream_bit_stream(stream);
+  size_t offset = stream_rtell(src[chunks - 1]);
+  uint i;
+  for (i = 0; i < chunks; i++)
+    stream_close(src[i]);
+  free(src);
+  stream_rseek(dst, offset);
 }
 
 #endif
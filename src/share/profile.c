@@ -0,0 +1,58 @@
+#ifdef ZFP_WITH_PROFILE
+#ifdef ZFP_WITH_THREADS
+#include <pthread.h>
+
+/* serializes merging of chunk statistics into shared statistics */
+static pthread_mutex_t profile_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/* declare statistics gathered by one chunk of blocks */
+#define PROFILE_CHUNK(stats) zfp_stats stats;
+
+/* add statistics src to dst */
+static void
+profile_add(zfp_stats* dst, const zfp_stats* src)
+{
+  uint i;
+  for (i = 0; i < ZFP_STATS_STAGES; i++)
+    dst->cycles[i] += src->cycles[i];
+  dst->blocks += src->blocks;
+  dst->zero_blocks += src->zero_blocks;
+  dst->planes += src->planes;
+  for (i = 0; i < ZFP_STATS_BINS; i++)
+    dst->histogram[i] += src->histogram[i];
+}
+
+/* redirect statistics of thread-local stream s to chunk statistics */
+static void
+profile_chunk_begin(zfp_stream* s, zfp_stats* stats)
+{
+  if (s->stats) {
+    memset(stats, 0, sizeof(*stats));
+    s->stats = stats;
+  }
+}
+
+/* merge chunk statistics into those of shared stream */
+static void
+profile_chunk_end(const zfp_stream* stream, const zfp_stats* stats)
+{
+  if (stream->stats) {
+#if defined(ZFP_WITH_THREADS)
+    pthread_mutex_lock(&profile_lock);
+    profile_add(stream->stats, stats);
+    pthread_mutex_unlock(&profile_lock);
+#elif defined(_OPENMP)
+    #pragma omp critical(zfp_profile)
+    profile_add(stream->stats, stats);
+#else
+    profile_add(stream->stats, stats);
+#endif
+  }
+}
+
+#else
+#define PROFILE_CHUNK(stats)
+#define profile_chunk_begin(s, stats)
+#define profile_chunk_end(stream, stats)
+#endif
@@ -0,0 +1,281 @@
+#ifdef ZFP_WITH_THREADS
+#include <pthread.h>
+#include <unistd.h>
+
+/* task queued for internal thread pool */
+typedef struct pool_task {
+  void (*run)(void*);     /* function to run */
+  void* data;             /* argument to function */
+  struct pool_task* next; /* next task in queue */
+} pool_task;
+
+/* persistent pool of worker threads shared by all streams */
+static struct {
+  pthread_mutex_t lock; /* protects queue and worker count */
+  pthread_cond_t ready; /* signaled when a task is queued */
+  pool_task* head;      /* first queued task */
+  pool_task* tail;      /* last queued task */
+  uint workers;         /* number of worker threads */
+} pool = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, NULL, NULL, 0 };
+
+/* run queued tasks for the lifetime of the process */
+static void*
+pool_worker(void* arg)
+{
+  (void)arg;
+  for (;;) {
+    pool_task* task;
+    pthread_mutex_lock(&pool.lock);
+    while (!pool.head)
+      pthread_cond_wait(&pool.ready, &pool.lock);
+    task = pool.head;
+    pool.head = task->next;
+    if (!pool.head)
+      pool.tail = NULL;
+    pthread_mutex_unlock(&pool.lock);
+    task->run(task->data);
+    free(task);
+  }
+  return NULL;
+}
+
+/* grow pool to at least the requested number of workers; return pool size */
+static uint
+pool_reserve(uint workers)
+{
+  uint count;
+  pthread_mutex_lock(&pool.lock);
+  while (pool.workers < workers) {
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, pool_worker, NULL))
+      break;
+    pthread_detach(thread);
+    pool.workers++;
+  }
+  count = MIN(pool.workers, workers);
+  pthread_mutex_unlock(&pool.lock);
+  return count;
+}
+
+/* queue task for internal pool (run it immediately if out of memory) */
+static void
+pool_submit(void* user, void (*run)(void*), void* data)
+{
+  pool_task* task = (pool_task*)malloc(sizeof(pool_task));
+  (void)user;
+  if (!task) {
+    run(data);
+    return;
+  }
+  task->run = run;
+  task->data = data;
+  task->next = NULL;
+  pthread_mutex_lock(&pool.lock);
+  if (pool.tail)
+    pool.tail->next = task;
+  else
+    pool.head = task;
+  pool.tail = task;
+  pthread_cond_signal(&pool.ready);
+  pthread_mutex_unlock(&pool.lock);
+}
+
+/* chunks shared among tasks; freed by last task to finish */
+typedef struct {
+  pthread_mutex_t lock; /* protects counters */
+  pthread_cond_t done;  /* signaled when all chunks are processed */
+  uint chunks;          /* number of chunks */
+  uint next;            /* next chunk to claim */
+  uint finished;        /* number of chunks processed */
+  uint refs;            /* number of tasks (and caller) referencing job */
+  void* context;        /* argument to chunk processor */
+  /* chunk processor */
+  void (*run)(void* context, uint chunk);
+} thread_job;
+
+/* process unclaimed chunks until none remain */
+static void
+job_work(thread_job* job)
+{
+  for (;;) {
+    uint chunk;
+    pthread_mutex_lock(&job->lock);
+    chunk = job->next < job->chunks ? job->next++ : job->chunks;
+    pthread_mutex_unlock(&job->lock);
+    if (chunk == job->chunks)
+      break;
+    job->run(job->context, chunk);
+    pthread_mutex_lock(&job->lock);
+    if (++job->finished == job->chunks)
+      pthread_cond_broadcast(&job->done);
+    pthread_mutex_unlock(&job->lock);
+  }
+}
+
+/* drop reference to job and free it if no longer referenced */
+static void
+job_release(thread_job* job)
+{
+  uint refs;
+  pthread_mutex_lock(&job->lock);
+  refs = --job->refs;
+  pthread_mutex_unlock(&job->lock);
+  if (!refs) {
+    pthread_cond_destroy(&job->done);
+    pthread_mutex_destroy(&job->lock);
+    free(job);
+  }
+}
+
+/* task run by pool or user runtime */
+static void
+job_task(void* data)
+{
+  thread_job* job = (thread_job*)data;
+  job_work(job);
+  job_release(job);
+}
+
+/* process chunks on calling thread and up to threads - 1 tasks */
+static void
+run_par_threads(const zfp_stream* stream, uint threads, uint chunks, void (*run)(void*, uint), void* context)
+{
+  zfp_submit_func submit = stream->exec.params.threads.submit;
+  void* user = stream->exec.params.threads.user;
+  uint tasks = MIN(threads, chunks) - 1;
+  thread_job* job = (thread_job*)malloc(sizeof(thread_job));
+  uint i;
+
+  /* fall back on serial execution if out of memory */
+  if (!job) {
+    for (i = 0; i < chunks; i++)
+      run(context, i);
+    return;
+  }
+
+  if (!submit) {
+    tasks = pool_reserve(tasks);
+    submit = pool_submit;
+  }
+  pthread_mutex_init(&job->lock, NULL);
+  pthread_cond_init(&job->done, NULL);
+  job->chunks = chunks;
+  job->next = 0;
+  job->finished = 0;
+  job->refs = tasks + 1;
+  job->run = run;
+  job->context = context;
+  for (i = 0; i < tasks; i++)
+    submit(user, job_task, job);
+
+  /* participate, then wait for chunks claimed by other tasks */
+  job_work(job);
+  pthread_mutex_lock(&job->lock);
+  while (job->finished < job->chunks)
+    pthread_cond_wait(&job->done, &job->lock);
+  pthread_mutex_unlock(&job->lock);
+  job_release(job);
+}
+
+/* number of threads to use */
+static uint
+thread_count_threads(const zfp_stream* stream)
+{
+  uint count = stream->exec.params.threads.threads;
+  /* if no thread count is specified, use one thread per online processor */
+  if (!count) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    count = n > 0 ? (uint)n : 1;
+  }
+  return count;
+}
+
+/* number of chunks to partition array into */
+static uint
+chunk_count_threads(const zfp_stream* stream, uint blocks, uint threads)
+{
+  uint chunk_size = stream->exec.params.threads.chunk_size;
+  /* if no chunk size is specified, assign a few chunks per thread */
+  uint chunks = chunk_size ? (blocks + chunk_size - 1) / chunk_size : 4 * threads;
+  return MAX(MIN(chunks, blocks), 1u);
+}
+
+/* state shared by tasks compressing chunks */
+typedef struct {
+  zfp_stream* stream;     /* compressed stream */
+  const zfp_field* field; /* field to compress */
+  bitstream** bs;         /* per-chunk bit streams */
+  uint blocks;            /* number of blocks */
+  uint chunks;            /* number of chunks */
+  /* compressor of range of blocks */
+  void (*compress)(zfp_stream*, const zfp_field*, uint, uint);
+} compress_context_threads;
+
+/* compress one chunk of blocks */
+static void
+compress_chunk_threads(void* context, uint chunk)
+{
+  compress_context_threads* c = (compress_context_threads*)context;
+  zfp_stream s = *c->stream;
+  PROFILE_CHUNK(stats)
+  zfp_stream_set_bit_stream(&s, c->bs[chunk]);
+  profile_chunk_begin(&s, &stats);
+  c->compress(&s, c->field, chunk_offset(c->blocks, c->chunks, chunk + 0), chunk_offset(c->blocks, c->chunks, chunk + 1));
+  profile_chunk_end(c->stream, &stats);
+}
+
+/* compress field in parallel using given block range compressor */
+static void
+compress_par_threads(zfp_stream* stream, const zfp_field* field, void (*compress)(zfp_stream*, const zfp_field*, uint, uint))
+{
+  compress_context_threads c;
+  uint threads = thread_count_threads(stream);
+  c.stream = stream;
+  c.field = field;
+  c.blocks = field_blocks(field);
+  c.chunks = chunk_count_threads(stream, c.blocks, threads);
+  c.compress = compress;
+  c.bs = compress_init_par(stream, field, c.chunks, c.blocks);
+  run_par_threads(stream, threads, c.chunks, compress_chunk_threads, &c);
+  compress_finish_par(stream, field, c.bs, c.chunks, c.blocks);
+}
+
+/* state shared by tasks decompressing chunks */
+typedef struct {
+  zfp_stream* stream; /* compressed stream */
+  zfp_field* field;   /* field to decompress */
+  bitstream** bs;     /* per-chunk bit streams */
+  uint blocks;        /* number of blocks */
+  uint chunks;        /* number of chunks */
+  /* decompressor of range of blocks */
+  void (*decompress)(zfp_stream*, zfp_field*, uint, uint);
+} decompress_context_threads;
+
+/* decompress one chunk of blocks */
+static void
+decompress_chunk_threads(void* context, uint chunk)
+{
+  decompress_context_threads* c = (decompress_context_threads*)context;
+  zfp_stream s = *c->stream;
+  zfp_stream_set_bit_stream(&s, c->bs[chunk]);
+  c->decompress(&s, c->field, chunk_offset(c->blocks, c->chunks, chunk + 0), chunk_offset(c->blocks, c->chunks, chunk + 1));
+}
+
+/* decompress field in parallel using given block range decompressor */
+static void
+decompress_par_threads(zfp_stream* stream, zfp_field* field, void (*decompress)(zfp_stream*, zfp_field*, uint, uint))
+{
+  decompress_context_threads c;
+  uint threads = thread_count_threads(stream);
+  c.stream = stream;
+  c.field = field;
+  c.blocks = field_blocks(field);
+  c.chunks = chunk_count_threads(stream, c.blocks, threads);
+  c.decompress = decompress;
+  /* number of chunks recorded in index overrides requested number */
+  c.bs = decompress_init_par(stream, &c.chunks, c.blocks);
+  run_par_threads(stream, threads, c.chunks, decompress_chunk_threads, &c);
+  decompress_finish_par(stream, c.bs, c.chunks);
+}
+
+#endif
@@ -1,3 +1,69 @@
 #define PERM _t1(perm, DIMS)           /* coefficient order */
 #define BLOCK_SIZE (1 << (2 * DIMS))   /* values per block */
+#define BATCH_SIZE (BLOCK_SIZE < 64 ? 64 / BLOCK_SIZE : 1) /* blocks per batch */
 #define EBIAS ((1 << (EBITS - 1)) - 1) /* exponent bias */
+#define REVERSIBLE(zfp) ((zfp)->minexp < ZFP_MIN_EXP) /* reversible mode? */
+
+#if defined(ZFP_WITH_KERNELS) && !defined(ZFP_KERNEL)
+/* generic codec forwards calls to the kernel selected for the stream */
+#define _kernel(function, kernel) _cat2(function, kernel)
+#define KERNEL_DECLARE(type, function, params) \
+  type _kernel(function, avx2) params; \
+  type _kernel(function, avx512) params;
+#define KERNEL_DISPATCH(zfp, function, args) \
+  switch ((zfp)->kernel) { \
+    case zfp_kernel_avx2: \
+      return _kernel(function, avx2) args; \
+    case zfp_kernel_avx512: \
+      return _kernel(function, avx512) args; \
+    default: \
+      break; \
+  }
+#else
+#define KERNEL_DECLARE(type, function, params)
+#define KERNEL_DISPATCH(zfp, function, args)
+#endif
+
+#ifdef ZFP_WITH_PROFILE
+/* processor cycle counter (clock ticks where none is available) */
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+  #ifdef _MSC_VER
+    #include <intrin.h>
+  #else
+    #include <x86intrin.h>
+  #endif
+  #define profile_cycles() ((uint64)__rdtsc())
+#else
+  #include <time.h>
+  #define profile_cycles() ((uint64)clock())
+#endif
+/* evaluate statement and charge its cycles to codec stage */
+#define PROFILE(zfp, stage, statement) \
+  do { \
+    uint64 _start = profile_cycles(); \
+    statement; \
+    if ((zfp)->stats) \
+      (zfp)->stats->cycles[stage] += profile_cycles() - _start; \
+  } while (0)
+/* add n to statistics counter */
+#define PROFILE_COUNT(zfp, counter, n) \
+  do { \
+    if ((zfp)->stats) \
+      (zfp)->stats->counter += (n); \
+  } while (0)
+/* count block encoded using given number of bits */
+#define PROFILE_BLOCK(zfp, bits) \
+  do { \
+    if ((zfp)->stats) { \
+      uint _bits = (bits), _bin = 0; \
+      while (_bits >>= 1) \
+        _bin++; \
+      (zfp)->stats->blocks++; \
+      (zfp)->stats->histogram[MIN(_bin, ZFP_STATS_BINS - 1)]++; \
+    } \
+  } while (0)
+#else
+#define PROFILE(zfp, stage, statement) statement
+#define PROFILE_COUNT(zfp, counter, n)
+#define PROFILE_BLOCK(zfp, bits)
+#endif
@@ -126,3 +126,65 @@ _t2(compress_strided, Scalar, 4)(zfp_stream* stream, const zfp_field* field)
             _t2(zfp_encode_block_strided, Scalar, 4)(stream, p, sx, sy, sz, sw);
         }
 }
+
+/* compress blocks with indices in [bmin, bmax) of strided d-dimensional array */
+static void
+_t1(compress_range, Scalar)(zfp_stream* stream, const zfp_field* field, uint bmin, uint bmax)
+{
+  /* array metadata */
+  const Scalar* data = (const Scalar*)field->data;
+  uint dims = zfp_field_dimensionality(field);
+  uint nx = field->nx;
+  uint ny = dims > 1 ? field->ny : 1;
+  uint nz = dims > 2 ? field->nz : 1;
+  uint nw = dims > 3 ? field->nw : 1;
+  int sx = field->sx ? field->sx : 1;
+  int sy = field->sy ? field->sy : (int)nx;
+  int sz = field->sz ? field->sz : (int)(nx * ny);
+  int sw = field->sw ? field->sw : (int)(nx * ny * nz);
+  uint bx = (nx + 3) / 4;
+  uint by = (ny + 3) / 4;
+  uint bz = (nz + 3) / 4;
+  uint block;
+
+  for (block = bmin; block < bmax; block++) {
+    /* determine block origin (x, y, z, w) within array */
+    uint b = block;
+    uint x = 4 * (b % bx); b /= bx;
+    uint y = 4 * (b % by); b /= by;
+    uint z = 4 * (b % bz); b /= bz;
+    uint w = 4 * b;
+    uint mx = MIN(nx - x, 4u);
+    uint my = MIN(ny - y, 4u);
+    uint mz = MIN(nz - z, 4u);
+    uint mw = MIN(nw - w, 4u);
+    const Scalar* p = data + sx * (ptrdiff_t)x + sy * (ptrdiff_t)y + sz * (ptrdiff_t)z + sw * (ptrdiff_t)w;
+    /* compress partial or full block */
+    switch (dims) {
+      case 1:
+        if (mx < 4)
+          _t2(zfp_encode_partial_block_strided, Scalar, 1)(stream, p, mx, sx);
+        else
+          _t2(zfp_encode_block_strided, Scalar, 1)(stream, p, sx);
+        break;
+      case 2:
+        if (mx < 4 || my < 4)
+          _t2(zfp_encode_partial_block_strided, Scalar, 2)(stream, p, mx, my, sx, sy);
+        else
+          _t2(zfp_encode_block_strided, Scalar, 2)(stream, p, sx, sy);
+        break;
+      case 3:
+        if (mx < 4 || my < 4 || mz < 4)
+          _t2(zfp_encode_partial_block_strided, Scalar, 3)(stream, p, mx, my, mz, sx, sy, sz);
+        else
+          _t2(zfp_encode_block_strided, Scalar, 3)(stream, p, sx, sy, sz);
+        break;
+      case 4:
+        if (mx < 4 || my < 4 || mz < 4 || mw < 4)
+          _t2(zfp_encode_partial_block_strided, Scalar, 4)(stream, p, mx, my, mz, mw, sx, sy, sz, sw);
+        else
+          _t2(zfp_encode_block_strided, Scalar, 4)(stream, p, sx, sy, sz, sw);
+        break;
+    }
+  }
+}
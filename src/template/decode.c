@@ -1,36 +1,75 @@
 #include <limits.h>
+#include "simd.h"
 
 static void _t2(inv_xform, Int, DIMS)(Int* p);
+static void _t2(rev_inv_xform, Int, DIMS)(Int* p);
 
 /* private functions ------------------------------------------------------- */
 
-/* inverse lifting transform of 4-vector */
+/* inverse lifting transform of n 4-vectors (element stride s, vector stride t) */
 static void
-_t1(inv_lift, Int)(Int* p, uint s)
+_t1(inv_lift, Int)(Int* p, uint s, uint t, uint n)
 {
-  Int x, y, z, w;
-  x = *p; p += s;
-  y = *p; p += s;
-  z = *p; p += s;
-  w = *p; p += s;
-
-  /*
-  ** non-orthogonal transform
-  **       ( 4  6 -4 -1) (x)
-  ** 1/4 * ( 4  2  4  5) (y)
-  **       ( 4 -2  4 -5) (z)
-  **       ( 4 -6 -4  1) (w)
-  */
-  y += w >> 1; w -= y >> 1;
-  y += w; w <<= 1; w -= y;
-  z += x; x <<= 1; x -= z;
-  y += z; z <<= 1; z -= y;
-  w += x; x <<= 1; x -= w;
-
-  p -= s; *p = w;
-  p -= s; *p = z;
-  p -= s; *p = y;
-  p -= s; *p = x;
+  uint i = 0;
+#ifdef ZFP_SIMD
+  /* transform leading vectors in lockstep in SIMD registers */
+  i = _t1(simd_inv_lift, Int)(p, s, t, n);
+  p += i * t;
+#endif
+  for (; i < n; i++, p += t) {
+    Int x = p[0 * s];
+    Int y = p[1 * s];
+    Int z = p[2 * s];
+    Int w = p[3 * s];
+
+    /*
+    ** non-orthogonal transform
+    **       ( 4  6 -4 -1) (x)
+    ** 1/4 * ( 4  2  4  5) (y)
+    **       ( 4 -2  4 -5) (z)
+    **       ( 4 -6 -4  1) (w)
+    */
+    y += w >> 1; w -= y >> 1;
+    y += w; w <<= 1; w -= y;
+    z += x; x <<= 1; x -= z;
+    y += z; z <<= 1; z -= y;
+    w += x; x <<= 1; x -= w;
+
+    p[0 * s] = x;
+    p[1 * s] = y;
+    p[2 * s] = z;
+    p[3 * s] = w;
+  }
+}
+
+/* inverse reversible lifting transform of n 4-vectors */
+static void
+_t1(rev_inv_lift, Int)(Int* p, uint s, uint t, uint n)
+{
+  uint i;
+  for (i = 0; i < n; i++, p += t) {
+    /* use unsigned arithmetic so that sums wrap around */
+    UInt x = (UInt)p[0 * s];
+    UInt y = (UInt)p[1 * s];
+    UInt z = (UInt)p[2 * s];
+    UInt w = (UInt)p[3 * s];
+
+    /*
+    ** high-order Lorenzo transform (inverse)
+    ** ( 1  0  0  0) (x)
+    ** ( 1  1  0  0) (y)
+    ** ( 1  2  1  0) (z)
+    ** ( 1  3  3  1) (w)
+    */
+    w += z;
+    z += y; w += z;
+    y += x; z += y; w += z;
+
+    p[0 * s] = (Int)x;
+    p[1 * s] = (Int)y;
+    p[2 * s] = (Int)z;
+    p[3 * s] = (Int)w;
+  }
 }
 
 /* map two's complement signed integer to negabinary unsigned integer */
@@ -49,9 +88,26 @@ _t1(inv_order, Int)(const UInt* ublock, Int* iblock, const uchar* perm, uint n)
   while (--n);
 }
 
-/* decompress sequence of size unsigned integers */
+/* transpose 64 bit planes into 64 unsigned integers */
+static void
+_t1(inv_planes, UInt)(UInt* restrict_ data, uint64* restrict_ plane)
+{
+  uint64 m, t;
+  uint i, j;
+  /* 64x64 bit matrix transpose via recursive exchange of off-diagonal blocks */
+  for (j = 32, m = UINT64C(0x00000000ffffffff); j; j >>= 1, m ^= m << j)
+    for (i = 0; i < 64; i = ((i | j) + 1) & ~j) {
+      t = ((plane[i] >> j) ^ plane[i | j]) & m;
+      plane[i] ^= t << j;
+      plane[i | j] ^= t;
+    }
+  for (i = 0; i < 64; i++)
+    data[i] = (UInt)plane[i];
+}
+
+/* decompress sequence of size unsigned integers, or into 64 bit planes if given */
 static uint
-_t1(decode_ints, UInt)(bitstream* restrict_ stream, uint maxbits, uint maxprec, UInt* restrict_ data, uint size)
+_t1(decode_ints, UInt)(bitstream* restrict_ stream, uint maxbits, uint maxprec, UInt* restrict_ data, uint64* restrict_ plane, uint size)
 {
   /* make a copy of bit stream to avoid aliasing */
   bitstream s = *stream;
@@ -60,10 +116,19 @@ _t1(decode_ints, UInt)(bitstream* restrict_ stream, uint maxbits, uint maxprec,
   uint bits = maxbits;
   uint i, k, m, n;
   uint64 x;
+  cache_align_(uint64 buffer[64]);
+  /* buffer bit planes and transpose them at the end unless very few bits are decoded */
+  int transpose = (!plane && size == 64 && maxbits > 4 * size);
+  if (transpose)
+    plane = buffer;
 
-  /* initialize data array to all zeros */
-  for (i = 0; i < size; i++)
-    data[i] = 0;
+  /* initialize data array or bit planes to all zeros */
+  if (plane)
+    for (i = 0; i < 64; i++)
+      plane[i] = 0;
+  else
+    for (i = 0; i < size; i++)
+      data[i] = 0;
 
   /* decode one bit plane at a time from MSB to LSB */
   for (k = intprec, n = 0; bits && k-- > kmin;) {
@@ -72,14 +137,25 @@ _t1(decode_ints, UInt)(bitstream* restrict_ stream, uint maxbits, uint maxprec,
     bits -= m;
     x = stream_read_bits(&s, m);
     /* unary run-length decode remainder of bit plane */
-    for (; n < size && bits && (bits--, stream_read_bit(&s)); x += (uint64)1 << n++)
-      for (; n < size - 1 && bits && (bits--, !stream_read_bit(&s)); n++)
-        ;
+    for (; n < size && bits && (bits--, stream_read_bit(&s)); x += (uint64)1 << n++) {
+      /* skip zeros up to next one-bit, last value, or end of bit budget */
+      uint c = MIN(size - 1 - n, bits);
+      uint z = stream_skip_zeros(&s, c);
+      bits -= z < c ? z + 1 : z;
+      n += z;
+    }
     /* deposit bit plane from x */
-    for (i = 0; x; i++, x >>= 1)
-      data[i] += (UInt)(x & 1u) << k;
+    if (plane)
+      plane[k] = x;
+    else
+      for (i = 0; x; i++, x >>= 1)
+        data[i] += (UInt)(x & 1u) << k;
   }
 
+  /* deposit all bit planes at once */
+  if (transpose)
+    _t1(inv_planes, UInt)(data, plane);
+
   *stream = s;
   return maxbits - bits;
 }
@@ -104,13 +180,20 @@ _t1(decode_many_ints, UInt)(bitstream* restrict_ stream, uint maxbits, uint maxp
     /* decode first n bits of bit plane #k */
     m = MIN(n, bits);
     bits -= m;
-    for (i = 0; i < m; i++)
-      if (stream_read_bit(&s))
-        data[i] += (UInt)1 << k;
+    for (i = 0; i < m; i += 64) {
+      uint64 x = stream_read_bits(&s, MIN(m - i, 64));
+      uint j;
+      for (j = i; x; j++, x >>= 1)
+        data[j] += (UInt)(x & 1u) << k;
+    }
     /* unary run-length decode remainder of bit plane */
-    for (; n < size && bits && (--bits, stream_read_bit(&s)); data[n] += (UInt)1 << k, n++)
-      for (; n < size - 1 && bits && (--bits, !stream_read_bit(&s)); n++)
-        ;
+    for (; n < size && bits && (--bits, stream_read_bit(&s)); data[n] += (UInt)1 << k, n++) {
+      /* skip zeros up to next one-bit, last value, or end of bit budget */
+      uint c = MIN(size - 1 - n, bits);
+      uint z = stream_skip_zeros(&s, c);
+      bits -= z < c ? z + 1 : z;
+      n += z;
+    }
   }
 
   *stream = s;
@@ -125,7 +208,7 @@ _t2(decode_block, Int, DIMS)(bitstream* stream, int minbits, int maxbits, int ma
   cache_align_(UInt ublock[BLOCK_SIZE]);
   /* decode integer coefficients */
   if (BLOCK_SIZE <= 64)
-    bits = _t1(decode_ints, UInt)(stream, maxbits, maxprec, ublock, BLOCK_SIZE);
+    bits = _t1(decode_ints, UInt)(stream, maxbits, maxprec, ublock, NULL, BLOCK_SIZE);
   else
     bits = _t1(decode_many_ints, UInt)(stream, maxbits, maxprec, ublock, BLOCK_SIZE);
   /* read at least minbits bits */
@@ -139,3 +222,80 @@ _t2(decode_block, Int, DIMS)(bitstream* stream, int minbits, int maxbits, int ma
   _t2(inv_xform, Int, DIMS)(iblock);
   return bits;
 }
+
+/* decode block #i of batch, merging its bit planes into those of batch */
+static uint
+_t2(decode_batch_block, Int, DIMS)(bitstream* stream, int minbits, int maxbits, int maxprec, UInt* ublock, uint64* plane, uint i)
+{
+  int bits;
+#if BLOCK_SIZE < 64
+  cache_align_(uint64 bplane[64]);
+  uint k;
+  bits = _t1(decode_ints, UInt)(stream, maxbits, maxprec, NULL, bplane, BLOCK_SIZE);
+  for (k = 0; k < CHAR_BIT * sizeof(UInt); k++)
+    plane[k] |= bplane[k] << (i * BLOCK_SIZE);
+#elif BLOCK_SIZE == 64
+  bits = _t1(decode_ints, UInt)(stream, maxbits, maxprec, NULL, plane, BLOCK_SIZE);
+#else
+  bits = _t1(decode_many_ints, UInt)(stream, maxbits, maxprec, ublock + i * BLOCK_SIZE, BLOCK_SIZE);
+#endif
+  /* read at least minbits bits */
+  if (bits < minbits) {
+    stream_skip(stream, minbits - bits);
+    bits = minbits;
+  }
+  return bits;
+}
+
+/* transpose bit planes of n <= BATCH_SIZE decoded blocks and inverse transform them */
+static void
+_t2(inv_batch, Int, DIMS)(UInt* restrict_ ublock, uint64* restrict_ plane, Int* restrict_ iblock, uint n)
+{
+  uint i;
+#if BLOCK_SIZE <= 64
+  _t1(inv_planes, UInt)(ublock, plane);
+#endif
+  for (i = 0; i < n; i++) {
+    /* reorder unsigned coefficients and convert to signed integer */
+    _t1(inv_order, Int)(ublock + i * BLOCK_SIZE, iblock + i * BLOCK_SIZE, PERM, BLOCK_SIZE);
+    /* perform decorrelating transform */
+    _t2(inv_xform, Int, DIMS)(iblock + i * BLOCK_SIZE);
+  }
+}
+
+/* undo alignment of most significant nonzero bit plane with MSB */
+static void
+_t1(rev_inv_shift, UInt)(UInt* data, uint n, uint shift)
+{
+  if (shift)
+    do
+      *data++ >>= shift;
+    while (--n);
+}
+
+/* decode block of integers using reversible algorithm */
+static uint
+_t2(rev_decode_block, Int, DIMS)(bitstream* stream, int minbits, int maxbits, Int* iblock)
+{
+  int bits = PBITS;
+  uint prec;
+  cache_align_(UInt ublock[BLOCK_SIZE]);
+  /* decode precision needed to represent all coefficients losslessly */
+  prec = (uint)stream_read_bits(stream, PBITS) + 1;
+  /* decode integer coefficients */
+  if (BLOCK_SIZE <= 64)
+    bits += _t1(decode_ints, UInt)(stream, maxbits - bits, prec, ublock, NULL, BLOCK_SIZE);
+  else
+    bits += _t1(decode_many_ints, UInt)(stream, maxbits - bits, prec, ublock, BLOCK_SIZE);
+  /* read at least minbits bits */
+  if (bits < minbits) {
+    stream_skip(stream, minbits - bits);
+    bits = minbits;
+  }
+  _t1(rev_inv_shift, UInt)(ublock, BLOCK_SIZE, CHAR_BIT * (uint)sizeof(UInt) - prec);
+  /* reorder unsigned coefficients and convert to signed integer */
+  _t1(inv_order, Int)(ublock, iblock, PERM, BLOCK_SIZE);
+  /* perform decorrelating transform */
+  _t2(rev_inv_xform, Int, DIMS)(iblock);
+  return bits;
+}
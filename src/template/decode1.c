@@ -23,7 +23,15 @@ static void
 _t2(inv_xform, Int, 1)(Int* p)
 {
   /* transform along x */
-  _t1(inv_lift, Int)(p, 1);
+  _t1(inv_lift, Int)(p, 1, 4, 1);
+}
+
+/* inverse reversible decorrelating 1D transform */
+static void
+_t2(rev_inv_xform, Int, 1)(Int* p)
+{
+  /* transform along x */
+  _t1(rev_inv_lift, Int)(p, 1, 4, 1);
 }
 
 /* public functions -------------------------------------------------------- */
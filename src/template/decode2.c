@@ -24,13 +24,20 @@ _t2(scatter_partial, Scalar, 2)(const Scalar* q, Scalar* p, uint nx, uint ny, in
 static void
 _t2(inv_xform, Int, 2)(Int* p)
 {
-  uint x, y;
   /* transform along y */
-  for (x = 0; x < 4; x++)
-    _t1(inv_lift, Int)(p + 1 * x, 4);
+  _t1(inv_lift, Int)(p, 4, 1, 4);
+  /* transform along x */
+  _t1(inv_lift, Int)(p, 1, 4, 4);
+}
+
+/* inverse reversible decorrelating 2D transform */
+static void
+_t2(rev_inv_xform, Int, 2)(Int* p)
+{
+  /* transform along y */
+  _t1(rev_inv_lift, Int)(p, 4, 1, 4);
   /* transform along x */
-  for (y = 0; y < 4; y++)
-    _t1(inv_lift, Int)(p + 4 * y, 1);
+  _t1(rev_inv_lift, Int)(p, 1, 4, 4);
 }
 
 /* public functions -------------------------------------------------------- */
@@ -1,5 +1,6 @@
 #include <limits.h>
 #include <math.h>
+#include <string.h>
 
 /* private functions ------------------------------------------------------- */
 
@@ -22,12 +23,85 @@ _t1(inv_cast, Scalar)(const Int* iblock, Scalar* fblock, uint n, int emax)
   while (--n);
 }
 
+/* reinterpret two's complement integers as floating-point values */
+static void
+_t1(rev_inv_reinterpret, Scalar)(Int* iblock, Scalar* fblock, uint n)
+{
+  const Int intmax = (Int)(~(UInt)0 >> 1);
+  uint i;
+  /* map two's complement to sign-magnitude */
+  for (i = 0; i < n; i++)
+    if (iblock[i] < 0)
+      iblock[i] ^= intmax;
+  memcpy(fblock, iblock, n * sizeof(*fblock));
+}
+
+/* decode contiguous floating-point block using reversible algorithm */
+static uint
+_t2(rev_decode_block, Scalar, DIMS)(zfp_stream* zfp, Scalar* fblock)
+{
+  cache_align_(Int iblock[BLOCK_SIZE]);
+  uint bits;
+  /* test if block has nonzero values */
+  if (!stream_read_bit(zfp->stream)) {
+    /* set all values to zero */
+    uint i;
+    for (i = 0; i < BLOCK_SIZE; i++)
+      *fblock++ = 0;
+    if (zfp->minbits > 1) {
+      stream_skip(zfp->stream, zfp->minbits - 1);
+      return zfp->minbits;
+    }
+    else
+      return 1;
+  }
+  /* test whether block-floating-point transform was applied */
+  if (!stream_read_bit(zfp->stream)) {
+    /* decode common exponent */
+    int emax = (int)stream_read_bits(zfp->stream, EBITS) - EBIAS;
+    bits = 2 + EBITS;
+    /* decode integer block */
+    bits += _t2(rev_decode_block, Int, DIMS)(zfp->stream, zfp->minbits - bits, zfp->maxbits - bits, iblock);
+    /* perform inverse block-floating-point transform */
+    _t1(inv_cast, Scalar)(iblock, fblock, BLOCK_SIZE, emax);
+  }
+  else {
+    /* decode integer block and reinterpret as floating-point values */
+    bits = 2;
+    bits += _t2(rev_decode_block, Int, DIMS)(zfp->stream, zfp->minbits - bits, zfp->maxbits - bits, iblock);
+    _t1(rev_inv_reinterpret, Scalar)(iblock, fblock, BLOCK_SIZE);
+  }
+  return bits;
+}
+
+/* decode block of all zeros */
+static uint
+_t1(decode_zero_block, Scalar)(zfp_stream* zfp, Scalar* fblock)
+{
+  /* set all values to zero */
+  uint i;
+  for (i = 0; i < BLOCK_SIZE; i++)
+    *fblock++ = 0;
+  if (zfp->minbits > 1) {
+    stream_skip(zfp->stream, zfp->minbits - 1);
+    return zfp->minbits;
+  }
+  else
+    return 1;
+}
+
+KERNEL_DECLARE(uint, _t2(zfp_decode_block, Scalar, DIMS), (zfp_stream*, Scalar*))
+KERNEL_DECLARE(size_t, _t2(zfp_decode_blocks, Scalar, DIMS), (zfp_stream*, Scalar*, uint))
+
 /* public functions -------------------------------------------------------- */
 
 /* decode contiguous floating-point block */
 uint
 _t2(zfp_decode_block, Scalar, DIMS)(zfp_stream* zfp, Scalar* fblock)
 {
+  KERNEL_DISPATCH(zfp, _t2(zfp_decode_block, Scalar, DIMS), (zfp, fblock))
+  if (REVERSIBLE(zfp))
+    return _t2(rev_decode_block, Scalar, DIMS)(zfp, fblock);
   /* test if block has nonzero values */
   if (stream_read_bit(zfp->stream)) {
     cache_align_(Int iblock[BLOCK_SIZE]);
@@ -41,16 +115,56 @@ _t2(zfp_decode_block, Scalar, DIMS)(zfp_stream* zfp, Scalar* fblock)
     _t1(inv_cast, Scalar)(iblock, fblock, BLOCK_SIZE, emax);
     return ebits + bits;
   }
-  else {
-    /* set all values to zero */
-    uint i;
-    for (i = 0; i < BLOCK_SIZE; i++)
-      *fblock++ = 0;
-    if (zfp->minbits > 1) {
-      stream_skip(zfp->stream, zfp->minbits - 1);
-      return zfp->minbits;
+  else
+    return _t1(decode_zero_block, Scalar)(zfp, fblock);
+}
+
+/* decode count contiguous floating-point blocks */
+size_t
+_t2(zfp_decode_blocks, Scalar, DIMS)(zfp_stream* zfp, Scalar* fblock, uint count)
+{
+  cache_align_(Int iblock[BATCH_SIZE * BLOCK_SIZE]);
+  cache_align_(UInt ublock[BATCH_SIZE * BLOCK_SIZE]);
+  cache_align_(uint64 plane[64]);
+  int emax[BATCH_SIZE];
+  uchar nonzero[BATCH_SIZE];
+  size_t bits = 0;
+  uint i, j, n;
+  KERNEL_DISPATCH(zfp, _t2(zfp_decode_blocks, Scalar, DIMS), (zfp, fblock, count))
+  if (REVERSIBLE(zfp)) {
+    for (; count; count--, fblock += BLOCK_SIZE)
+      bits += _t2(zfp_decode_block, Scalar, DIMS)(zfp, fblock);
+    return bits;
+  }
+  for (; count; count -= n, fblock += n * BLOCK_SIZE) {
+    n = MIN(count, BATCH_SIZE);
+    /* decode bit planes of batch one block at a time */
+    for (i = 0; i < 64; i++)
+      plane[i] = 0;
+    for (i = 0; i < n; i++) {
+      /* test if block has nonzero values */
+      nonzero[i] = (uchar)stream_read_bit(zfp->stream);
+      if (nonzero[i]) {
+        /* decode common exponent and integer block */
+        uint ebits = EBITS + 1;
+        int maxprec;
+        emax[i] = (int)stream_read_bits(zfp->stream, ebits - 1) - EBIAS;
+        maxprec = precision(emax[i], zfp->maxprec, zfp->minexp, DIMS);
+        bits += ebits + _t2(decode_batch_block, Int, DIMS)(zfp->stream, zfp->minbits - ebits, zfp->maxbits - ebits, maxprec, ublock, plane, i);
+      }
+      else {
+        /* zero block leaves its bit planes empty */
+        for (j = 0; j < BLOCK_SIZE; j++)
+          ublock[i * BLOCK_SIZE + j] = 0;
+        bits += _t1(decode_zero_block, Scalar)(zfp, fblock + i * BLOCK_SIZE);
+      }
     }
-    else
-      return 1;
+    /* transpose bit planes and inverse transform batch */
+    _t2(inv_batch, Int, DIMS)(ublock, plane, iblock, n);
+    /* perform inverse block-floating-point transform of nonzero blocks */
+    for (i = 0; i < n; i++)
+      if (nonzero[i])
+        _t1(inv_cast, Scalar)(iblock + i * BLOCK_SIZE, fblock + i * BLOCK_SIZE, BLOCK_SIZE, emax[i]);
   }
+  return bits;
 }
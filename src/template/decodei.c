@@ -1,8 +1,41 @@
+KERNEL_DECLARE(uint, _t2(zfp_decode_block, Int, DIMS), (zfp_stream*, Int*))
+KERNEL_DECLARE(size_t, _t2(zfp_decode_blocks, Int, DIMS), (zfp_stream*, Int*, uint))
+
 /* public functions -------------------------------------------------------- */
 
 /* decode contiguous integer block */
 uint
 _t2(zfp_decode_block, Int, DIMS)(zfp_stream* zfp, Int* iblock)
 {
+  KERNEL_DISPATCH(zfp, _t2(zfp_decode_block, Int, DIMS), (zfp, iblock))
+  if (REVERSIBLE(zfp))
+    return _t2(rev_decode_block, Int, DIMS)(zfp->stream, zfp->minbits, zfp->maxbits, iblock);
   return _t2(decode_block, Int, DIMS)(zfp->stream, zfp->minbits, zfp->maxbits, zfp->maxprec, iblock);
 }
+
+/* decode count contiguous integer blocks */
+size_t
+_t2(zfp_decode_blocks, Int, DIMS)(zfp_stream* zfp, Int* iblock, uint count)
+{
+  cache_align_(UInt ublock[BATCH_SIZE * BLOCK_SIZE]);
+  cache_align_(uint64 plane[64]);
+  size_t bits = 0;
+  uint i, n;
+  KERNEL_DISPATCH(zfp, _t2(zfp_decode_blocks, Int, DIMS), (zfp, iblock, count))
+  if (REVERSIBLE(zfp)) {
+    for (; count; count--, iblock += BLOCK_SIZE)
+      bits += _t2(zfp_decode_block, Int, DIMS)(zfp, iblock);
+    return bits;
+  }
+  for (; count; count -= n, iblock += n * BLOCK_SIZE) {
+    n = MIN(count, BATCH_SIZE);
+    /* decode bit planes of batch one block at a time */
+    for (i = 0; i < 64; i++)
+      plane[i] = 0;
+    for (i = 0; i < n; i++)
+      bits += _t2(decode_batch_block, Int, DIMS)(zfp->stream, zfp->minbits, zfp->maxbits, zfp->maxprec, ublock, plane, i);
+    /* transpose bit planes and inverse transform batch */
+    _t2(inv_batch, Int, DIMS)(ublock, plane, iblock, n);
+  }
+  return bits;
+}
@@ -126,3 +126,153 @@ _t2(decompress_strided, Scalar, 4)(zfp_stream* stream, zfp_field* field)
             _t2(zfp_decode_block_strided, Scalar, 4)(stream, p, sx, sy, sz, sw);
         }
 }
+
+/* decompress blocks with indices in [bmin, bmax) of strided d-dimensional array */
+static void
+_t1(decompress_range, Scalar)(zfp_stream* stream, zfp_field* field, uint bmin, uint bmax)
+{
+  /* array metadata */
+  Scalar* data = (Scalar*)field->data;
+  uint dims = zfp_field_dimensionality(field);
+  uint nx = field->nx;
+  uint ny = dims > 1 ? field->ny : 1;
+  uint nz = dims > 2 ? field->nz : 1;
+  uint nw = dims > 3 ? field->nw : 1;
+  int sx = field->sx ? field->sx : 1;
+  int sy = field->sy ? field->sy : (int)nx;
+  int sz = field->sz ? field->sz : (int)(nx * ny);
+  int sw = field->sw ? field->sw : (int)(nx * ny * nz);
+  uint bx = (nx + 3) / 4;
+  uint by = (ny + 3) / 4;
+  uint bz = (nz + 3) / 4;
+  uint block;
+
+  for (block = bmin; block < bmax; block++) {
+    /* determine block origin (x, y, z, w) within array */
+    uint b = block;
+    uint x = 4 * (b % bx); b /= bx;
+    uint y = 4 * (b % by); b /= by;
+    uint z = 4 * (b % bz); b /= bz;
+    uint w = 4 * b;
+    uint mx = MIN(nx - x, 4u);
+    uint my = MIN(ny - y, 4u);
+    uint mz = MIN(nz - z, 4u);
+    uint mw = MIN(nw - w, 4u);
+    Scalar* p = data + sx * (ptrdiff_t)x + sy * (ptrdiff_t)y + sz * (ptrdiff_t)z + sw * (ptrdiff_t)w;
+    /* decompress partial or full block */
+    switch (dims) {
+      case 1:
+        if (mx < 4)
+          _t2(zfp_decode_partial_block_strided, Scalar, 1)(stream, p, mx, sx);
+        else
+          _t2(zfp_decode_block_strided, Scalar, 1)(stream, p, sx);
+        break;
+      case 2:
+        if (mx < 4 || my < 4)
+          _t2(zfp_decode_partial_block_strided, Scalar, 2)(stream, p, mx, my, sx, sy);
+        else
+          _t2(zfp_decode_block_strided, Scalar, 2)(stream, p, sx, sy);
+        break;
+      case 3:
+        if (mx < 4 || my < 4 || mz < 4)
+          _t2(zfp_decode_partial_block_strided, Scalar, 3)(stream, p, mx, my, mz, sx, sy, sz);
+        else
+          _t2(zfp_decode_block_strided, Scalar, 3)(stream, p, sx, sy, sz);
+        break;
+      case 4:
+        if (mx < 4 || my < 4 || mz < 4 || mw < 4)
+          _t2(zfp_decode_partial_block_strided, Scalar, 4)(stream, p, mx, my, mz, mw, sx, sy, sz, sw);
+        else
+          _t2(zfp_decode_block_strided, Scalar, 4)(stream, p, sx, sy, sz, sw);
+        break;
+    }
+  }
+}
+
+/* decode one block of given dimensionality */
+static uint
+_t1(decode_region_block, Scalar)(zfp_stream* stream, Scalar* block, uint dims)
+{
+  switch (dims) {
+    case 1:
+      return _t2(zfp_decode_block, Scalar, 1)(stream, block);
+    case 2:
+      return _t2(zfp_decode_block, Scalar, 2)(stream, block);
+    default:
+      return _t2(zfp_decode_block, Scalar, 3)(stream, block);
+  }
+}
+
+/* decompress blocks of 1d, 2d, or 3d array intersecting box into strided region */
+static void
+_t1(decompress_region, Scalar)(zfp_stream* stream, zfp_field* field, uint x0, uint y0, uint z0, uint nx, uint ny, uint nz)
+{
+  Scalar* data = (Scalar*)field->data;
+  uint dims = zfp_field_dimensionality(field);
+  uint bx = (field->nx + 3) / 4;
+  uint by = dims > 1 ? (field->ny + 3) / 4 : 1;
+  uint bz = dims > 2 ? (field->nz + 3) / 4 : 1;
+  uint blocks = bx * by * bz;
+  int sx = field->sx ? field->sx : 1;
+  int sy = field->sy ? field->sy : (int)nx;
+  int sz = field->sz ? field->sz : (int)(nx * ny);
+  int fixed = stream->minbits == stream->maxbits;
+  int aligned = stream->index == ZFP_INDEX_ALIGNED;
+  bitstream* s = stream->stream;
+  size_t index = 0;
+  size_t base;
+  uint chunks = 1;
+  uint chunk = 0;
+  uint next = 0;
+  uint i, j, k;
+  Scalar block[64];
+
+  /* locate first block following chunk offset index, if any */
+  if (stream->index) {
+    chunks = (uint)stream_read_bits(s, ZFP_INDEX_BITS);
+    index = stream_rtell(s);
+  }
+  base = stream_rtell(s) + (size_t)(chunks - 1) * ZFP_INDEX_BITS;
+  if (aligned)
+    base = align_offset(base);
+  stream_rseek(s, base);
+
+  /* decompress intersecting blocks in stream order */
+  for (k = z0 / 4; k <= (z0 + nz - 1) / 4; k++)
+    for (j = y0 / 4; j <= (y0 + ny - 1) / 4; j++)
+      for (i = x0 / 4; i <= (x0 + nx - 1) / 4; i++) {
+        uint b = i + bx * (j + by * k);
+        uint xmin = MAX(x0, 4 * i), xmax = MIN(x0 + nx, 4 * i + 4);
+        uint ymin = MAX(y0, 4 * j), ymax = MIN(y0 + ny, 4 * j + 4);
+        uint zmin = MAX(z0, 4 * k), zmax = MIN(z0 + nz, 4 * k + 4);
+        uint x, y, z;
+        if (fixed && !aligned)
+          /* each block occupies exactly maxbits bits in fixed-rate mode */
+          stream_rseek(s, base + (size_t)b * stream->maxbits);
+        else {
+          /* seek to start of chunk containing block, if not already there */
+          uint c = chunk_index(blocks, chunks, b);
+          if (c != chunk) {
+            stream_rseek(s, index + (size_t)(c - 1) * ZFP_INDEX_BITS);
+            stream_rseek(s, base + (size_t)stream_read_bits(s, ZFP_INDEX_BITS));
+            chunk = c;
+            next = chunk_offset(blocks, chunks, c);
+          }
+          if (fixed) {
+            /* aligned chunks are padded; blocks within a chunk are not */
+            stream_rseek(s, stream_rtell(s) + (size_t)(b - next) * stream->maxbits);
+            next = b;
+          }
+          /* variable-length blocks preceding this one must be decoded */
+          for (; next < b; next++)
+            _t1(decode_region_block, Scalar)(stream, block, dims);
+          next = b + 1;
+        }
+        _t1(decode_region_block, Scalar)(stream, block, dims);
+        /* copy part of block within box */
+        for (z = zmin; z < zmax; z++)
+          for (y = ymin; y < ymax; y++)
+            for (x = xmin; x < xmax; x++)
+              data[sx * (ptrdiff_t)(x - x0) + sy * (ptrdiff_t)(y - y0) + sz * (ptrdiff_t)(z - z0)] = block[(x - 4 * i) + 4 * ((y - 4 * j) + 4 * (z - 4 * k))];
+      }
+}
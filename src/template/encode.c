@@ -1,6 +1,8 @@
 #include <limits.h>
+#include "simd.h"
 
 static void _t2(fwd_xform, Int, DIMS)(Int* p);
+static void _t2(rev_fwd_xform, Int, DIMS)(Int* p);
 
 /* private functions ------------------------------------------------------- */
 
@@ -26,33 +28,70 @@ _t1(pad_block, Scalar)(Scalar* p, uint n, uint s)
   }
 }
 
-/* forward lifting transform of 4-vector */
+/* forward lifting transform of n 4-vectors (element stride s, vector stride t) */
 static void
-_t1(fwd_lift, Int)(Int* p, uint s)
+_t1(fwd_lift, Int)(Int* p, uint s, uint t, uint n)
 {
-  Int x, y, z, w;
-  x = *p; p += s;
-  y = *p; p += s;
-  z = *p; p += s;
-  w = *p; p += s;
-
-  /*
-  ** non-orthogonal transform
-  **        ( 4  4  4  4) (x)
-  ** 1/16 * ( 5  1 -1 -5) (y)
-  **        (-4  4  4 -4) (z)
-  **        (-2  6 -6  2) (w)
-  */
-  x += w; x >>= 1; w -= x;
-  z += y; z >>= 1; y -= z;
-  x += z; x >>= 1; z -= x;
-  w += y; w >>= 1; y -= w;
-  w += y >> 1; y -= w >> 1;
-
-  p -= s; *p = w;
-  p -= s; *p = z;
-  p -= s; *p = y;
-  p -= s; *p = x;
+  uint i = 0;
+#ifdef ZFP_SIMD
+  /* transform leading vectors in lockstep in SIMD registers */
+  i = _t1(simd_fwd_lift, Int)(p, s, t, n);
+  p += i * t;
+#endif
+  for (; i < n; i++, p += t) {
+    Int x = p[0 * s];
+    Int y = p[1 * s];
+    Int z = p[2 * s];
+    Int w = p[3 * s];
+
+    /*
+    ** non-orthogonal transform
+    **        ( 4  4  4  4) (x)
+    ** 1/16 * ( 5  1 -1 -5) (y)
+    **        (-4  4  4 -4) (z)
+    **        (-2  6 -6  2) (w)
+    */
+    x += w; x >>= 1; w -= x;
+    z += y; z >>= 1; y -= z;
+    x += z; x >>= 1; z -= x;
+    w += y; w >>= 1; y -= w;
+    w += y >> 1; y -= w >> 1;
+
+    p[0 * s] = x;
+    p[1 * s] = y;
+    p[2 * s] = z;
+    p[3 * s] = w;
+  }
+}
+
+/* forward reversible lifting transform of n 4-vectors */
+static void
+_t1(rev_fwd_lift, Int)(Int* p, uint s, uint t, uint n)
+{
+  uint i;
+  for (i = 0; i < n; i++, p += t) {
+    /* use unsigned arithmetic so that differences wrap around */
+    UInt x = (UInt)p[0 * s];
+    UInt y = (UInt)p[1 * s];
+    UInt z = (UInt)p[2 * s];
+    UInt w = (UInt)p[3 * s];
+
+    /*
+    ** high-order Lorenzo transform
+    ** ( 1  0  0  0) (x)
+    ** (-1  1  0  0) (y)
+    ** ( 1 -2  1  0) (z)
+    ** (-1  3 -3  1) (w)
+    */
+    w -= z; z -= y; y -= x;
+    w -= z; z -= y;
+    w -= z;
+
+    p[0 * s] = (Int)x;
+    p[1 * s] = (Int)y;
+    p[2 * s] = (Int)z;
+    p[3 * s] = (Int)w;
+  }
 }
 
 /* map two's complement signed integer to negabinary unsigned integer */
@@ -71,24 +110,50 @@ _t1(fwd_order, Int)(UInt* ublock, const Int* iblock, const uchar* perm, uint n)
   while (--n);
 }
 
-/* compress sequence of size unsigned integers */
+/* transpose 64 unsigned integers into 64 bit planes */
+static void
+_t1(fwd_planes, UInt)(uint64* restrict_ plane, const UInt* restrict_ data)
+{
+  uint64 m, t;
+  uint i, j;
+  for (i = 0; i < 64; i++)
+    plane[i] = data[i];
+  /* 64x64 bit matrix transpose via recursive exchange of off-diagonal blocks */
+  for (j = 32, m = UINT64C(0x00000000ffffffff); j; j >>= 1, m ^= m << j)
+    for (i = 0; i < 64; i = ((i | j) + 1) & ~j) {
+      t = ((plane[i] >> j) ^ plane[i | j]) & m;
+      plane[i] ^= t << j;
+      plane[i | j] ^= t;
+    }
+}
+
+/* compress sequence of size unsigned integers, or their bit planes if given */
 static uint
-_t1(encode_ints, UInt)(bitstream* restrict_ stream, uint maxbits, uint maxprec, const UInt* restrict_ data, uint size)
+_t1(encode_ints, UInt)(zfp_stream* zfp, uint maxbits, uint maxprec, const UInt* restrict_ data, const uint64* restrict_ plane, uint size)
 {
   /* make a copy of bit stream to avoid aliasing */
-  bitstream s = *stream;
+  bitstream s = *zfp->stream;
   uint intprec = CHAR_BIT * (uint)sizeof(UInt);
   uint kmin = intprec > maxprec ? intprec - maxprec : 0;
   uint bits = maxbits;
   uint i, k, m, n;
   uint64 x;
+  cache_align_(uint64 buffer[64]);
+
+  /* extract all bit planes at once when block is 64 integers */
+  if (!plane && size == 64) {
+    _t1(fwd_planes, UInt)(buffer, data);
+    plane = buffer;
+  }
 
   /* encode one bit plane at a time from MSB to LSB */
   for (k = intprec, n = 0; bits && k-- > kmin;) {
     /* step 1: extract bit plane #k to x */
-    x = 0;
-    for (i = 0; i < size; i++)
-      x += (uint64)((data[i] >> k) & 1u) << i;
+    if (plane)
+      x = plane[k];
+    else
+      for (i = 0, x = 0; i < size; i++)
+        x += (uint64)((data[i] >> k) & 1u) << i;
     /* step 2: encode first n bits of bit plane */
     m = MIN(n, bits);
     bits -= m;
@@ -99,16 +164,18 @@ _t1(encode_ints, UInt)(bitstream* restrict_ stream, uint maxbits, uint maxprec,
         ;
   }
 
-  *stream = s;
+  /* count planes coded before running out of planes or bits */
+  PROFILE_COUNT(zfp, planes, bits ? intprec - kmin : intprec - k);
+  *zfp->stream = s;
   return maxbits - bits;
 }
 
 /* compress sequence of size > 64 unsigned integers */
 static uint
-_t1(encode_many_ints, UInt)(bitstream* restrict_ stream, uint maxbits, uint maxprec, const UInt* restrict_ data, uint size)
+_t1(encode_many_ints, UInt)(zfp_stream* zfp, uint maxbits, uint maxprec, const UInt* restrict_ data, uint size)
 {
   /* make a copy of bit stream to avoid aliasing */
-  bitstream s = *stream;
+  bitstream s = *zfp->stream;
   uint intprec = CHAR_BIT * (uint)sizeof(UInt);
   uint kmin = intprec > maxprec ? intprec - maxprec : 0;
   uint bits = maxbits;
@@ -131,28 +198,128 @@ _t1(encode_many_ints, UInt)(bitstream* restrict_ stream, uint maxbits, uint maxp
         ;
   }
 
-  *stream = s;
+  /* count planes coded before running out of planes or bits */
+  PROFILE_COUNT(zfp, planes, bits ? intprec - kmin : intprec - k);
+  *zfp->stream = s;
   return maxbits - bits;
 }
 
 /* encode block of integers */
 static uint
-_t2(encode_block, Int, DIMS)(bitstream* stream, int minbits, int maxbits, int maxprec, Int* iblock)
+_t2(encode_block, Int, DIMS)(zfp_stream* zfp, int minbits, int maxbits, int maxprec, Int* iblock)
 {
   int bits;
   cache_align_(UInt ublock[BLOCK_SIZE]);
   /* perform decorrelating transform */
-  _t2(fwd_xform, Int, DIMS)(iblock);
+  PROFILE(zfp, zfp_stage_xform, _t2(fwd_xform, Int, DIMS)(iblock));
+  /* reorder signed coefficients and convert to unsigned integer */
+  PROFILE(zfp, zfp_stage_order, _t1(fwd_order, Int)(ublock, iblock, PERM, BLOCK_SIZE));
+  /* encode integer coefficients */
+  if (BLOCK_SIZE <= 64)
+    PROFILE(zfp, zfp_stage_code, bits = _t1(encode_ints, UInt)(zfp, maxbits, maxprec, ublock, NULL, BLOCK_SIZE));
+  else
+    PROFILE(zfp, zfp_stage_code, bits = _t1(encode_many_ints, UInt)(zfp, maxbits, maxprec, ublock, BLOCK_SIZE));
+  /* write at least minbits bits by padding with zeros */
+  if (bits < minbits) {
+    stream_pad(zfp->stream, minbits - bits);
+    bits = minbits;
+  }
+  return bits;
+}
+
+/* transform n <= BATCH_SIZE consecutive integer blocks and extract the bit
+   planes of all their coefficients at once when there are at most 64 */
+static void
+_t2(fwd_batch, Int, DIMS)(zfp_stream* zfp, uint64* restrict_ plane, UInt* restrict_ ublock, Int* restrict_ iblock, uint n)
+{
+  uint i;
+  for (i = 0; i < n; i++) {
+    /* perform decorrelating transform */
+    PROFILE(zfp, zfp_stage_xform, _t2(fwd_xform, Int, DIMS)(iblock + i * BLOCK_SIZE));
+    /* reorder signed coefficients and convert to unsigned integer */
+    PROFILE(zfp, zfp_stage_order, _t1(fwd_order, Int)(ublock + i * BLOCK_SIZE, iblock + i * BLOCK_SIZE, PERM, BLOCK_SIZE));
+  }
+#if BLOCK_SIZE <= 64
+  /* zero-fill partial batch and transpose coefficients into bit planes */
+  for (i = n * BLOCK_SIZE; i < 64; i++)
+    ublock[i] = 0;
+  PROFILE(zfp, zfp_stage_code, _t1(fwd_planes, UInt)(plane, ublock));
+#endif
+}
+
+/* encode block #i of batch transformed by fwd_batch */
+static uint
+_t2(encode_batch_block, Int, DIMS)(zfp_stream* zfp, int minbits, int maxbits, int maxprec, const UInt* ublock, const uint64* plane, uint i)
+{
+  int bits;
+#if BLOCK_SIZE < 64
+  /* separate bit planes of block #i from those of batch */
+  cache_align_(uint64 bplane[CHAR_BIT * sizeof(UInt)]);
+  uint k;
+  for (k = 0; k < CHAR_BIT * sizeof(UInt); k++)
+    bplane[k] = (plane[k] >> (i * BLOCK_SIZE)) & (~UINT64C(0) >> (64 - BLOCK_SIZE));
+  plane = bplane;
+#endif
+  /* encode integer coefficients */
+  if (BLOCK_SIZE <= 64)
+    PROFILE(zfp, zfp_stage_code, bits = _t1(encode_ints, UInt)(zfp, maxbits, maxprec, ublock + i * BLOCK_SIZE, plane, BLOCK_SIZE));
+  else
+    PROFILE(zfp, zfp_stage_code, bits = _t1(encode_many_ints, UInt)(zfp, maxbits, maxprec, ublock + i * BLOCK_SIZE, BLOCK_SIZE));
+  /* write at least minbits bits by padding with zeros */
+  if (bits < minbits) {
+    stream_pad(zfp->stream, minbits - bits);
+    bits = minbits;
+  }
+  return bits;
+}
+
+/* number of bit planes needed to represent n unsigned integers exactly */
+static uint
+_t1(rev_precision, UInt)(const UInt* data, uint n)
+{
+  UInt m = 0;
+  uint p = 0;
+  do
+    m |= *data++;
+  while (--n);
+  for (; m; m >>= 1)
+    p++;
+  return MAX(p, 1u);
+}
+
+/* align most significant nonzero bit plane with MSB */
+static void
+_t1(rev_fwd_shift, UInt)(UInt* data, uint n, uint shift)
+{
+  if (shift)
+    do
+      *data++ <<= shift;
+    while (--n);
+}
+
+/* encode block of integers using reversible algorithm */
+static uint
+_t2(rev_encode_block, Int, DIMS)(zfp_stream* zfp, int minbits, int maxbits, Int* iblock)
+{
+  int bits = PBITS;
+  uint prec;
+  cache_align_(UInt ublock[BLOCK_SIZE]);
+  /* perform decorrelating transform */
+  PROFILE(zfp, zfp_stage_xform, _t2(rev_fwd_xform, Int, DIMS)(iblock));
   /* reorder signed coefficients and convert to unsigned integer */
-  _t1(fwd_order, Int)(ublock, iblock, PERM, BLOCK_SIZE);
+  PROFILE(zfp, zfp_stage_order, _t1(fwd_order, Int)(ublock, iblock, PERM, BLOCK_SIZE));
+  /* encode precision needed to represent all coefficients losslessly */
+  prec = _t1(rev_precision, UInt)(ublock, BLOCK_SIZE);
+  stream_write_bits(zfp->stream, prec - 1, PBITS);
+  _t1(rev_fwd_shift, UInt)(ublock, BLOCK_SIZE, CHAR_BIT * (uint)sizeof(UInt) - prec);
   /* encode integer coefficients */
   if (BLOCK_SIZE <= 64)
-    bits = _t1(encode_ints, UInt)(stream, maxbits, maxprec, ublock, BLOCK_SIZE);
+    PROFILE(zfp, zfp_stage_code, bits += _t1(encode_ints, UInt)(zfp, maxbits - bits, prec, ublock, NULL, BLOCK_SIZE));
   else
-    bits = _t1(encode_many_ints, UInt)(stream, maxbits, maxprec, ublock, BLOCK_SIZE);
+    PROFILE(zfp, zfp_stage_code, bits += _t1(encode_many_ints, UInt)(zfp, maxbits - bits, prec, ublock, BLOCK_SIZE));
   /* write at least minbits bits by padding with zeros */
   if (bits < minbits) {
-    stream_pad(stream, minbits - bits);
+    stream_pad(zfp->stream, minbits - bits);
     bits = minbits;
   }
   return bits;
@@ -24,7 +24,15 @@ static void
 _t2(fwd_xform, Int, 1)(Int* p)
 {
   /* transform along x */
-  _t1(fwd_lift, Int)(p, 1);
+  _t1(fwd_lift, Int)(p, 1, 4, 1);
+}
+
+/* forward reversible decorrelating 1D transform */
+static void
+_t2(rev_fwd_xform, Int, 1)(Int* p)
+{
+  /* transform along x */
+  _t1(rev_fwd_lift, Int)(p, 1, 4, 1);
 }
 
 /* public functions -------------------------------------------------------- */
@@ -28,13 +28,20 @@ _t2(gather_partial, Scalar, 2)(Scalar* q, const Scalar* p, uint nx, uint ny, int
 static void
 _t2(fwd_xform, Int, 2)(Int* p)
 {
-  uint x, y;
   /* transform along x */
-  for (y = 0; y < 4; y++)
-    _t1(fwd_lift, Int)(p + 4 * y, 1);
+  _t1(fwd_lift, Int)(p, 1, 4, 4);
   /* transform along y */
-  for (x = 0; x < 4; x++)
-    _t1(fwd_lift, Int)(p + 1 * x, 4);
+  _t1(fwd_lift, Int)(p, 4, 1, 4);
+}
+
+/* forward reversible decorrelating 2D transform */
+static void
+_t2(rev_fwd_xform, Int, 2)(Int* p)
+{
+  /* transform along x */
+  _t1(rev_fwd_lift, Int)(p, 1, 4, 4);
+  /* transform along y */
+  _t1(rev_fwd_lift, Int)(p, 4, 1, 4);
 }
 
 /* public functions -------------------------------------------------------- */
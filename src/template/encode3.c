@@ -34,19 +34,28 @@ _t2(gather_partial, Scalar, 3)(Scalar* q, const Scalar* p, uint nx, uint ny, uin
 static void
 _t2(fwd_xform, Int, 3)(Int* p)
 {
-  uint x, y, z;
+  uint z;
   /* transform along x */
+  _t1(fwd_lift, Int)(p, 1, 4, 16);
+  /* transform along y */
   for (z = 0; z < 4; z++)
-    for (y = 0; y < 4; y++)
-      _t1(fwd_lift, Int)(p + 4 * y + 16 * z, 1);
+    _t1(fwd_lift, Int)(p + 16 * z, 4, 1, 4);
+  /* transform along z */
+  _t1(fwd_lift, Int)(p, 16, 1, 16);
+}
+
+/* forward reversible decorrelating 3D transform */
+static void
+_t2(rev_fwd_xform, Int, 3)(Int* p)
+{
+  uint z;
+  /* transform along x */
+  _t1(rev_fwd_lift, Int)(p, 1, 4, 16);
   /* transform along y */
-  for (x = 0; x < 4; x++)
-    for (z = 0; z < 4; z++)
-      _t1(fwd_lift, Int)(p + 16 * z + 1 * x, 4);
+  for (z = 0; z < 4; z++)
+    _t1(rev_fwd_lift, Int)(p + 16 * z, 4, 1, 4);
   /* transform along z */
-  for (y = 0; y < 4; y++)
-    for (x = 0; x < 4; x++)
-      _t1(fwd_lift, Int)(p + 1 * x + 4 * y, 16);
+  _t1(rev_fwd_lift, Int)(p, 16, 1, 16);
 }
 
 /* public functions -------------------------------------------------------- */
@@ -41,27 +41,36 @@ _t2(gather_partial, Scalar, 4)(Scalar* q, const Scalar* p, uint nx, uint ny, uin
 static void
 _t2(fwd_xform, Int, 4)(Int* p)
 {
-  uint x, y, z, w;
+  uint z, w;
   /* transform along x */
+  _t1(fwd_lift, Int)(p, 1, 4, 64);
+  /* transform along y */
   for (w = 0; w < 4; w++)
     for (z = 0; z < 4; z++)
-      for (y = 0; y < 4; y++)
-        _t1(fwd_lift, Int)(p + 4 * y + 16 * z + 64 * w, 1);
+      _t1(fwd_lift, Int)(p + 16 * z + 64 * w, 4, 1, 4);
+  /* transform along z */
+  for (w = 0; w < 4; w++)
+    _t1(fwd_lift, Int)(p + 64 * w, 16, 1, 16);
+  /* transform along w */
+  _t1(fwd_lift, Int)(p, 64, 1, 64);
+}
+
+/* forward reversible decorrelating 4D transform */
+static void
+_t2(rev_fwd_xform, Int, 4)(Int* p)
+{
+  uint z, w;
+  /* transform along x */
+  _t1(rev_fwd_lift, Int)(p, 1, 4, 64);
   /* transform along y */
-  for (x = 0; x < 4; x++)
-    for (w = 0; w < 4; w++)
-      for (z = 0; z < 4; z++)
-        _t1(fwd_lift, Int)(p + 16 * z + 64 * w + 1 * x, 4);
+  for (w = 0; w < 4; w++)
+    for (z = 0; z < 4; z++)
+      _t1(rev_fwd_lift, Int)(p + 16 * z + 64 * w, 4, 1, 4);
   /* transform along z */
-  for (y = 0; y < 4; y++)
-    for (x = 0; x < 4; x++)
-      for (w = 0; w < 4; w++)
-        _t1(fwd_lift, Int)(p + 64 * w + 1 * x + 4 * y, 16);
+  for (w = 0; w < 4; w++)
+    _t1(rev_fwd_lift, Int)(p + 64 * w, 16, 1, 16);
   /* transform along w */
-  for (z = 0; z < 4; z++)
-    for (y = 0; y < 4; y++)
-      for (x = 0; x < 4; x++)
-        _t1(fwd_lift, Int)(p + 1 * x + 4 * y + 16 * z, 64);
+  _t1(rev_fwd_lift, Int)(p, 64, 1, 64);
 }
 
 /* public functions -------------------------------------------------------- */
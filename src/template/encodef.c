@@ -1,5 +1,6 @@
 #include <limits.h>
 #include <math.h>
+#include <string.h>
 
 /* private functions ------------------------------------------------------- */
 
@@ -48,16 +49,119 @@ _t1(fwd_cast, Scalar)(Int* iblock, const Scalar* fblock, uint n, int emax)
   while (--n);
 }
 
+/* forward block-floating-point transform; return nonzero if exactly invertible */
+static int
+_t1(rev_fwd_cast, Scalar)(Int* iblock, const Scalar* fblock, uint n, int emax)
+{
+  /* scale factors as used by fwd_cast and inv_cast */
+  Scalar s = _t1(quantize, Scalar)(1, emax);
+  Scalar t = LDEXP((Scalar)1, emax - (CHAR_BIT * (int)sizeof(Scalar) - 2));
+  uint i;
+  /* the transform is undefined for infinite scale factors and values */
+  if (!(s - s == 0 && t - t == 0))
+    return 0;
+  for (i = 0; i < n; i++) {
+    Scalar x = fblock[i];
+    Scalar y;
+    if (!(x - x == 0))
+      return 0;
+    iblock[i] = (Int)(s * x);
+    y = (Scalar)(t * iblock[i]);
+    /* compare bit patterns so that -0 is not mistaken for +0 */
+    if (memcmp(&x, &y, sizeof(x)))
+      return 0;
+  }
+  return 1;
+}
+
+/* reinterpret floating-point values as two's complement integers */
+static void
+_t1(rev_fwd_reinterpret, Scalar)(Int* iblock, const Scalar* fblock, uint n)
+{
+  const Int intmax = (Int)(~(UInt)0 >> 1);
+  uint i;
+  memcpy(iblock, fblock, n * sizeof(*iblock));
+  /* map sign-magnitude to two's complement so that order is preserved */
+  for (i = 0; i < n; i++)
+    if (iblock[i] < 0)
+      iblock[i] ^= intmax;
+}
+
+/* encode contiguous floating-point block using reversible algorithm */
+static uint
+_t2(rev_encode_block, Scalar, DIMS)(zfp_stream* zfp, const Scalar* fblock)
+{
+  cache_align_(Int iblock[BLOCK_SIZE]);
+  int emax, exact;
+  uint bits;
+  uint i;
+  PROFILE(zfp, zfp_stage_exponent, emax = _t1(exponent_block, Scalar)(fblock, BLOCK_SIZE));
+  PROFILE(zfp, zfp_stage_cast, exact = _t1(rev_fwd_cast, Scalar)(iblock, fblock, BLOCK_SIZE, emax));
+  if (exact) {
+    /* block-floating-point transform is lossless; encode common exponent */
+    stream_write_bits(zfp->stream, 1, 2);
+    stream_write_bits(zfp->stream, emax + EBIAS, EBITS);
+    bits = 2 + EBITS;
+  }
+  else {
+    /* fall back on coding the floating-point bit patterns */
+    PROFILE(zfp, zfp_stage_cast, _t1(rev_fwd_reinterpret, Scalar)(iblock, fblock, BLOCK_SIZE));
+    for (i = 0; i < BLOCK_SIZE && !iblock[i]; i++)
+      ;
+    if (i == BLOCK_SIZE) {
+      /* write single zero-bit to indicate that all values are +0 */
+      PROFILE_COUNT(zfp, zero_blocks, 1);
+      stream_write_bit(zfp->stream, 0);
+      if (zfp->minbits > 1) {
+        stream_pad(zfp->stream, zfp->minbits - 1);
+        return zfp->minbits;
+      }
+      else
+        return 1;
+    }
+    stream_write_bits(zfp->stream, 3, 2);
+    bits = 2;
+  }
+  /* encode integer block */
+  return bits + _t2(rev_encode_block, Int, DIMS)(zfp, zfp->minbits - bits, zfp->maxbits - bits, iblock);
+}
+
+/* encode block of all zeros, or of values too small to matter */
+static uint
+_t1(encode_zero_block, Scalar)(zfp_stream* zfp)
+{
+  /* write single zero-bit to indicate that all values are zero */
+  PROFILE_COUNT(zfp, zero_blocks, 1);
+  stream_write_bit(zfp->stream, 0);
+  if (zfp->minbits > 1) {
+    stream_pad(zfp->stream, zfp->minbits - 1);
+    return zfp->minbits;
+  }
+  else
+    return 1;
+}
+
+KERNEL_DECLARE(uint, _t2(zfp_encode_block, Scalar, DIMS), (zfp_stream*, const Scalar*))
+KERNEL_DECLARE(size_t, _t2(zfp_encode_blocks, Scalar, DIMS), (zfp_stream*, const Scalar*, uint))
+
 /* public functions -------------------------------------------------------- */
 
 /* encode contiguous floating-point block */
 uint
 _t2(zfp_encode_block, Scalar, DIMS)(zfp_stream* zfp, const Scalar* fblock)
 {
+  int emax, maxprec;
+  uint e, bits;
+  KERNEL_DISPATCH(zfp, _t2(zfp_encode_block, Scalar, DIMS), (zfp, fblock))
+  if (REVERSIBLE(zfp)) {
+    bits = _t2(rev_encode_block, Scalar, DIMS)(zfp, fblock);
+    PROFILE_BLOCK(zfp, bits);
+    return bits;
+  }
   /* compute maximum exponent */
-  int emax = _t1(exponent_block, Scalar)(fblock, BLOCK_SIZE);
-  int maxprec = precision(emax, zfp->maxprec, zfp->minexp, DIMS);
-  uint e = maxprec ? emax + EBIAS : 0;
+  PROFILE(zfp, zfp_stage_exponent, emax = _t1(exponent_block, Scalar)(fblock, BLOCK_SIZE));
+  maxprec = precision(emax, zfp->maxprec, zfp->minexp, DIMS);
+  e = maxprec ? emax + EBIAS : 0;
   /* encode block only if biased exponent is nonzero */
   if (e) {
     cache_align_(Int iblock[BLOCK_SIZE]);
@@ -65,18 +169,62 @@ _t2(zfp_encode_block, Scalar, DIMS)(zfp_stream* zfp, const Scalar* fblock)
     int ebits = EBITS + 1;
     stream_write_bits(zfp->stream, 2 * e + 1, ebits);
     /* perform forward block-floating-point transform */
-    _t1(fwd_cast, Scalar)(iblock, fblock, BLOCK_SIZE, emax);
+    PROFILE(zfp, zfp_stage_cast, _t1(fwd_cast, Scalar)(iblock, fblock, BLOCK_SIZE, emax));
     /* encode integer block */
-    return ebits + _t2(encode_block, Int, DIMS)(zfp->stream, zfp->minbits - ebits, zfp->maxbits - ebits, maxprec, iblock);
+    bits = ebits + _t2(encode_block, Int, DIMS)(zfp, zfp->minbits - ebits, zfp->maxbits - ebits, maxprec, iblock);
   }
-  else {
-    /* write single zero-bit to indicate that all values are zero */
-    stream_write_bit(zfp->stream, 0);
-    if (zfp->minbits > 1) {
-      stream_pad(zfp->stream, zfp->minbits - 1);
-      return zfp->minbits;
+  else
+    bits = _t1(encode_zero_block, Scalar)(zfp);
+  PROFILE_BLOCK(zfp, bits);
+  return bits;
+}
+
+/* encode count contiguous floating-point blocks */
+size_t
+_t2(zfp_encode_blocks, Scalar, DIMS)(zfp_stream* zfp, const Scalar* fblock, uint count)
+{
+  cache_align_(Int iblock[BATCH_SIZE * BLOCK_SIZE]);
+  cache_align_(UInt ublock[BATCH_SIZE * BLOCK_SIZE]);
+  cache_align_(uint64 plane[64]);
+  int emax[BATCH_SIZE];
+  int maxprec[BATCH_SIZE];
+  size_t bits = 0;
+  uint b, e, i, j, n;
+  KERNEL_DISPATCH(zfp, _t2(zfp_encode_blocks, Scalar, DIMS), (zfp, fblock, count))
+  if (REVERSIBLE(zfp)) {
+    for (; count; count--, fblock += BLOCK_SIZE)
+      bits += _t2(zfp_encode_block, Scalar, DIMS)(zfp, fblock);
+    return bits;
+  }
+  for (; count; count -= n, fblock += n * BLOCK_SIZE) {
+    n = MIN(count, BATCH_SIZE);
+    /* perform forward block-floating-point transform of each nonzero block */
+    for (i = 0; i < n; i++) {
+      Int* p = iblock + i * BLOCK_SIZE;
+      PROFILE(zfp, zfp_stage_exponent, emax[i] = _t1(exponent_block, Scalar)(fblock + i * BLOCK_SIZE, BLOCK_SIZE));
+      maxprec[i] = precision(emax[i], zfp->maxprec, zfp->minexp, DIMS);
+      if (maxprec[i] && emax[i] + EBIAS)
+        PROFILE(zfp, zfp_stage_cast, _t1(fwd_cast, Scalar)(p, fblock + i * BLOCK_SIZE, BLOCK_SIZE, emax[i]));
+      else
+        for (j = 0; j < BLOCK_SIZE; j++)
+          p[j] = 0;
+    }
+    /* transform and extract bit planes of batch */
+    _t2(fwd_batch, Int, DIMS)(zfp, plane, ublock, iblock, n);
+    /* encode blocks in order */
+    for (i = 0; i < n; i++) {
+      e = maxprec[i] ? emax[i] + EBIAS : 0;
+      if (e) {
+        /* encode common exponent and integer block */
+        int ebits = EBITS + 1;
+        stream_write_bits(zfp->stream, 2 * e + 1, ebits);
+        b = ebits + _t2(encode_batch_block, Int, DIMS)(zfp, zfp->minbits - ebits, zfp->maxbits - ebits, maxprec[i], ublock, plane, i);
+      }
+      else
+        b = _t1(encode_zero_block, Scalar)(zfp);
+      PROFILE_BLOCK(zfp, b);
+      bits += b;
     }
-    else
-      return 1;
   }
+  return bits;
 }
@@ -1,3 +1,6 @@
+KERNEL_DECLARE(uint, _t2(zfp_encode_block, Int, DIMS), (zfp_stream*, const Int*))
+KERNEL_DECLARE(size_t, _t2(zfp_encode_blocks, Int, DIMS), (zfp_stream*, const Int*, uint))
+
 /* public functions -------------------------------------------------------- */
 
 /* encode contiguous integer block */
@@ -5,9 +8,46 @@ uint
 _t2(zfp_encode_block, Int, DIMS)(zfp_stream* zfp, const Int* iblock)
 {
   cache_align_(Int block[BLOCK_SIZE]);
-  uint i;
+  uint bits, i;
+  KERNEL_DISPATCH(zfp, _t2(zfp_encode_block, Int, DIMS), (zfp, iblock))
   /* copy block */
   for (i = 0; i < BLOCK_SIZE; i++)
     block[i] = iblock[i];
-  return _t2(encode_block, Int, DIMS)(zfp->stream, zfp->minbits, zfp->maxbits, zfp->maxprec, block);
+  if (REVERSIBLE(zfp))
+    bits = _t2(rev_encode_block, Int, DIMS)(zfp, zfp->minbits, zfp->maxbits, block);
+  else
+    bits = _t2(encode_block, Int, DIMS)(zfp, zfp->minbits, zfp->maxbits, zfp->maxprec, block);
+  PROFILE_BLOCK(zfp, bits);
+  return bits;
+}
+
+/* encode count contiguous integer blocks */
+size_t
+_t2(zfp_encode_blocks, Int, DIMS)(zfp_stream* zfp, const Int* iblock, uint count)
+{
+  cache_align_(Int block[BATCH_SIZE * BLOCK_SIZE]);
+  cache_align_(UInt ublock[BATCH_SIZE * BLOCK_SIZE]);
+  cache_align_(uint64 plane[64]);
+  size_t bits = 0;
+  uint b, i, n;
+  KERNEL_DISPATCH(zfp, _t2(zfp_encode_blocks, Int, DIMS), (zfp, iblock, count))
+  if (REVERSIBLE(zfp)) {
+    for (; count; count--, iblock += BLOCK_SIZE)
+      bits += _t2(zfp_encode_block, Int, DIMS)(zfp, iblock);
+    return bits;
+  }
+  for (; count; count -= n, iblock += n * BLOCK_SIZE) {
+    n = MIN(count, BATCH_SIZE);
+    /* copy, transform, and extract bit planes of batch */
+    for (i = 0; i < n * BLOCK_SIZE; i++)
+      block[i] = iblock[i];
+    _t2(fwd_batch, Int, DIMS)(zfp, plane, ublock, block, n);
+    /* encode blocks in order */
+    for (i = 0; i < n; i++) {
+      b = _t2(encode_batch_block, Int, DIMS)(zfp, zfp->minbits, zfp->maxbits, zfp->maxprec, ublock, plane, i);
+      PROFILE_BLOCK(zfp, b);
+      bits += b;
+    }
+  }
+  return bits;
 }
@@ -16,17 +16,21 @@ _t2(compress_omp, Scalar, 1)(zfp_stream* stream, const zfp_field* field)
   /* allocate per-thread streams */
   bitstream** bs = compress_init_par(stream, field, chunks, blocks);
 
-  /* compress chunks of blocks in parallel */
+  /* compress chunks of blocks in parallel, assigning chunks dynamically */
   int chunk;
-  #pragma omp parallel for num_threads(threads)
+  timer_reset_omp(stream, threads);
+  #pragma omp parallel for num_threads(threads) schedule(dynamic, 1)
   for (chunk = 0; chunk < (int)chunks; chunk++) {
-    /* determine range of block indices assigned to this thread */
+    double start = timer_start_omp(stream);
+    /* determine range of block indices in this chunk */
     uint bmin = chunk_offset(blocks, chunks, chunk + 0);
     uint bmax = chunk_offset(blocks, chunks, chunk + 1);
     uint block;
     /* set up thread-local bit stream */
     zfp_stream s = *stream;
+    PROFILE_CHUNK(stats)
     zfp_stream_set_bit_stream(&s, bs[chunk]);
+    profile_chunk_begin(&s, &stats);
     /* compress sequence of blocks */
     for (block = bmin; block < bmax; block++) {
       /* determine block origin x within array */
@@ -39,10 +43,12 @@ _t2(compress_omp, Scalar, 1)(zfp_stream* stream, const zfp_field* field)
       else
         _t2(zfp_encode_block, Scalar, 1)(&s, p);
     }
+    profile_chunk_end(stream, &stats);
+    timer_stop_omp(stream, start);
   }
 
   /* concatenate per-thread streams */
-  compress_finish_par(stream, bs, chunks);
+  compress_finish_par(stream, field, bs, chunks, blocks);
 }
 
 /* compress 1d strided array in parallel */
@@ -62,17 +68,21 @@ _t2(compress_strided_omp, Scalar, 1)(zfp_stream* stream, const zfp_field* field)
   /* allocate per-thread streams */
   bitstream** bs = compress_init_par(stream, field, chunks, blocks);
 
-  /* compress chunks of blocks in parallel */
+  /* compress chunks of blocks in parallel, assigning chunks dynamically */
   int chunk;
-  #pragma omp parallel for num_threads(threads)
+  timer_reset_omp(stream, threads);
+  #pragma omp parallel for num_threads(threads) schedule(dynamic, 1)
   for (chunk = 0; chunk < (int)chunks; chunk++) {
-    /* determine range of block indices assigned to this thread */
+    double start = timer_start_omp(stream);
+    /* determine range of block indices in this chunk */
     uint bmin = chunk_offset(blocks, chunks, chunk + 0);
     uint bmax = chunk_offset(blocks, chunks, chunk + 1);
     uint block;
     /* set up thread-local bit stream */
     zfp_stream s = *stream;
+    PROFILE_CHUNK(stats)
     zfp_stream_set_bit_stream(&s, bs[chunk]);
+    profile_chunk_begin(&s, &stats);
     /* compress sequence of blocks */
     for (block = bmin; block < bmax; block++) {
       /* determine block origin x within array */
@@ -85,10 +95,12 @@ _t2(compress_strided_omp, Scalar, 1)(zfp_stream* stream, const zfp_field* field)
       else
         _t2(zfp_encode_block_strided, Scalar, 1)(&s, p, sx);
     }
+    profile_chunk_end(stream, &stats);
+    timer_stop_omp(stream, start);
   }
 
   /* concatenate per-thread streams */
-  compress_finish_par(stream, bs, chunks);
+  compress_finish_par(stream, field, bs, chunks, blocks);
 }
 
 /* compress 2d strided array in parallel */
@@ -112,17 +124,21 @@ _t2(compress_strided_omp, Scalar, 2)(zfp_stream* stream, const zfp_field* field)
   /* allocate per-thread streams */
   bitstream** bs = compress_init_par(stream, field, chunks, blocks);
 
-  /* compress chunks of blocks in parallel */
+  /* compress chunks of blocks in parallel, assigning chunks dynamically */
   int chunk;
-  #pragma omp parallel for num_threads(threads)
+  timer_reset_omp(stream, threads);
+  #pragma omp parallel for num_threads(threads) schedule(dynamic, 1)
   for (chunk = 0; chunk < (int)chunks; chunk++) {
-    /* determine range of block indices assigned to this thread */
+    double start = timer_start_omp(stream);
+    /* determine range of block indices in this chunk */
     uint bmin = chunk_offset(blocks, chunks, chunk + 0);
     uint bmax = chunk_offset(blocks, chunks, chunk + 1);
     uint block;
     /* set up thread-local bit stream */
     zfp_stream s = *stream;
+    PROFILE_CHUNK(stats)
     zfp_stream_set_bit_stream(&s, bs[chunk]);
+    profile_chunk_begin(&s, &stats);
     /* compress sequence of blocks */
     for (block = bmin; block < bmax; block++) {
       /* determine block origin (x, y) within array */
@@ -138,10 +154,12 @@ _t2(compress_strided_omp, Scalar, 2)(zfp_stream* stream, const zfp_field* field)
       else
         _t2(zfp_encode_block_strided, Scalar, 2)(&s, p, sx, sy);
     }
+    profile_chunk_end(stream, &stats);
+    timer_stop_omp(stream, start);
   }
 
   /* concatenate per-thread streams */
-  compress_finish_par(stream, bs, chunks);
+  compress_finish_par(stream, field, bs, chunks, blocks);
 }
 
 /* compress 3d strided array in parallel */
@@ -168,17 +186,21 @@ _t2(compress_strided_omp, Scalar, 3)(zfp_stream* stream, const zfp_field* field)
   /* allocate per-thread streams */
   bitstream** bs = compress_init_par(stream, field, chunks, blocks);
 
-  /* compress chunks of blocks in parallel */
+  /* compress chunks of blocks in parallel, assigning chunks dynamically */
   int chunk;
-  #pragma omp parallel for num_threads(threads)
+  timer_reset_omp(stream, threads);
+  #pragma omp parallel for num_threads(threads) schedule(dynamic, 1)
   for (chunk = 0; chunk < (int)chunks; chunk++) {
-    /* determine range of block indices assigned to this thread */
+    double start = timer_start_omp(stream);
+    /* determine range of block indices in this chunk */
     uint bmin = chunk_offset(blocks, chunks, chunk + 0);
     uint bmax = chunk_offset(blocks, chunks, chunk + 1);
     uint block;
     /* set up thread-local bit stream */
     zfp_stream s = *stream;
+    PROFILE_CHUNK(stats)
     zfp_stream_set_bit_stream(&s, bs[chunk]);
+    profile_chunk_begin(&s, &stats);
     /* compress sequence of blocks */
     for (block = bmin; block < bmax; block++) {
       /* determine block origin (x, y, z) within array */
@@ -195,10 +217,12 @@ _t2(compress_strided_omp, Scalar, 3)(zfp_stream* stream, const zfp_field* field)
       else
         _t2(zfp_encode_block_strided, Scalar, 3)(&s, p, sx, sy, sz);
     }
+    profile_chunk_end(stream, &stats);
+    timer_stop_omp(stream, start);
   }
 
   /* concatenate per-thread streams */
-  compress_finish_par(stream, bs, chunks);
+  compress_finish_par(stream, field, bs, chunks, blocks);
 }
 
 /* compress 4d strided array in parallel */
@@ -228,17 +252,21 @@ _t2(compress_strided_omp, Scalar, 4)(zfp_stream* stream, const zfp_field* field)
   /* allocate per-thread streams */
   bitstream** bs = compress_init_par(stream, field, chunks, blocks);
 
-  /* compress chunks of blocks in parallel */
+  /* compress chunks of blocks in parallel, assigning chunks dynamically */
   int chunk;
-  #pragma omp parallel for num_threads(threads)
+  timer_reset_omp(stream, threads);
+  #pragma omp parallel for num_threads(threads) schedule(dynamic, 1)
   for (chunk = 0; chunk < (int)chunks; chunk++) {
-    /* determine range of block indices assigned to this thread */
+    double start = timer_start_omp(stream);
+    /* determine range of block indices in this chunk */
     uint bmin = chunk_offset(blocks, chunks, chunk + 0);
     uint bmax = chunk_offset(blocks, chunks, chunk + 1);
     uint block;
     /* set up thread-local bit stream */
     zfp_stream s = *stream;
+    PROFILE_CHUNK(stats)
     zfp_stream_set_bit_stream(&s, bs[chunk]);
+    profile_chunk_begin(&s, &stats);
     /* compress sequence of blocks */
     for (block = bmin; block < bmax; block++) {
       /* determine block origin (x, y, z, w) within array */
@@ -256,10 +284,12 @@ _t2(compress_strided_omp, Scalar, 4)(zfp_stream* stream, const zfp_field* field)
       else
         _t2(zfp_encode_block_strided, Scalar, 4)(&s, p, sx, sy, sz, sw);
     }
+    profile_chunk_end(stream, &stats);
+    timer_stop_omp(stream, start);
   }
 
   /* concatenate per-thread streams */
-  compress_finish_par(stream, bs, chunks);
+  compress_finish_par(stream, field, bs, chunks, blocks);
 }
 
 #endif
@@ -0,0 +1,280 @@
+#ifdef _OPENMP
+
+/* decompress 1d contiguous array in parallel */
+static void
+_t2(decompress_omp, Scalar, 1)(zfp_stream* stream, zfp_field* field)
+{
+  /* array metadata */
+  Scalar* data = (Scalar*)field->data;
+  uint nx = field->nx;
+
+  /* number of omp threads, blocks, and chunks */
+  uint threads = thread_count_omp(stream);
+  uint blocks = (nx + 3) / 4;
+  uint chunks = chunk_count_omp(stream, blocks, threads);
+
+  /* allocate per-thread streams */
+  bitstream** bs = decompress_init_par(stream, &chunks, blocks);
+
+  /* decompress chunks of blocks in parallel, assigning chunks dynamically */
+  int chunk;
+  timer_reset_omp(stream, threads);
+  #pragma omp parallel for num_threads(threads) schedule(dynamic, 1)
+  for (chunk = 0; chunk < (int)chunks; chunk++) {
+    double start = timer_start_omp(stream);
+    /* determine range of block indices in this chunk */
+    uint bmin = chunk_offset(blocks, chunks, chunk + 0);
+    uint bmax = chunk_offset(blocks, chunks, chunk + 1);
+    uint block;
+    /* set up thread-local bit stream */
+    zfp_stream s = *stream;
+    zfp_stream_set_bit_stream(&s, bs[chunk]);
+    /* decompress sequence of blocks */
+    for (block = bmin; block < bmax; block++) {
+      /* determine block origin x within array */
+      Scalar* p = data;
+      uint x = 4 * block;
+      p += x;
+      /* decompress partial or full block */
+      if (nx - x < 4)
+        _t2(zfp_decode_partial_block_strided, Scalar, 1)(&s, p, MIN(nx - x, 4u), 1);
+      else
+        _t2(zfp_decode_block, Scalar, 1)(&s, p);
+    }
+    timer_stop_omp(stream, start);
+  }
+
+  /* position stream at end of last chunk */
+  decompress_finish_par(stream, bs, chunks);
+}
+
+/* decompress 1d strided array in parallel */
+static void
+_t2(decompress_strided_omp, Scalar, 1)(zfp_stream* stream, zfp_field* field)
+{
+  /* array metadata */
+  Scalar* data = (Scalar*)field->data;
+  uint nx = field->nx;
+  int sx = field->sx ? field->sx : 1;
+
+  /* number of omp threads, blocks, and chunks */
+  uint threads = thread_count_omp(stream);
+  uint blocks = (nx + 3) / 4;
+  uint chunks = chunk_count_omp(stream, blocks, threads);
+
+  /* allocate per-thread streams */
+  bitstream** bs = decompress_init_par(stream, &chunks, blocks);
+
+  /* decompress chunks of blocks in parallel, assigning chunks dynamically */
+  int chunk;
+  timer_reset_omp(stream, threads);
+  #pragma omp parallel for num_threads(threads) schedule(dynamic, 1)
+  for (chunk = 0; chunk < (int)chunks; chunk++) {
+    double start = timer_start_omp(stream);
+    /* determine range of block indices in this chunk */
+    uint bmin = chunk_offset(blocks, chunks, chunk + 0);
+    uint bmax = chunk_offset(blocks, chunks, chunk + 1);
+    uint block;
+    /* set up thread-local bit stream */
+    zfp_stream s = *stream;
+    zfp_stream_set_bit_stream(&s, bs[chunk]);
+    /* decompress sequence of blocks */
+    for (block = bmin; block < bmax; block++) {
+      /* determine block origin x within array */
+      Scalar* p = data;
+      uint x = 4 * block;
+      p += sx * (ptrdiff_t)x;
+      /* decompress partial or full block */
+      if (nx - x < 4)
+        _t2(zfp_decode_partial_block_strided, Scalar, 1)(&s, p, MIN(nx - x, 4u), sx);
+      else
+        _t2(zfp_decode_block_strided, Scalar, 1)(&s, p, sx);
+    }
+    timer_stop_omp(stream, start);
+  }
+
+  /* position stream at end of last chunk */
+  decompress_finish_par(stream, bs, chunks);
+}
+
+/* decompress 2d strided array in parallel */
+static void
+_t2(decompress_strided_omp, Scalar, 2)(zfp_stream* stream, zfp_field* field)
+{
+  /* array metadata */
+  Scalar* data = (Scalar*)field->data;
+  uint nx = field->nx;
+  uint ny = field->ny;
+  int sx = field->sx ? field->sx : 1;
+  int sy = field->sy ? field->sy : nx;
+
+  /* number of omp threads, blocks, and chunks */
+  uint threads = thread_count_omp(stream);
+  uint bx = (nx + 3) / 4;
+  uint by = (ny + 3) / 4;
+  uint blocks = bx * by;
+  uint chunks = chunk_count_omp(stream, blocks, threads);
+
+  /* allocate per-thread streams */
+  bitstream** bs = decompress_init_par(stream, &chunks, blocks);
+
+  /* decompress chunks of blocks in parallel, assigning chunks dynamically */
+  int chunk;
+  timer_reset_omp(stream, threads);
+  #pragma omp parallel for num_threads(threads) schedule(dynamic, 1)
+  for (chunk = 0; chunk < (int)chunks; chunk++) {
+    double start = timer_start_omp(stream);
+    /* determine range of block indices in this chunk */
+    uint bmin = chunk_offset(blocks, chunks, chunk + 0);
+    uint bmax = chunk_offset(blocks, chunks, chunk + 1);
+    uint block;
+    /* set up thread-local bit stream */
+    zfp_stream s = *stream;
+    zfp_stream_set_bit_stream(&s, bs[chunk]);
+    /* decompress sequence of blocks */
+    for (block = bmin; block < bmax; block++) {
+      /* determine block origin (x, y) within array */
+      Scalar* p = data;
+      uint b = block;
+      uint x, y;
+      x = 4 * (b % bx); b /= bx;
+      y = 4 * b;
+      p += sx * (ptrdiff_t)x + sy * (ptrdiff_t)y;
+      /* decompress partial or full block */
+      if (nx - x < 4 || ny - y < 4)
+        _t2(zfp_decode_partial_block_strided, Scalar, 2)(&s, p, MIN(nx - x, 4u), MIN(ny - y, 4u), sx, sy);
+      else
+        _t2(zfp_decode_block_strided, Scalar, 2)(&s, p, sx, sy);
+    }
+    timer_stop_omp(stream, start);
+  }
+
+  /* position stream at end of last chunk */
+  decompress_finish_par(stream, bs, chunks);
+}
+
+/* decompress 3d strided array in parallel */
+static void
+_t2(decompress_strided_omp, Scalar, 3)(zfp_stream* stream, zfp_field* field)
+{
+  /* array metadata */
+  Scalar* data = (Scalar*)field->data;
+  uint nx = field->nx;
+  uint ny = field->ny;
+  uint nz = field->nz;
+  int sx = field->sx ? field->sx : 1;
+  int sy = field->sy ? field->sy : nx;
+  int sz = field->sz ? field->sz : (ptrdiff_t)nx * ny;
+
+  /* number of omp threads, blocks, and chunks */
+  uint threads = thread_count_omp(stream);
+  uint bx = (nx + 3) / 4;
+  uint by = (ny + 3) / 4;
+  uint bz = (nz + 3) / 4;
+  uint blocks = bx * by * bz;
+  uint chunks = chunk_count_omp(stream, blocks, threads);
+
+  /* allocate per-thread streams */
+  bitstream** bs = decompress_init_par(stream, &chunks, blocks);
+
+  /* decompress chunks of blocks in parallel, assigning chunks dynamically */
+  int chunk;
+  timer_reset_omp(stream, threads);
+  #pragma omp parallel for num_threads(threads) schedule(dynamic, 1)
+  for (chunk = 0; chunk < (int)chunks; chunk++) {
+    double start = timer_start_omp(stream);
+    /* determine range of block indices in this chunk */
+    uint bmin = chunk_offset(blocks, chunks, chunk + 0);
+    uint bmax = chunk_offset(blocks, chunks, chunk + 1);
+    uint block;
+    /* set up thread-local bit stream */
+    zfp_stream s = *stream;
+    zfp_stream_set_bit_stream(&s, bs[chunk]);
+    /* decompress sequence of blocks */
+    for (block = bmin; block < bmax; block++) {
+      /* determine block origin (x, y, z) within array */
+      Scalar* p = data;
+      uint b = block;
+      uint x, y, z;
+      x = 4 * (b % bx); b /= bx;
+      y = 4 * (b % by); b /= by;
+      z = 4 * b;
+      p += sx * (ptrdiff_t)x + sy * (ptrdiff_t)y + sz * (ptrdiff_t)z;
+      /* decompress partial or full block */
+      if (nx - x < 4 || ny - y < 4 || nz - z < 4)
+        _t2(zfp_decode_partial_block_strided, Scalar, 3)(&s, p, MIN(nx - x, 4u), MIN(ny - y, 4u), MIN(nz - z, 4u), sx, sy, sz);
+      else
+        _t2(zfp_decode_block_strided, Scalar, 3)(&s, p, sx, sy, sz);
+    }
+    timer_stop_omp(stream, start);
+  }
+
+  /* position stream at end of last chunk */
+  decompress_finish_par(stream, bs, chunks);
+}
+
+/* decompress 4d strided array in parallel */
+static void
+_t2(decompress_strided_omp, Scalar, 4)(zfp_stream* stream, zfp_field* field)
+{
+  /* array metadata */
+  Scalar* data = (Scalar*)field->data;
+  uint nx = field->nx;
+  uint ny = field->ny;
+  uint nz = field->nz;
+  uint nw = field->nw;
+  int sx = field->sx ? field->sx : 1;
+  int sy = field->sy ? field->sy : nx;
+  int sz = field->sz ? field->sz : (ptrdiff_t)nx * ny;
+  int sw = field->sw ? field->sw : (ptrdiff_t)nx * ny * nz;
+
+  /* number of omp threads, blocks, and chunks */
+  uint threads = thread_count_omp(stream);
+  uint bx = (nx + 3) / 4;
+  uint by = (ny + 3) / 4;
+  uint bz = (nz + 3) / 4;
+  uint bw = (nw + 3) / 4;
+  uint blocks = bx * by * bz * bw;
+  uint chunks = chunk_count_omp(stream, blocks, threads);
+
+  /* allocate per-thread streams */
+  bitstream** bs = decompress_init_par(stream, &chunks, blocks);
+
+  /* decompress chunks of blocks in parallel, assigning chunks dynamically */
+  int chunk;
+  timer_reset_omp(stream, threads);
+  #pragma omp parallel for num_threads(threads) schedule(dynamic, 1)
+  for (chunk = 0; chunk < (int)chunks; chunk++) {
+    double start = timer_start_omp(stream);
+    /* determine range of block indices in this chunk */
+    uint bmin = chunk_offset(blocks, chunks, chunk + 0);
+    uint bmax = chunk_offset(blocks, chunks, chunk + 1);
+    uint block;
+    /* set up thread-local bit stream */
+    zfp_stream s = *stream;
+    zfp_stream_set_bit_stream(&s, bs[chunk]);
+    /* decompress sequence of blocks */
+    for (block = bmin; block < bmax; block++) {
+      /* determine block origin (x, y, z, w) within array */
+      Scalar* p = data;
+      uint b = block;
+      uint x, y, z, w;
+      x = 4 * (b % bx); b /= bx;
+      y = 4 * (b % by); b /= by;
+      z = 4 * (b % bz); b /= bz;
+      w = 4 * b;
+      p += sx * (ptrdiff_t)x + sy * (ptrdiff_t)y + sz * (ptrdiff_t)z + sw * (ptrdiff_t)w;
+      /* decompress partial or full block */
+      if (nx - x < 4 || ny - y < 4 || nz - z < 4 || nw - w < 4)
+        _t2(zfp_decode_partial_block_strided, Scalar, 4)(&s, p, MIN(nx - x, 4u), MIN(ny - y, 4u), MIN(nz - z, 4u), MIN(nw - w, 4u), sx, sy, sz, sw);
+      else
+        _t2(zfp_decode_block_strided, Scalar, 4)(&s, p, sx, sy, sz, sw);
+    }
+    timer_stop_omp(stream, start);
+  }
+
+  /* position stream at end of last chunk */
+  decompress_finish_par(stream, bs, chunks);
+}
+
+#endif
@@ -0,0 +1,181 @@
+#ifndef ZFP_SIMD_H
+#define ZFP_SIMD_H
+
+/*
+** SIMD paths for the non-reversible lifting transforms.  Groups of vectors
+** are lifted in lockstep with one vector per register lane, either when the
+** same element of consecutive vectors is contiguous (vector stride t = 1) or,
+** after an in-register transpose, when the elements of each vector are
+** contiguous (s = 1, t = 4).  The widest instruction set enabled at compile
+** time is used, falling back to narrower ones for the remaining vectors; the
+** AVX2 and AVX-512 kernels are compiled with the corresponding flags.  The
+** caller lifts any vectors not handled here using scalar code.  All paths
+** produce results bit-for-bit identical to the scalar transform.
+*/
+
+#if defined(__SSE2__) && !defined(ZFP_WITHOUT_SIMD)
+
+#include <immintrin.h>
+
+#define ZFP_SIMD 1
+
+/* arithmetic right shift by one; 64-bit shifts require AVX-512 */
+#define simd_sra32x4(v) _mm_srai_epi32(v, 1)
+#define simd_sra32x8(v) _mm256_srai_epi32(v, 1)
+#define simd_sra32x16(v) _mm512_srai_epi32(v, 1)
+#ifdef __AVX512VL__
+  #define simd_sra64x2(v) _mm_srai_epi64(v, 1)
+  #define simd_sra64x4(v) _mm256_srai_epi64(v, 1)
+#else
+  #define simd_sra64x2(v) _mm_or_si128(_mm_srli_epi64(v, 1), _mm_and_si128(v, _mm_slli_epi64(_mm_set1_epi32(-1), 63)))
+  #define simd_sra64x4(v) _mm256_or_si256(_mm256_srli_epi64(v, 1), _mm256_and_si256(v, _mm256_slli_epi64(_mm256_set1_epi32(-1), 63)))
+#endif
+#define simd_sra64x8(v) _mm512_srai_epi64(v, 1)
+
+/* forward lifting of registers x, y, z, w (see fwd_lift) */
+#define SIMD_FWD_LIFT(add, sub, sra) \
+  x = add(x, w); x = sra(x); w = sub(w, x); \
+  z = add(z, y); z = sra(z); y = sub(y, z); \
+  x = add(x, z); x = sra(x); z = sub(z, x); \
+  w = add(w, y); w = sra(w); y = sub(y, w); \
+  w = add(w, sra(y)); y = sub(y, sra(w));
+
+/* inverse lifting of registers x, y, z, w (see inv_lift) */
+#define SIMD_INV_LIFT(add, sub, sra) \
+  y = add(y, sra(w)); w = sub(w, sra(y)); \
+  y = add(y, w); w = add(w, w); w = sub(w, y); \
+  z = add(z, x); x = add(x, x); x = sub(x, z); \
+  y = add(y, z); z = add(z, z); z = sub(z, y); \
+  w = add(w, x); x = add(x, x); x = sub(x, w);
+
+/* no transposition needed */
+#define SIMD_IDENTITY
+
+/* lift groups of m vectors whose lanes are contiguous (t = 1) */
+#define SIMD_LIFT_LANES(V, m, load, store, transpose, lift) \
+  for (; i + (m) <= n; i += (m)) { \
+    V x = load((V*)(p + 0 * s + i)); \
+    V y = load((V*)(p + 1 * s + i)); \
+    V z = load((V*)(p + 2 * s + i)); \
+    V w = load((V*)(p + 3 * s + i)); \
+    lift \
+    store((V*)(p + 0 * s + i), x); \
+    store((V*)(p + 1 * s + i), y); \
+    store((V*)(p + 2 * s + i), z); \
+    store((V*)(p + 3 * s + i), w); \
+  }
+
+/* transpose 4x4 blocks of 32-bit integers within each 128-bit lane */
+#define SIMD_TRANSPOSE32(pre) { \
+    t0 = pre##_unpacklo_epi32(x, y); \
+    t1 = pre##_unpacklo_epi32(z, w); \
+    t2 = pre##_unpackhi_epi32(x, y); \
+    t3 = pre##_unpackhi_epi32(z, w); \
+    x = pre##_unpacklo_epi64(t0, t1); \
+    y = pre##_unpackhi_epi64(t0, t1); \
+    z = pre##_unpacklo_epi64(t2, t3); \
+    w = pre##_unpackhi_epi64(t2, t3); \
+  }
+
+/* transpose 4x4 block of 64-bit integers held in four 256-bit registers */
+#define SIMD_TRANSPOSE64 { \
+    t0 = _mm256_unpacklo_epi64(x, y); \
+    t1 = _mm256_unpackhi_epi64(x, y); \
+    t2 = _mm256_unpacklo_epi64(z, w); \
+    t3 = _mm256_unpackhi_epi64(z, w); \
+    x = _mm256_permute2x128_si256(t0, t2, 0x20); \
+    y = _mm256_permute2x128_si256(t1, t3, 0x20); \
+    z = _mm256_permute2x128_si256(t0, t2, 0x31); \
+    w = _mm256_permute2x128_si256(t1, t3, 0x31); \
+  }
+
+/* lift groups of 4 m contiguous values forming m contiguous vectors (s = 1) */
+#define SIMD_LIFT_VECTORS(V, m, load, store, transpose, lift) \
+  for (; i + (m) <= n; i += (m)) { \
+    V x = load((V*)(p + 4 * i + 0 * (m))); \
+    V y = load((V*)(p + 4 * i + 1 * (m))); \
+    V z = load((V*)(p + 4 * i + 2 * (m))); \
+    V w = load((V*)(p + 4 * i + 3 * (m))); \
+    V t0, t1, t2, t3; \
+    transpose \
+    lift \
+    transpose \
+    store((V*)(p + 4 * i + 0 * (m)), x); \
+    store((V*)(p + 4 * i + 1 * (m)), y); \
+    store((V*)(p + 4 * i + 2 * (m)), z); \
+    store((V*)(p + 4 * i + 3 * (m)), w); \
+  }
+
+/* lift leading vectors of 32-bit integers; return number of vectors lifted */
+#define SIMD_LIFT32(lift) \
+  uint i = 0; \
+  if (t == 1) { \
+    SIMD_LIFT32_512(SIMD_LIFT_LANES, SIMD_IDENTITY, lift) \
+    SIMD_LIFT32_256(SIMD_LIFT_LANES, SIMD_IDENTITY, lift) \
+    SIMD_LIFT_LANES(__m128i, 4, _mm_loadu_si128, _mm_storeu_si128, SIMD_IDENTITY, lift(_mm_add_epi32, _mm_sub_epi32, simd_sra32x4)) \
+  } \
+  else if (s == 1 && t == 4) { \
+    SIMD_LIFT32_512(SIMD_LIFT_VECTORS, SIMD_TRANSPOSE32(_mm512), lift) \
+    SIMD_LIFT32_256(SIMD_LIFT_VECTORS, SIMD_TRANSPOSE32(_mm256), lift) \
+    SIMD_LIFT_VECTORS(__m128i, 4, _mm_loadu_si128, _mm_storeu_si128, SIMD_TRANSPOSE32(_mm), lift(_mm_add_epi32, _mm_sub_epi32, simd_sra32x4)) \
+  } \
+  return i;
+
+/* lift leading vectors of 64-bit integers; return number of vectors lifted */
+#define SIMD_LIFT64(lift) \
+  uint i = 0; \
+  if (t == 1) { \
+    SIMD_LIFT64_512(lift) \
+    SIMD_LIFT64_256(SIMD_LIFT_LANES, SIMD_IDENTITY, lift) \
+    SIMD_LIFT_LANES(__m128i, 2, _mm_loadu_si128, _mm_storeu_si128, SIMD_IDENTITY, lift(_mm_add_epi64, _mm_sub_epi64, simd_sra64x2)) \
+  } \
+  else if (s == 1 && t == 4) { \
+    SIMD_LIFT64_256(SIMD_LIFT_VECTORS, SIMD_TRANSPOSE64, lift) \
+  } \
+  return i;
+
+#ifdef __AVX512F__
+  #define SIMD_LIFT32_512(loop, transpose, lift) loop(__m512i, 16, _mm512_loadu_si512, _mm512_storeu_si512, transpose, lift(_mm512_add_epi32, _mm512_sub_epi32, simd_sra32x16))
+  #define SIMD_LIFT64_512(lift) SIMD_LIFT_LANES(__m512i, 8, _mm512_loadu_si512, _mm512_storeu_si512, SIMD_IDENTITY, lift(_mm512_add_epi64, _mm512_sub_epi64, simd_sra64x8))
+#else
+  #define SIMD_LIFT32_512(loop, transpose, lift)
+  #define SIMD_LIFT64_512(lift)
+#endif
+
+#ifdef __AVX2__
+  #define SIMD_LIFT32_256(loop, transpose, lift) loop(__m256i, 8, _mm256_loadu_si256, _mm256_storeu_si256, transpose, lift(_mm256_add_epi32, _mm256_sub_epi32, simd_sra32x8))
+  #define SIMD_LIFT64_256(loop, transpose, lift) loop(__m256i, 4, _mm256_loadu_si256, _mm256_storeu_si256, transpose, lift(_mm256_add_epi64, _mm256_sub_epi64, simd_sra64x4))
+#else
+  #define SIMD_LIFT32_256(loop, transpose, lift)
+  #define SIMD_LIFT64_256(loop, transpose, lift)
+#endif
+
+/* forward lifting of leading vectors (element stride s, vector stride t) */
+inline_ uint
+simd_fwd_lift_int32(int32* p, uint s, uint t, uint n)
+{
+  SIMD_LIFT32(SIMD_FWD_LIFT)
+}
+
+inline_ uint
+simd_fwd_lift_int64(int64* p, uint s, uint t, uint n)
+{
+  SIMD_LIFT64(SIMD_FWD_LIFT)
+}
+
+/* inverse lifting of leading vectors (element stride s, vector stride t) */
+inline_ uint
+simd_inv_lift_int32(int32* p, uint s, uint t, uint n)
+{
+  SIMD_LIFT32(SIMD_INV_LIFT)
+}
+
+inline_ uint
+simd_inv_lift_int64(int64* p, uint s, uint t, uint n)
+{
+  SIMD_LIFT64(SIMD_INV_LIFT)
+}
+
+#endif
+
+#endif
@@ -2,11 +2,18 @@
 #define TEMPLATE_H
 
 /* concatenation */
-#define _cat2(x, y)    x ## _ ## y
-#define _cat3(x, y, z) x ## _ ## y ## _ ## z
+#define _cat2(x, y)       x ## _ ## y
+#define _cat3(x, y, z)    x ## _ ## y ## _ ## z
+#define _cat4(x, y, z, w) x ## _ ## y ## _ ## z ## _ ## w
 
 /* 1- and 2-argument function templates */
 #define _t1(function, arg)        _cat2(function, arg)
-#define _t2(function, type, dims) _cat3(function, type, dims)
+#ifdef ZFP_KERNEL
+  /* codec built for one instruction set; suffix names with kernel */
+  #define _t2(function, type, dims) _t3(function, type, dims, ZFP_KERNEL)
+  #define _t3(function, type, dims, kernel) _cat4(function, type, dims, kernel)
+#else
+  #define _t2(function, type, dims) _cat3(function, type, dims)
+#endif
 
 #endif
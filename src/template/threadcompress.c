@@ -0,0 +1,10 @@
+#ifdef ZFP_WITH_THREADS
+
+/* compress 1d, 2d, 3d, or 4d strided array in parallel */
+static void
+_t1(compress_threads, Scalar)(zfp_stream* stream, const zfp_field* field)
+{
+  compress_par_threads(stream, field, _t1(compress_range, Scalar));
+}
+
+#endif
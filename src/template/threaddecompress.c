@@ -0,0 +1,10 @@
+#ifdef ZFP_WITH_THREADS
+
+/* decompress 1d, 2d, 3d, or 4d strided array in parallel */
+static void
+_t1(decompress_threads, Scalar)(zfp_stream* stream, zfp_field* field)
+{
+  decompress_par_threads(stream, field, _t1(decompress_range, Scalar));
+}
+
+#endif
@@ -4,6 +4,7 @@
 #define Int int64                          /* corresponding signed integer type */
 #define UInt uint64                        /* corresponding unsigned integer type */
 #define EBITS 11                           /* number of exponent bits */
+#define PBITS 6                            /* number of bits needed to encode precision */
 #define NBMASK UINT64C(0xaaaaaaaaaaaaaaaa) /* negabinary mask */
 
 #define FABS(x) fabs(x)
@@ -2,6 +2,7 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "zfp.h"
 #include "zfp/macros.h"
 #include "template/template.h"
@@ -31,10 +32,105 @@ type_precision(zfp_type type)
   }
 }
 
+/* maximum number of bits of one compressed block of given type */
+static uint
+block_maximum_bits(const zfp_stream* zfp, uint dims, zfp_type type)
+{
+  uint values = 1u << (2 * dims);
+  uint maxbits = 1;
+
+  switch (type) {
+    case zfp_type_float:
+      maxbits += 8;
+      break;
+    case zfp_type_double:
+      maxbits += 11;
+      break;
+    default:
+      break;
+  }
+  maxbits += values - 1 + values * MIN(zfp->maxprec, type_precision(type));
+  /* reversible mode also codes transform choice and precision */
+  if (zfp->minexp < ZFP_MIN_EXP)
+    maxbits += 1 + (type_precision(type) <= 32 ? 5 : 6);
+  maxbits = MIN(maxbits, zfp->maxbits);
+  maxbits = MAX(maxbits, zfp->minbits);
+  return maxbits;
+}
+
+/* round bit offset up to next stream word boundary */
+static size_t
+align_offset(size_t offset)
+{
+  return (offset + stream_word_bits - 1) / stream_word_bits * stream_word_bits;
+}
+
+/* is codec kernel built and supported by processor? */
+static int
+kernel_supported(zfp_kernel kernel)
+{
+  switch (kernel) {
+    case zfp_kernel_generic:
+      return 1;
+#ifdef ZFP_WITH_KERNELS
+    case zfp_kernel_avx2:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2");
+    case zfp_kernel_avx512:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx512f") &&
+             __builtin_cpu_supports("avx512bw") &&
+             __builtin_cpu_supports("avx512dq") &&
+             __builtin_cpu_supports("avx512vl");
+#endif
+    default:
+      return 0;
+  }
+}
+
+/* pointer to size of slowest varying dimension of field */
+static uint*
+slab_dimension(zfp_field* field)
+{
+  switch (zfp_field_dimensionality(field)) {
+    case 1:
+      return &field->nx;
+    case 2:
+      return &field->ny;
+    case 3:
+      return &field->nz;
+    case 4:
+      return &field->nw;
+    default:
+      return NULL;
+  }
+}
+
 /* shared code across template instances ------------------------------------*/
 
-#include "share/parallel.c"
 #include "share/omp.c"
+#include "share/profile.c"
+#include "share/parallel.c"
+#include "share/threads.c"
+
+/* number of bits of chunk offset index and padding, if any, for given policy */
+static size_t
+index_bits(const zfp_stream* zfp, size_t blocks)
+{
+  size_t chunks = 1;
+  if (!zfp->index)
+    return 0;
+#ifdef _OPENMP
+  if (zfp->exec.policy == zfp_exec_omp)
+    chunks = chunk_count_omp(zfp, (uint)blocks, thread_count_omp(zfp));
+#endif
+#ifdef ZFP_WITH_THREADS
+  if (zfp->exec.policy == zfp_exec_threads)
+    chunks = chunk_count_threads(zfp, (uint)blocks, thread_count_threads(zfp));
+#endif
+  /* aligned chunks may each be padded by up to one word */
+  return chunks * (ZFP_INDEX_BITS + (zfp->index == ZFP_INDEX_ALIGNED ? stream_word_bits : 0));
+}
 
 /* template instantiation of integer and float compressor -------------------*/
 
@@ -42,6 +138,9 @@ type_precision(zfp_type type)
 #include "template/compress.c"
 #include "template/decompress.c"
 #include "template/ompcompress.c"
+#include "template/ompdecompress.c"
+#include "template/threadcompress.c"
+#include "template/threaddecompress.c"
 #include "template/cudacompress.c"
 #include "template/cudadecompress.c"
 #undef Scalar
@@ -50,6 +149,9 @@ type_precision(zfp_type type)
 #include "template/compress.c"
 #include "template/decompress.c"
 #include "template/ompcompress.c"
+#include "template/ompdecompress.c"
+#include "template/threadcompress.c"
+#include "template/threaddecompress.c"
 #include "template/cudacompress.c"
 #include "template/cudadecompress.c"
 #undef Scalar
@@ -58,6 +160,9 @@ type_precision(zfp_type type)
 #include "template/compress.c"
 #include "template/decompress.c"
 #include "template/ompcompress.c"
+#include "template/ompdecompress.c"
+#include "template/threadcompress.c"
+#include "template/threaddecompress.c"
 #include "template/cudacompress.c"
 #include "template/cudadecompress.c"
 #undef Scalar
@@ -66,6 +171,9 @@ type_precision(zfp_type type)
 #include "template/compress.c"
 #include "template/decompress.c"
 #include "template/ompcompress.c"
+#include "template/ompdecompress.c"
+#include "template/threadcompress.c"
+#include "template/threaddecompress.c"
 #include "template/cudacompress.c"
 #include "template/cudadecompress.c"
 #undef Scalar
@@ -405,6 +513,13 @@ zfp_stream_open(bitstream* stream)
     zfp->maxprec = ZFP_MAX_PREC;
     zfp->minexp = ZFP_MIN_EXP;
     zfp->exec.policy = zfp_exec_serial;
+    zfp->index = 0;
+    /* select fastest codec kernel */
+    zfp->kernel = kernel_supported(zfp_kernel_avx512) ? zfp_kernel_avx512 :
+                  kernel_supported(zfp_kernel_avx2) ? zfp_kernel_avx2 :
+                  zfp_kernel_generic;
+    zfp->stats = NULL;
+    zfp->timings = NULL;
   }
   return zfp;
 }
@@ -438,14 +553,14 @@ zfp_stream_compression_mode(const zfp_stream* zfp)
   if (zfp->minbits == zfp->maxbits &&
       1 <= zfp->maxbits && zfp->maxbits <= ZFP_MAX_BITS &&
       zfp->maxprec >= ZFP_MAX_PREC &&
-      zfp->minexp <= ZFP_MIN_EXP)
+      zfp->minexp == ZFP_MIN_EXP)
     return zfp_mode_fixed_rate;
 
   /* fixed precision? */
   if (zfp->minbits <= ZFP_MIN_BITS &&
       zfp->maxbits >= ZFP_MAX_BITS &&
       zfp->maxprec >= 1 &&
-      zfp->minexp <= ZFP_MIN_EXP)
+      zfp->minexp == ZFP_MIN_EXP)
     return zfp_mode_fixed_precision;
 
   /* fixed accuracy? */
@@ -455,6 +570,13 @@ zfp_stream_compression_mode(const zfp_stream* zfp)
       ZFP_MIN_EXP <= zfp->minexp)
     return zfp_mode_fixed_accuracy;
 
+  /* reversible? */
+  if (zfp->minbits <= ZFP_MIN_BITS &&
+      zfp->maxbits >= ZFP_MAX_BITS &&
+      zfp->maxprec >= ZFP_MAX_PREC &&
+      zfp->minexp < ZFP_MIN_EXP)
+    return zfp_mode_reversible;
+
   return zfp_mode_expert;
 }
 
@@ -491,6 +613,12 @@ zfp_stream_mode(const zfp_stream* zfp)
         /* [2177, ZFP_MODE_SHORT_MAX=4094] */
         /* +1 because skipped 2176 */
         return (zfp->minexp - ZFP_MIN_EXP) + (2048 + 128 + 1);
+      else
+        break;
+
+    case zfp_mode_reversible:
+      /* returns 2176 */
+      return 2048 + 128;
 
     default:
       break;
@@ -523,6 +651,12 @@ zfp_stream_params(const zfp_stream* zfp, uint* minbits, uint* maxbits, uint* max
     *minexp = zfp->minexp;
 }
 
+int
+zfp_stream_index(const zfp_stream* zfp)
+{
+  return zfp->index;
+}
+
 size_t
 zfp_stream_compressed_size(const zfp_stream* zfp)
 {
@@ -538,27 +672,12 @@ zfp_stream_maximum_size(const zfp_stream* zfp, const zfp_field* field)
   uint mz = (MAX(field->nz, 1u) + 3) / 4;
   uint mw = (MAX(field->nw, 1u) + 3) / 4;
   size_t blocks = (size_t)mx * (size_t)my * (size_t)mz * (size_t)mw;
-  uint values = 1u << (2 * dims);
-  uint maxbits = 1;
+  uint maxbits;
 
-  if (!dims)
+  if (!dims || field->type == zfp_type_none)
     return 0;
-  switch (field->type) {
-    case zfp_type_none:
-      return 0;
-    case zfp_type_float:
-      maxbits += 8;
-      break;
-    case zfp_type_double:
-      maxbits += 11;
-      break;
-    default:
-      break;
-  }
-  maxbits += values - 1 + values * MIN(zfp->maxprec, type_precision(field->type));
-  maxbits = MIN(maxbits, zfp->maxbits);
-  maxbits = MAX(maxbits, zfp->minbits);
-  return ((ZFP_HEADER_MAX_BITS + blocks * maxbits + stream_word_bits - 1) & ~(stream_word_bits - 1)) / CHAR_BIT;
+  maxbits = block_maximum_bits(zfp, dims, field->type);
+  return ((ZFP_HEADER_MAX_BITS + index_bits(zfp, blocks) + blocks * maxbits + stream_word_bits - 1) & ~(stream_word_bits - 1)) / CHAR_BIT;
 }
 
 void
@@ -621,6 +740,15 @@ zfp_stream_set_accuracy(zfp_stream* zfp, double tolerance)
   return tolerance > 0 ? ldexp(1.0, emin) : 0;
 }
 
+void
+zfp_stream_set_reversible(zfp_stream* zfp)
+{
+  zfp->minbits = ZFP_MIN_BITS;
+  zfp->maxbits = ZFP_MAX_BITS;
+  zfp->maxprec = ZFP_MAX_PREC;
+  zfp->minexp = ZFP_MIN_EXP - 1;
+}
+
 zfp_mode
 zfp_stream_set_mode(zfp_stream* zfp, uint64 mode)
 {
@@ -628,7 +756,7 @@ zfp_stream_set_mode(zfp_stream* zfp, uint64 mode)
   int minexp;
 
   if (mode <= ZFP_MODE_SHORT_MAX) {
-    /* 12-bit (short) encoding of one of three modes */
+    /* 12-bit (short) encoding of one of four modes */
     if (mode < 2048) {
       /* fixed rate */
       minbits = maxbits = (uint)mode + 1;
@@ -642,6 +770,13 @@ zfp_stream_set_mode(zfp_stream* zfp, uint64 mode)
       maxprec = (uint)mode + 1 - (2048);
       minexp = ZFP_MIN_EXP;
     }
+    else if (mode == (2048 + 128)) {
+      /* reversible */
+      minbits = ZFP_MIN_BITS;
+      maxbits = ZFP_MAX_BITS;
+      maxprec = ZFP_MAX_PREC;
+      minexp = ZFP_MIN_EXP - 1;
+    }
     else {
       /* fixed accuracy */
       minbits = ZFP_MIN_BITS;
@@ -694,6 +829,13 @@ zfp_stream_rewind(zfp_stream* zfp)
   stream_rewind(zfp->stream);
 }
 
+int
+zfp_stream_set_index(zfp_stream* zfp, int layout)
+{
+  zfp->index = layout == ZFP_INDEX_ALIGNED ? ZFP_INDEX_ALIGNED : !!layout;
+  return 1;
+}
+
 /* public functions: execution policy -------------------------------------- */
 
 zfp_exec_policy
@@ -714,6 +856,18 @@ zfp_stream_omp_chunk_size(const zfp_stream* zfp)
   return zfp->exec.params.omp.chunk_size;
 }
 
+uint
+zfp_stream_thread_count(const zfp_stream* zfp)
+{
+  return zfp->exec.params.threads.threads;
+}
+
+uint
+zfp_stream_thread_chunk_size(const zfp_stream* zfp)
+{
+  return zfp->exec.params.threads.chunk_size;
+}
+
 int
 zfp_stream_set_execution(zfp_stream* zfp, zfp_exec_policy policy)
 {
@@ -733,6 +887,18 @@ zfp_stream_set_execution(zfp_stream* zfp, zfp_exec_policy policy)
       break;
 #else
       return 0;
+#endif
+    case zfp_exec_threads:
+#ifdef ZFP_WITH_THREADS
+      if (zfp->exec.policy != policy) {
+        zfp->exec.params.threads.threads = 0;
+        zfp->exec.params.threads.chunk_size = 0;
+        zfp->exec.params.threads.submit = NULL;
+        zfp->exec.params.threads.user = NULL;
+      }
+      break;
+#else
+      return 0;
 #endif
     default:
       return 0;
@@ -759,6 +925,86 @@ zfp_stream_set_omp_chunk_size(zfp_stream* zfp, uint chunk_size)
   return 1;
 }
 
+int
+zfp_stream_set_omp_timings(zfp_stream* zfp, double* seconds)
+{
+  if (!zfp_stream_set_execution(zfp, zfp_exec_omp))
+    return 0;
+  zfp->timings = seconds;
+  return 1;
+}
+
+const double*
+zfp_stream_omp_timings(const zfp_stream* zfp)
+{
+  return zfp->timings;
+}
+
+int
+zfp_stream_set_thread_count(zfp_stream* zfp, uint threads)
+{
+  if (!zfp_stream_set_execution(zfp, zfp_exec_threads))
+    return 0;
+  zfp->exec.params.threads.threads = threads;
+  return 1;
+}
+
+int
+zfp_stream_set_thread_chunk_size(zfp_stream* zfp, uint chunk_size)
+{
+  if (!zfp_stream_set_execution(zfp, zfp_exec_threads))
+    return 0;
+  zfp->exec.params.threads.chunk_size = chunk_size;
+  return 1;
+}
+
+int
+zfp_stream_set_thread_submit(zfp_stream* zfp, zfp_submit_func submit, void* user)
+{
+  if (!zfp_stream_set_execution(zfp, zfp_exec_threads))
+    return 0;
+  zfp->exec.params.threads.submit = submit;
+  zfp->exec.params.threads.user = user;
+  return 1;
+}
+
+/* public functions: codec kernel ------------------------------------------ */
+
+zfp_kernel
+zfp_stream_kernel(const zfp_stream* zfp)
+{
+  return zfp->kernel;
+}
+
+int
+zfp_stream_set_kernel(zfp_stream* zfp, zfp_kernel kernel)
+{
+  if (!kernel_supported(kernel))
+    return 0;
+  zfp->kernel = kernel;
+  return 1;
+}
+
+/* public functions: encoder statistics ------------------------------------ */
+
+zfp_stats*
+zfp_stream_stats(const zfp_stream* zfp)
+{
+  return zfp->stats;
+}
+
+int
+zfp_stream_set_stats(zfp_stream* zfp, zfp_stats* stats)
+{
+#ifdef ZFP_WITH_PROFILE
+  zfp->stats = stats;
+  return 1;
+#else
+  (void)zfp;
+  return !stats;
+#endif
+}
+
 /* public functions: utility functions --------------------------------------*/
 
 void
@@ -839,7 +1085,7 @@ size_t
 zfp_compress(zfp_stream* zfp, const zfp_field* field)
 {
   /* function table [execution][strided][dimensionality][scalar type] */
-  void (*ftable[3][2][4][4])(zfp_stream*, const zfp_field*) = {
+  void (*ftable[4][2][4][4])(zfp_stream*, const zfp_field*) = {
     /* serial */
     {{{ compress_int32_1,         compress_int64_1,         compress_float_1,         compress_double_1 },
       { compress_strided_int32_2, compress_strided_int64_2, compress_strided_float_2, compress_strided_double_2 },
@@ -877,6 +1123,20 @@ zfp_compress(zfp_stream* zfp, const zfp_field* field)
 #else
     {{{ NULL }}},
 #endif
+
+    /* thread pool */
+#ifdef ZFP_WITH_THREADS
+    {{{ compress_threads_int32, compress_threads_int64, compress_threads_float, compress_threads_double },
+      { compress_threads_int32, compress_threads_int64, compress_threads_float, compress_threads_double },
+      { compress_threads_int32, compress_threads_int64, compress_threads_float, compress_threads_double },
+      { compress_threads_int32, compress_threads_int64, compress_threads_float, compress_threads_double }},
+     {{ compress_threads_int32, compress_threads_int64, compress_threads_float, compress_threads_double },
+      { compress_threads_int32, compress_threads_int64, compress_threads_float, compress_threads_double },
+      { compress_threads_int32, compress_threads_int64, compress_threads_float, compress_threads_double },
+      { compress_threads_int32, compress_threads_int64, compress_threads_float, compress_threads_double }}},
+#else
+    {{{ NULL }}},
+#endif
   };
   uint exec = zfp->exec.policy;
   uint strided = zfp_field_stride(field, NULL);
@@ -898,6 +1158,21 @@ zfp_compress(zfp_stream* zfp, const zfp_field* field)
   if (!compress)
     return 0;
 
+  /* chunk index is written by parallel compressor; serial uses one chunk */
+  if (zfp->index)
+    switch (exec) {
+      case zfp_exec_serial:
+        stream_write_bits(zfp->stream, 1, ZFP_INDEX_BITS);
+        if (zfp->index == ZFP_INDEX_ALIGNED)
+          stream_flush(zfp->stream);
+        break;
+      case zfp_exec_omp:
+      case zfp_exec_threads:
+        break;
+      default:
+        return 0;
+    }
+
   /* compress field and align bit stream on word boundary */
   compress(zfp, field);
   stream_flush(zfp->stream);
@@ -905,11 +1180,33 @@ zfp_compress(zfp_stream* zfp, const zfp_field* field)
   return stream_size(zfp->stream);
 }
 
+/* serially decompress aligned chunks located via index */
+static void
+decompress_chunks(zfp_stream* zfp, zfp_field* field, uint chunks, void (*decompress)(zfp_stream*, zfp_field*, uint, uint))
+{
+  bitstream* s = zfp->stream;
+  size_t index = stream_rtell(s);
+  size_t base = align_offset(index + (size_t)(chunks - 1) * ZFP_INDEX_BITS);
+  uint blocks = field_blocks(field);
+  uint i;
+
+  for (i = 0; i < chunks; i++) {
+    /* skip padding that precedes chunk */
+    if (i) {
+      stream_rseek(s, index + (size_t)(i - 1) * ZFP_INDEX_BITS);
+      stream_rseek(s, base + (size_t)stream_read_bits(s, ZFP_INDEX_BITS));
+    }
+    else
+      stream_rseek(s, base);
+    decompress(zfp, field, chunk_offset(blocks, chunks, i + 0), chunk_offset(blocks, chunks, i + 1));
+  }
+}
+
 size_t
 zfp_decompress(zfp_stream* zfp, zfp_field* field)
 {
   /* function table [execution][strided][dimensionality][scalar type] */
-  void (*ftable[3][2][4][4])(zfp_stream*, zfp_field*) = {
+  void (*ftable[4][2][4][4])(zfp_stream*, zfp_field*) = {
     /* serial */
     {{{ decompress_int32_1,         decompress_int64_1,         decompress_float_1,         decompress_double_1 },
       { decompress_strided_int32_2, decompress_strided_int64_2, decompress_strided_float_2, decompress_strided_double_2 },
@@ -920,8 +1217,19 @@ zfp_decompress(zfp_stream* zfp, zfp_field* field)
       { decompress_strided_int32_3, decompress_strided_int64_3, decompress_strided_float_3, decompress_strided_double_3 },
       { decompress_strided_int32_4, decompress_strided_int64_4, decompress_strided_float_4, decompress_strided_double_4 }}},
 
-    /* OpenMP; not yet supported */
+    /* OpenMP */
+#ifdef _OPENMP
+    {{{ decompress_omp_int32_1,         decompress_omp_int64_1,         decompress_omp_float_1,         decompress_omp_double_1 },
+      { decompress_strided_omp_int32_2, decompress_strided_omp_int64_2, decompress_strided_omp_float_2, decompress_strided_omp_double_2 },
+      { decompress_strided_omp_int32_3, decompress_strided_omp_int64_3, decompress_strided_omp_float_3, decompress_strided_omp_double_3 },
+      { decompress_strided_omp_int32_4, decompress_strided_omp_int64_4, decompress_strided_omp_float_4, decompress_strided_omp_double_4 }},
+     {{ decompress_strided_omp_int32_1, decompress_strided_omp_int64_1, decompress_strided_omp_float_1, decompress_strided_omp_double_1 },
+      { decompress_strided_omp_int32_2, decompress_strided_omp_int64_2, decompress_strided_omp_float_2, decompress_strided_omp_double_2 },
+      { decompress_strided_omp_int32_3, decompress_strided_omp_int64_3, decompress_strided_omp_float_3, decompress_strided_omp_double_3 },
+      { decompress_strided_omp_int32_4, decompress_strided_omp_int64_4, decompress_strided_omp_float_4, decompress_strided_omp_double_4 }}},
+#else
     {{{ NULL }}},
+#endif
 
     /* CUDA */
 #ifdef ZFP_WITH_CUDA
@@ -936,11 +1244,33 @@ zfp_decompress(zfp_stream* zfp, zfp_field* field)
 #else
     {{{ NULL }}},
 #endif
+
+    /* thread pool */
+#ifdef ZFP_WITH_THREADS
+    {{{ decompress_threads_int32, decompress_threads_int64, decompress_threads_float, decompress_threads_double },
+      { decompress_threads_int32, decompress_threads_int64, decompress_threads_float, decompress_threads_double },
+      { decompress_threads_int32, decompress_threads_int64, decompress_threads_float, decompress_threads_double },
+      { decompress_threads_int32, decompress_threads_int64, decompress_threads_float, decompress_threads_double }},
+     {{ decompress_threads_int32, decompress_threads_int64, decompress_threads_float, decompress_threads_double },
+      { decompress_threads_int32, decompress_threads_int64, decompress_threads_float, decompress_threads_double },
+      { decompress_threads_int32, decompress_threads_int64, decompress_threads_float, decompress_threads_double },
+      { decompress_threads_int32, decompress_threads_int64, decompress_threads_float, decompress_threads_double }}},
+#else
+    {{{ NULL }}},
+#endif
+  };
+  /* serial decompressors of range of blocks [scalar type] */
+  void (*rtable[4])(zfp_stream*, zfp_field*, uint, uint) = {
+    decompress_range_int32,
+    decompress_range_int64,
+    decompress_range_float,
+    decompress_range_double,
   };
   uint exec = zfp->exec.policy;
   uint strided = zfp_field_stride(field, NULL);
   uint dims = zfp_field_dimensionality(field);
   uint type = field->type;
+  uint chunks = 0;
 
   switch (type) {
     case zfp_type_int32:
@@ -957,13 +1287,594 @@ zfp_decompress(zfp_stream* zfp, zfp_field* field)
   if (!decompress)
     return 0;
 
+  /* parallel decompression requires block offsets from index or fixed rate */
+  if ((exec == zfp_exec_omp || exec == zfp_exec_threads) && !zfp->index && zfp->minbits != zfp->maxbits)
+    return 0;
+
+  /* reject chunk counts that no valid index can hold, e.g. from a corrupt or
+     truncated stream, before any decompressor indexes chunks by them */
+  if (zfp->index) {
+    size_t offset = stream_rtell(zfp->stream);
+    uint64 count = stream_read_bits(zfp->stream, ZFP_INDEX_BITS);
+    stream_rseek(zfp->stream, offset);
+    if (!count || count > field_blocks(field))
+      return 0;
+  }
+
+  /* packed chunks are contiguous; serial decompressor ignores chunk offsets */
+  if (zfp->index)
+    switch (exec) {
+      case zfp_exec_serial:
+        chunks = (uint)stream_read_bits(zfp->stream, ZFP_INDEX_BITS);
+        if (zfp->index != ZFP_INDEX_ALIGNED) {
+          while (chunks-- > 1)
+            stream_skip(zfp->stream, ZFP_INDEX_BITS);
+          chunks = 0;
+        }
+        break;
+      case zfp_exec_omp:
+      case zfp_exec_threads:
+        break;
+      default:
+        return 0;
+    }
+
   /* decompress field and align bit stream on word boundary */
-  decompress(zfp, field);
+  if (chunks)
+    decompress_chunks(zfp, field, chunks, rtable[type - zfp_type_int32]);
+  else
+    decompress(zfp, field);
+  stream_align(zfp->stream);
+
+  return stream_size(zfp->stream);
+}
+
+size_t
+zfp_decompress_region(zfp_stream* zfp, zfp_field* field, uint x0, uint y0, uint z0, uint nx, uint ny, uint nz)
+{
+  /* function table [scalar type] */
+  void (*ftable[4])(zfp_stream*, zfp_field*, uint, uint, uint, uint, uint, uint) = {
+    decompress_region_int32,
+    decompress_region_int64,
+    decompress_region_float,
+    decompress_region_double,
+  };
+  uint dims = zfp_field_dimensionality(field);
+  uint type = field->type;
+
+  switch (type) {
+    case zfp_type_int32:
+    case zfp_type_int64:
+    case zfp_type_float:
+    case zfp_type_double:
+      break;
+    default:
+      return 0;
+  }
+
+  /* ignore coordinates beyond field dimensionality */
+  switch (dims) {
+    case 1:
+      y0 = 0;
+      ny = 1;
+      /* FALLTHROUGH */
+    case 2:
+      z0 = 0;
+      nz = 1;
+      /* FALLTHROUGH */
+    case 3:
+      break;
+    default:
+      return 0;
+  }
+
+  /* box must be nonempty and lie within field */
+  if (!nx || !ny || !nz)
+    return 0;
+  if (x0 + nx < x0 || x0 + nx > field->nx)
+    return 0;
+  if (dims > 1 && (y0 + ny < y0 || y0 + ny > field->ny))
+    return 0;
+  if (dims > 2 && (z0 + nz < z0 || z0 + nz > field->nz))
+    return 0;
+
+  /* decompress intersecting blocks and align bit stream on word boundary */
+  ftable[type - zfp_type_int32](zfp, field, x0, y0, z0, nx, ny, nz);
   stream_align(zfp->stream);
 
   return stream_size(zfp->stream);
 }
 
+/* bit offset of layer of progressive layout relative to first layer */
+static size_t
+progressive_layer(uint blocks, size_t layer)
+{
+  return layer * stream_word_bits * blocks;
+}
+
+size_t
+zfp_compress_progressive(zfp_stream* zfp, const zfp_field* field)
+{
+  /* function table [scalar type] */
+  void (*ftable[4])(zfp_stream*, const zfp_field*, uint, uint) = {
+    compress_range_int32,
+    compress_range_int64,
+    compress_range_float,
+    compress_range_double,
+  };
+  uint dims = zfp_field_dimensionality(field);
+  uint type = field->type;
+  uint blocks = field_blocks(field);
+  bitstream* dst = zfp->stream;
+  zfp_stream s = *zfp;
+  size_t size, base, offset;
+  void* buffer;
+  uint b;
+
+  switch (type) {
+    case zfp_type_int32:
+    case zfp_type_int64:
+    case zfp_type_float:
+    case zfp_type_double:
+      break;
+    default:
+      return 0;
+  }
+  if (dims < 1 || dims > 4 || zfp->minbits != zfp->maxbits)
+    return 0;
+
+  /* buffer holds one compressed block */
+  size = align_offset(zfp->maxbits) / CHAR_BIT;
+  buffer = malloc(size);
+  if (!buffer)
+    return 0;
+  s.stream = stream_open(buffer, size);
+
+  /* layers begin on word boundary */
+  stream_flush(dst);
+  base = stream_wtell(dst);
+
+  /* compress one block at a time and scatter its slices */
+  for (b = 0; b < blocks; b++) {
+    stream_rewind(s.stream);
+    ftable[type - zfp_type_int32](&s, field, b, b + 1);
+    stream_flush(s.stream);
+    stream_rewind(s.stream);
+    for (offset = 0; offset < zfp->maxbits; offset += stream_word_bits) {
+      uint n = (uint)MIN(zfp->maxbits - offset, (size_t)stream_word_bits);
+      stream_wseek(dst, base + progressive_layer(blocks, offset / stream_word_bits) + (size_t)b * n);
+      stream_copy(dst, s.stream, n);
+      stream_flush(dst);
+    }
+  }
+  stream_close(s.stream);
+  free(buffer);
+
+  /* align bit stream on word boundary */
+  stream_wseek(dst, base + (size_t)blocks * zfp->maxbits);
+  stream_flush(dst);
+
+  return stream_size(dst);
+}
+
+size_t
+zfp_decompress_progressive(zfp_stream* zfp, zfp_field* field, size_t bytes)
+{
+  /* function table [scalar type] */
+  void (*ftable[4])(zfp_stream*, zfp_field*, uint, uint) = {
+    decompress_range_int32,
+    decompress_range_int64,
+    decompress_range_float,
+    decompress_range_double,
+  };
+  uint dims = zfp_field_dimensionality(field);
+  uint type = field->type;
+  uint blocks = field_blocks(field);
+  bitstream* src = zfp->stream;
+  zfp_stream s = *zfp;
+  size_t size, base, end, offset;
+  uint ebits = 0;
+  void* buffer;
+  uint b;
+
+  switch (type) {
+    case zfp_type_int32:
+    case zfp_type_int64:
+      break;
+    case zfp_type_float:
+      ebits = 1 + 8;
+      break;
+    case zfp_type_double:
+      ebits = 1 + 11;
+      break;
+    default:
+      return 0;
+  }
+  if (dims < 1 || dims > 4 || zfp->minbits != zfp->maxbits)
+    return 0;
+
+  /* buffer holds one compressed block */
+  size = align_offset(zfp->maxbits) / CHAR_BIT;
+  buffer = malloc(size);
+  if (!buffer)
+    return 0;
+  s.stream = stream_open(buffer, size);
+
+  /* read no more than budget */
+  stream_align(src);
+  base = stream_rtell(src);
+  end = base + MIN((size_t)blocks * zfp->maxbits, CHAR_BIT * bytes);
+
+  /* gather available slices of one block at a time and decompress it */
+  for (b = 0; b < blocks; b++) {
+    uint bits = 0;
+    memset(buffer, 0, size);
+    stream_rewind(s.stream);
+    for (offset = 0; offset < zfp->maxbits; offset += stream_word_bits) {
+      uint n = (uint)MIN(zfp->maxbits - offset, (size_t)stream_word_bits);
+      size_t pos = base + progressive_layer(blocks, offset / stream_word_bits) + (size_t)b * n;
+      if (pos >= end)
+        break;
+      n = (uint)MIN((size_t)n, end - pos);
+      stream_rseek(src, pos);
+      stream_copy(s.stream, src, n);
+      bits += n;
+    }
+    stream_flush(s.stream);
+    stream_rewind(s.stream);
+    /* a floating-point block without its full exponent is zero */
+    if (bits < ebits) {
+      memset(buffer, 0, size);
+      bits = 0;
+    }
+    s.minbits = s.maxbits = bits;
+    ftable[type - zfp_type_int32](&s, field, b, b + 1);
+  }
+  stream_close(s.stream);
+  free(buffer);
+
+  /* align bit stream on word boundary */
+  stream_rseek(src, end);
+  stream_align(src);
+
+  return stream_size(src);
+}
+
+/* public functions: streaming compression --------------------------------- */
+
+struct zfp_slab_writer {
+  zfp_stream zfp;       /* compression parameters and slab bit stream */
+  zfp_field field;      /* field metadata */
+  zfp_write_func write; /* sink of compressed data */
+  void* user;           /* user data passed to sink */
+  uint layers;          /* number of layers compressed so far */
+  size_t bytes;         /* number of bytes written so far */
+  /* serial compressor of one slab */
+  void (*compress)(zfp_stream*, const zfp_field*);
+};
+
+/* write all complete words of compressed data and move partial word to front */
+static int
+slab_writer_drain(zfp_slab_writer* writer)
+{
+  bitstream* stream = writer->zfp.stream;
+  uchar* data = (uchar*)stream_data(stream);
+  size_t bits = stream_wtell(stream);
+  size_t size = bits / stream_word_bits * stream_word_bits / CHAR_BIT;
+  stream_flush(stream);
+  if (size) {
+    if (writer->write(writer->user, data, size) != size)
+      return 0;
+    writer->bytes += size;
+    memcpy(data, data + size, stream_word_bits / CHAR_BIT);
+  }
+  stream_rewind(stream);
+  stream_wseek(stream, bits % stream_word_bits);
+  return 1;
+}
+
+zfp_slab_writer*
+zfp_slab_writer_open(zfp_stream* zfp, const zfp_field* field, uint mask, zfp_write_func write, void* user)
+{
+  /* function table [dimensionality][scalar type] */
+  void (*ftable[4][4])(zfp_stream*, const zfp_field*) = {
+    { compress_strided_int32_1, compress_strided_int64_1, compress_strided_float_1, compress_strided_double_1 },
+    { compress_strided_int32_2, compress_strided_int64_2, compress_strided_float_2, compress_strided_double_2 },
+    { compress_strided_int32_3, compress_strided_int64_3, compress_strided_float_3, compress_strided_double_3 },
+    { compress_strided_int32_4, compress_strided_int64_4, compress_strided_float_4, compress_strided_double_4 },
+  };
+  uint dims = zfp_field_dimensionality(field);
+  uint type = field->type;
+  zfp_slab_writer* writer;
+  zfp_field slab;
+  size_t size;
+  void* buffer;
+
+  switch (type) {
+    case zfp_type_int32:
+    case zfp_type_int64:
+    case zfp_type_float:
+    case zfp_type_double:
+      break;
+    default:
+      return NULL;
+  }
+  if (dims < 1 || dims > 4)
+    return NULL;
+
+  /* buffer holds one compressed slab plus header and partial word */
+  slab = *field;
+  *slab_dimension(&slab) = MIN(*slab_dimension(&slab), 4u);
+  size = zfp_stream_maximum_size(zfp, &slab) + stream_word_bits / CHAR_BIT;
+  writer = (zfp_slab_writer*)malloc(sizeof(zfp_slab_writer));
+  buffer = malloc(size);
+  if (!writer || !buffer) {
+    free(buffer);
+    free(writer);
+    return NULL;
+  }
+  writer->zfp = *zfp;
+  writer->zfp.stream = stream_open(buffer, size);
+  writer->field = *field;
+  writer->compress = ftable[dims - 1][type - zfp_type_int32];
+  writer->write = write;
+  writer->user = user;
+  writer->layers = 0;
+  writer->bytes = 0;
+
+  /* emit optional header and single-chunk index */
+  zfp_write_header(&writer->zfp, field, mask);
+  if (zfp->index) {
+    stream_write_bits(writer->zfp.stream, 1, ZFP_INDEX_BITS);
+    if (zfp->index == ZFP_INDEX_ALIGNED)
+      stream_flush(writer->zfp.stream);
+  }
+
+  return writer;
+}
+
+int
+zfp_slab_writer_append(zfp_slab_writer* writer, const void* data)
+{
+  zfp_field slab = writer->field;
+  uint* n = slab_dimension(&slab);
+
+  /* reject slabs beyond end of field */
+  if (writer->layers >= *n)
+    return 0;
+
+  /* compress up to four layers and write completed words */
+  *n = MIN(*n - writer->layers, 4u);
+  slab.data = (void*)data;
+  writer->compress(&writer->zfp, &slab);
+  writer->layers += *n;
+
+  return slab_writer_drain(writer);
+}
+
+size_t
+zfp_slab_writer_close(zfp_slab_writer* writer)
+{
+  bitstream* stream = writer->zfp.stream;
+  size_t bytes = 0;
+
+  /* write final partial word if all slabs were compressed */
+  if (writer->layers == *slab_dimension(&writer->field)) {
+    size_t size;
+    stream_flush(stream);
+    size = stream_size(stream);
+    if (writer->write(writer->user, stream_data(stream), size) == size)
+      bytes = writer->bytes + size;
+  }
+
+  free(stream_data(stream));
+  stream_close(stream);
+  free(writer);
+
+  return bytes;
+}
+
+/* public functions: streaming decompression ------------------------------- */
+
+struct zfp_slab_reader {
+  zfp_stream zfp;      /* decompression parameters and buffer bit stream */
+  zfp_field field;     /* field metadata */
+  zfp_read_func read;  /* source of compressed data */
+  void* user;          /* user data passed to source */
+  uchar* buffer;       /* buffered compressed data */
+  size_t capacity;     /* buffer size in bytes */
+  size_t size;         /* number of bytes buffered */
+  size_t offset;       /* number of bytes consumed before start of buffer */
+  uint layers;         /* number of layers decompressed so far */
+  /* serial decompressor of one slab */
+  void (*decompress)(zfp_stream*, zfp_field*);
+};
+
+/* grow buffer to hold at least capacity bytes */
+static int
+slab_reader_reserve(zfp_slab_reader* reader, size_t capacity)
+{
+  size_t bits = reader->zfp.stream ? stream_rtell(reader->zfp.stream) : 0;
+  uchar* buffer;
+  capacity = (capacity + stream_word_bits / CHAR_BIT - 1) & ~(stream_word_bits / CHAR_BIT - 1);
+  if (capacity <= reader->capacity)
+    return 1;
+  buffer = (uchar*)realloc(reader->buffer, capacity);
+  if (!buffer)
+    return 0;
+  reader->buffer = buffer;
+  reader->capacity = capacity;
+  stream_close(reader->zfp.stream);
+  reader->zfp.stream = stream_open(buffer, capacity);
+  stream_rseek(reader->zfp.stream, bits);
+  return 1;
+}
+
+/* discard consumed words and refill buffer from source */
+static void
+slab_reader_fill(zfp_slab_reader* reader)
+{
+  bitstream* stream = reader->zfp.stream;
+  size_t bits = stream_rtell(stream);
+  size_t shift = MIN(bits / stream_word_bits * stream_word_bits / CHAR_BIT, reader->size);
+  size_t n;
+  memmove(reader->buffer, reader->buffer + shift, reader->size - shift);
+  reader->size -= shift;
+  reader->offset += shift;
+  while (reader->size < reader->capacity && (n = reader->read(reader->user, reader->buffer + reader->size, reader->capacity - reader->size)) != 0)
+    reader->size += n;
+  /* pad truncated input with zeros */
+  memset(reader->buffer + reader->size, 0, reader->capacity - reader->size);
+  stream_rseek(stream, bits - CHAR_BIT * shift);
+}
+
+/* skip over given number of bits of input */
+static int
+slab_reader_skip(zfp_slab_reader* reader, size_t bits)
+{
+  while (bits) {
+    size_t n;
+    slab_reader_fill(reader);
+    n = MIN(bits, CHAR_BIT * reader->size - stream_rtell(reader->zfp.stream));
+    if (!n)
+      return 0;
+    stream_rseek(reader->zfp.stream, stream_rtell(reader->zfp.stream) + n);
+    bits -= n;
+  }
+  return 1;
+}
+
+/* read header and chunk index and select slab decompressor */
+static int
+slab_reader_start(zfp_slab_reader* reader, uint mask)
+{
+  /* function table [dimensionality][scalar type] */
+  void (*ftable[4][4])(zfp_stream*, zfp_field*) = {
+    { decompress_strided_int32_1, decompress_strided_int64_1, decompress_strided_float_1, decompress_strided_double_1 },
+    { decompress_strided_int32_2, decompress_strided_int64_2, decompress_strided_float_2, decompress_strided_double_2 },
+    { decompress_strided_int32_3, decompress_strided_int64_3, decompress_strided_float_3, decompress_strided_double_3 },
+    { decompress_strided_int32_4, decompress_strided_int64_4, decompress_strided_float_4, decompress_strided_double_4 },
+  };
+  zfp_field* field = &reader->field;
+  zfp_field slab = *field;
+  uint dims;
+
+  /* read optional header, retaining strides of slabs */
+  if (!slab_reader_reserve(reader, (ZFP_HEADER_MAX_BITS + ZFP_INDEX_BITS) / CHAR_BIT + 1))
+    return 0;
+  slab_reader_fill(reader);
+  if (mask && !zfp_read_header(&reader->zfp, field, mask))
+    return 0;
+  field->sx = slab.sx;
+  field->sy = slab.sy;
+  field->sz = slab.sz;
+  field->sw = slab.sw;
+
+  switch (field->type) {
+    case zfp_type_int32:
+    case zfp_type_int64:
+    case zfp_type_float:
+    case zfp_type_double:
+      break;
+    default:
+      return 0;
+  }
+  dims = zfp_field_dimensionality(field);
+  if (dims < 1 || dims > 4)
+    return 0;
+  reader->decompress = ftable[dims - 1][field->type - zfp_type_int32];
+
+  /* packed chunks are contiguous; skip chunk offsets */
+  if (reader->zfp.index) {
+    uint64 chunks;
+    size_t bits;
+    slab_reader_fill(reader);
+    chunks = stream_read_bits(reader->zfp.stream, ZFP_INDEX_BITS);
+    if (!chunks || (reader->zfp.index == ZFP_INDEX_ALIGNED && chunks > 1))
+      return 0;
+    bits = (size_t)(chunks - 1) * ZFP_INDEX_BITS;
+    /* skip padding that precedes single aligned chunk */
+    if (reader->zfp.index == ZFP_INDEX_ALIGNED)
+      bits = align_offset(stream_rtell(reader->zfp.stream)) - stream_rtell(reader->zfp.stream);
+    if (!slab_reader_skip(reader, bits))
+      return 0;
+  }
+
+  /* buffer holds one compressed slab plus partial word */
+  slab = *field;
+  *slab_dimension(&slab) = MIN(*slab_dimension(&slab), 4u);
+  return slab_reader_reserve(reader, zfp_stream_maximum_size(&reader->zfp, &slab) + stream_word_bits / CHAR_BIT);
+}
+
+zfp_slab_reader*
+zfp_slab_reader_open(zfp_stream* zfp, zfp_field* field, uint mask, zfp_read_func read, void* user)
+{
+  zfp_slab_reader* reader = (zfp_slab_reader*)malloc(sizeof(zfp_slab_reader));
+  void* data = field->data;
+
+  if (!reader)
+    return NULL;
+  reader->zfp = *zfp;
+  reader->zfp.stream = NULL;
+  reader->field = *field;
+  reader->read = read;
+  reader->user = user;
+  reader->buffer = NULL;
+  reader->capacity = 0;
+  reader->size = 0;
+  reader->offset = 0;
+  reader->layers = 0;
+  if (!slab_reader_start(reader, mask)) {
+    zfp_slab_reader_close(reader);
+    return NULL;
+  }
+
+  /* report field metadata and compression parameters */
+  zfp->minbits = reader->zfp.minbits;
+  zfp->maxbits = reader->zfp.maxbits;
+  zfp->maxprec = reader->zfp.maxprec;
+  zfp->minexp = reader->zfp.minexp;
+  *field = reader->field;
+  field->data = data;
+
+  return reader;
+}
+
+uint
+zfp_slab_reader_read(zfp_slab_reader* reader, void* data)
+{
+  zfp_field slab = reader->field;
+  uint* n = slab_dimension(&slab);
+
+  /* return zero at end of field */
+  if (reader->layers >= *n)
+    return 0;
+
+  /* decompress up to four layers */
+  slab_reader_fill(reader);
+  *n = MIN(*n - reader->layers, 4u);
+  slab.data = data;
+  reader->decompress(&reader->zfp, &slab);
+  reader->layers += *n;
+
+  return *n;
+}
+
+size_t
+zfp_slab_reader_close(zfp_slab_reader* reader)
+{
+  size_t bytes = 0;
+  if (reader->zfp.stream) {
+    /* account for alignment of stream on word boundary */
+    stream_align(reader->zfp.stream);
+    bytes = reader->offset + stream_rtell(reader->zfp.stream) / CHAR_BIT;
+    stream_close(reader->zfp.stream);
+  }
+  free(reader->buffer);
+  free(reader);
+  return bytes;
+}
+
 size_t
 zfp_write_header(zfp_stream* zfp, const zfp_field* field, uint mask)
 {
@@ -1023,3 +1934,351 @@ zfp_read_header(zfp_stream* zfp, zfp_field* field, uint mask)
   }
   return bits;
 }
+
+/* public functions: chunked frames ---------------------------------------- */
+
+/* tag that ends frame trailer */
+static const char frame_tag[] = "zfpframe";
+
+/* location and parameters of one chunk of a frame */
+typedef struct {
+  size_t offset;   /* bit offset of compressed data */
+  size_t bytes;    /* bytes of compressed data */
+  uint64 meta;     /* field metadata */
+  uint64 mode;     /* compression mode */
+  uint flags;      /* chunk options and index layout */
+  uint32 checksum; /* checksum of compressed data (if any) */
+} frame_chunk;
+
+struct zfp_frame_writer {
+  zfp_stream* zfp; /* compression parameters and output bit stream */
+  size_t begin;    /* bit offset of start of frame */
+  uint64* offset;  /* byte offsets of chunks relative to start of frame */
+  uint chunks;     /* number of chunks */
+  uint capacity;   /* number of chunk offsets allocated */
+};
+
+struct zfp_frame_reader {
+  zfp_stream zfp;     /* execution policy and input bit stream */
+  frame_chunk* chunk; /* chunk locations and parameters */
+  uint chunks;        /* number of chunks */
+};
+
+/* number of bits of header, size, flags, and checksum preceding chunk data */
+static size_t
+frame_chunk_bits(void)
+{
+  return align_offset(ZFP_HEADER_MAX_BITS) + 128;
+}
+
+/* Adler-32 checksum of compressed data */
+static uint32
+frame_checksum(const uchar* data, size_t size)
+{
+  uint32 a = 1, b = 0;
+  while (size) {
+    /* largest number of bytes that cannot overflow b */
+    size_t n = MIN(size, (size_t)5552);
+    size -= n;
+    while (n--) {
+      a += *data++;
+      b += a;
+    }
+    a %= 65521u;
+    b %= 65521u;
+  }
+  return (b << 16) + a;
+}
+
+/* parse header of chunk at bit offset that must end before given offset */
+static int
+frame_parse(const bitstream* stream, size_t offset, size_t end, frame_chunk* chunk)
+{
+  zfp_stream zfp;
+  zfp_field field;
+  int valid = 0;
+
+  if (offset % stream_word_bits || offset > end || end - offset < frame_chunk_bits())
+    return 0;
+  zfp.stream = stream_clone(stream);
+  stream_rseek(zfp.stream, offset);
+  if (zfp_read_header(&zfp, &field, ZFP_HEADER_FULL)) {
+    stream_rseek(zfp.stream, offset + align_offset(ZFP_HEADER_MAX_BITS));
+    chunk->bytes = (size_t)stream_read_bits(zfp.stream, 64);
+    chunk->flags = (uint)stream_read_bits(zfp.stream, 32);
+    chunk->checksum = (uint32)stream_read_bits(zfp.stream, 32);
+    chunk->offset = stream_rtell(zfp.stream);
+    chunk->meta = zfp_field_metadata(&field);
+    chunk->mode = zfp_stream_mode(&zfp);
+    /* compressed data must lie within frame */
+    valid = chunk->bytes <= (end - chunk->offset) / CHAR_BIT;
+  }
+  stream_close(zfp.stream);
+
+  return valid;
+}
+
+/* does chunk data match its checksum, if any? */
+static int
+frame_verify(const bitstream* stream, const frame_chunk* chunk)
+{
+  const uchar* data = (const uchar*)stream_data(stream) + chunk->offset / CHAR_BIT;
+  return !(chunk->flags & ZFP_FRAME_CHECKSUM) || frame_checksum(data, chunk->bytes) == chunk->checksum;
+}
+
+/* locate chunks of frame occupying bits [begin, end) of stream */
+static frame_chunk*
+frame_locate(const bitstream* stream, size_t begin, size_t end, uint* chunks)
+{
+  bitstream* s = stream_clone(stream);
+  size_t bits = end - begin;
+  frame_chunk* chunk = NULL;
+  size_t capacity = 0;
+  size_t offset;
+  uint n = 0;
+  uint i;
+
+  /* use trailer if intact */
+  if (bits >= 128 && !(bits % stream_word_bits)) {
+    uint64 count;
+    int valid = 1;
+    stream_rseek(s, end - 64);
+    for (i = 0; i < 8; i++)
+      valid &= stream_read_bits(s, 8) == (uchar)frame_tag[i];
+    stream_rseek(s, end - 128);
+    count = stream_read_bits(s, 64);
+    if (valid && count <= (bits - 128) / 64) {
+      size_t index = end - 128 - (size_t)count * 64;
+      chunk = (frame_chunk*)malloc(((size_t)count + 1) * sizeof(frame_chunk));
+      stream_rseek(s, index);
+      for (n = 0; valid && n < count; n++) {
+        offset = (size_t)stream_read_bits(s, 64);
+        /* chunks must be ordered and must not overlap */
+        valid = chunk && offset <= bits / CHAR_BIT && frame_parse(stream, begin + CHAR_BIT * offset, index, chunk + n);
+        valid = valid && (!n || chunk[n - 1].offset + CHAR_BIT * chunk[n - 1].bytes <= begin + CHAR_BIT * offset);
+      }
+      if (valid) {
+        stream_close(s);
+        *chunks = n;
+        return chunk;
+      }
+      free(chunk);
+      chunk = NULL;
+    }
+  }
+
+  /* otherwise walk chunk headers, stopping at first invalid chunk */
+  offset = begin;
+  for (n = 0;; n++) {
+    frame_chunk c;
+    if (!frame_parse(stream, offset, end, &c) || !frame_verify(stream, &c))
+      break;
+    if (n == capacity) {
+      frame_chunk* p;
+      capacity = 2 * capacity + 1;
+      p = (frame_chunk*)realloc(chunk, capacity * sizeof(frame_chunk));
+      if (!p)
+        break;
+      chunk = p;
+    }
+    chunk[n] = c;
+    offset = c.offset + CHAR_BIT * c.bytes;
+  }
+  if (!chunk)
+    chunk = (frame_chunk*)malloc(sizeof(frame_chunk));
+  stream_close(s);
+  *chunks = n;
+
+  return chunk;
+}
+
+zfp_frame_writer*
+zfp_frame_writer_open(zfp_stream* zfp, size_t bytes)
+{
+  bitstream* s = zfp->stream;
+  size_t begin = stream_wtell(s);
+  zfp_frame_writer* writer;
+
+  if (begin % stream_word_bits)
+    return NULL;
+  writer = (zfp_frame_writer*)malloc(sizeof(zfp_frame_writer));
+  if (!writer)
+    return NULL;
+  writer->zfp = zfp;
+  writer->begin = begin;
+  writer->offset = NULL;
+  writer->chunks = 0;
+  writer->capacity = 0;
+
+  /* retain chunks of existing frame and overwrite its trailer */
+  if (bytes) {
+    frame_chunk* chunk = frame_locate(s, begin, begin + CHAR_BIT * bytes, &writer->chunks);
+    uint i;
+    writer->capacity = writer->chunks;
+    writer->offset = (uint64*)malloc((writer->capacity + 1) * sizeof(uint64));
+    if (!chunk || !writer->offset) {
+      free(chunk);
+      free(writer->offset);
+      free(writer);
+      return NULL;
+    }
+    for (i = 0; i < writer->chunks; i++)
+      writer->offset[i] = (chunk[i].offset - frame_chunk_bits() - begin) / CHAR_BIT;
+    if (writer->chunks)
+      stream_wseek(s, chunk[writer->chunks - 1].offset + CHAR_BIT * chunk[writer->chunks - 1].bytes);
+    free(chunk);
+  }
+
+  return writer;
+}
+
+size_t
+zfp_frame_writer_append(zfp_frame_writer* writer, const zfp_field* field, uint flags)
+{
+  zfp_stream* zfp = writer->zfp;
+  bitstream* s = zfp->stream;
+  size_t begin = stream_wtell(s);
+  size_t offset, bytes;
+  uint32 checksum = 0;
+  zfp_field f;
+  bitstream* t;
+
+  /* header must represent field type and dimensions exactly */
+  zfp_field_set_metadata(&f, zfp_field_metadata(field));
+  if (f.type != field->type || f.nx != field->nx || f.ny != field->ny || f.nz != field->nz || f.nw != field->nw)
+    return 0;
+
+  /* make room for chunk offset */
+  if (writer->chunks == writer->capacity) {
+    uint capacity = 2 * writer->capacity + 1;
+    uint64* offset = (uint64*)realloc(writer->offset, capacity * sizeof(uint64));
+    if (!offset)
+      return 0;
+    writer->offset = offset;
+    writer->capacity = capacity;
+  }
+
+  /* emit padded header and reserve space for size, flags, and checksum */
+  zfp_write_header(zfp, field, ZFP_HEADER_FULL);
+  stream_pad(s, (uint)(begin + align_offset(ZFP_HEADER_MAX_BITS) - stream_wtell(s)));
+  stream_write_bits(s, 0, 64);
+  stream_write_bits(s, 0, 64);
+  offset = stream_wtell(s);
+
+  /* compress field */
+  if (!zfp_compress(zfp, field)) {
+    stream_wseek(s, begin);
+    return 0;
+  }
+  bytes = stream_size(s) - offset / CHAR_BIT;
+
+  /* fill in size, flags, and checksum */
+  flags &= ZFP_FRAME_CHECKSUM;
+  if (flags & ZFP_FRAME_CHECKSUM)
+    checksum = frame_checksum((const uchar*)stream_data(s) + offset / CHAR_BIT, bytes);
+  flags += (uint)zfp->index << 1;
+  t = stream_clone(s);
+  stream_wseek(t, offset - 128);
+  stream_write_bits(t, bytes, 64);
+  stream_write_bits(t, flags, 32);
+  stream_write_bits(t, checksum, 32);
+  stream_close(t);
+
+  writer->offset[writer->chunks++] = (begin - writer->begin) / CHAR_BIT;
+
+  return stream_size(s) - begin / CHAR_BIT;
+}
+
+size_t
+zfp_frame_writer_close(zfp_frame_writer* writer)
+{
+  bitstream* s = writer->zfp->stream;
+  size_t bytes;
+  uint i;
+
+  /* emit trailer of chunk offsets, number of chunks, and tag */
+  for (i = 0; i < writer->chunks; i++)
+    stream_write_bits(s, writer->offset[i], 64);
+  stream_write_bits(s, writer->chunks, 64);
+  for (i = 0; i < 8; i++)
+    stream_write_bits(s, (uchar)frame_tag[i], 8);
+  stream_flush(s);
+  bytes = (stream_wtell(s) - writer->begin) / CHAR_BIT;
+
+  free(writer->offset);
+  free(writer);
+
+  return bytes;
+}
+
+zfp_frame_reader*
+zfp_frame_reader_open(zfp_stream* zfp, size_t bytes)
+{
+  bitstream* s = zfp->stream;
+  size_t begin = stream_rtell(s);
+  zfp_frame_reader* reader;
+
+  if (begin % stream_word_bits)
+    return NULL;
+  reader = (zfp_frame_reader*)malloc(sizeof(zfp_frame_reader));
+  if (!reader)
+    return NULL;
+  reader->zfp = *zfp;
+  reader->chunk = frame_locate(s, begin, begin + CHAR_BIT * bytes, &reader->chunks);
+  if (!reader->chunk) {
+    free(reader);
+    return NULL;
+  }
+  stream_rseek(s, begin + CHAR_BIT * bytes);
+
+  return reader;
+}
+
+uint
+zfp_frame_reader_chunks(const zfp_frame_reader* reader)
+{
+  return reader->chunks;
+}
+
+int
+zfp_frame_reader_field(const zfp_frame_reader* reader, uint chunk, zfp_field* field)
+{
+  if (chunk >= reader->chunks)
+    return 0;
+  return zfp_field_set_metadata(field, reader->chunk[chunk].meta);
+}
+
+size_t
+zfp_frame_reader_decompress(const zfp_frame_reader* reader, uint chunk, zfp_field* field)
+{
+  zfp_stream zfp = reader->zfp;
+  const frame_chunk* c;
+  size_t bytes = 0;
+
+  if (chunk >= reader->chunks)
+    return 0;
+  c = reader->chunk + chunk;
+  if (zfp_field_metadata(field) != c->meta || !frame_verify(zfp.stream, c))
+    return 0;
+
+  /* decompress using chunk parameters and thread-local bit stream */
+  if (zfp_stream_set_mode(&zfp, c->mode) == zfp_mode_null)
+    return 0;
+  zfp_stream_set_index(&zfp, (c->flags >> 1) & 0x3u);
+  if (!zfp.index && zfp.minbits != zfp.maxbits)
+    zfp_stream_set_execution(&zfp, zfp_exec_serial);
+  zfp.stream = stream_clone(reader->zfp.stream);
+  stream_rseek(zfp.stream, c->offset);
+  if (zfp_decompress(&zfp, field))
+    bytes = c->bytes;
+  stream_close(zfp.stream);
+
+  return bytes;
+}
+
+void
+zfp_frame_reader_close(zfp_frame_reader* reader)
+{
+  free(reader->chunk);
+  free(reader);
+}
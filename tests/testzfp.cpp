@@ -3,6 +3,7 @@
 #include <ctime>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <limits>
@@ -13,6 +14,10 @@
 #include "zfparray1.h"
 #include "zfparray2.h"
 #include "zfparray3.h"
+#include "zfparray4.h"
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
 
 enum ArraySize {
   Small  = 0, // 2^12 = 4096 scalars (2^12 = (2^6)^2 = (2^4)^3 = (2^3)^4)
@@ -377,13 +382,34 @@ test_rate(zfp_stream* stream, const zfp_field* input, double rate, Scalar tolera
       pass = false;
     }
   }
+  std::cout << std::setw(width) << std::left << status.str() << (pass ? " OK " : "FAIL") << std::endl;
+  if (!pass)
+    failures++;
+
+  // perform parallel decompression test when OpenMP is available
+  if (zfp_stream_set_execution(stream, zfp_exec_omp)) {
+    status.str("");
+    status << "  decompress:";
+    status << " rate=" << std::fixed << std::setprecision(0) << std::setw(2) << rate << " omp";
+    Scalar* h = new Scalar[n];
+    zfp_field_set_pointer(output, h);
+    zfp_stream_rewind(stream);
+    size_t size = zfp_decompress(stream, output);
+    // make sure output and stream position match serial decompression
+    pass = (size == outsize && std::equal(g, g + n, h));
+    if (!pass)
+      status << " [mismatch with serial decompression]";
+    delete[] h;
+    zfp_stream_set_execution(stream, zfp_exec_serial);
+    std::cout << std::setw(width) << std::left << status.str() << (pass ? " OK " : "FAIL") << std::endl;
+    if (!pass)
+      failures++;
+  }
+
   zfp_field_free(output);
   delete[] g;
   stream_close(s);
   delete[] buffer;
-  std::cout << std::setw(width) << std::left << status.str() << (pass ? " OK " : "FAIL") << std::endl;
-  if (!pass)
-    failures++;
 
   return failures;
 }
@@ -506,13 +532,65 @@ test_accuracy(zfp_stream* stream, const zfp_field* input, Scalar tolerance, size
       pass = false;
     }
   }
+  std::cout << std::setw(width) << std::left << status.str() << (pass ? " OK " : "FAIL") << std::endl;
+  if (!pass)
+    failures++;
+
+  // perform parallel round-trip test using chunk index when OpenMP is available
+  if (zfp_stream_set_omp_threads(stream, 4)) {
+    status.str("");
+    status << "  decompress:";
+    status << " tolerance=" << std::scientific << std::setprecision(3) << tolerance << " omp index";
+    zfp_stream_set_index(stream, 1);
+    size_t size = zfp_stream_maximum_size(stream, input);
+    uchar* data = new uchar[size];
+    bitstream* bs = stream_open(data, size);
+    zfp_stream_set_bit_stream(stream, bs);
+    size = zfp_compress(stream, input);
+    Scalar* h = new Scalar[n];
+    zfp_field_set_pointer(output, h);
+    // decompress using different thread count and serially
+    zfp_stream_set_omp_threads(stream, 3);
+    zfp_stream_rewind(stream);
+    pass = (zfp_decompress(stream, output) == size && std::equal(g, g + n, h));
+    std::fill(h, h + n, Scalar(0));
+    zfp_stream_set_execution(stream, zfp_exec_serial);
+    zfp_stream_rewind(stream);
+    pass = pass && (zfp_decompress(stream, output) == size && std::equal(g, g + n, h));
+    if (!pass)
+      status << " [mismatch with serial decompression]";
+    // reject chunk counts of zero and of more chunks than blocks
+    uint64 counts[] = { 0, n + 1 };
+    for (uint i = 0; i < 4; i++) {
+      bitstream* b = stream_open(data, size);
+      stream_write_bits(b, counts[i / 2], ZFP_INDEX_BITS);
+      stream_flush(b);
+      stream_close(b);
+      if (i & 1u)
+        zfp_stream_set_omp_threads(stream, 3);
+      else
+        zfp_stream_set_execution(stream, zfp_exec_serial);
+      zfp_stream_rewind(stream);
+      if (zfp_decompress(stream, output)) {
+        status << " [invalid chunk count accepted]";
+        pass = false;
+      }
+    }
+    zfp_stream_set_execution(stream, zfp_exec_serial);
+    zfp_stream_set_index(stream, 0);
+    zfp_stream_set_bit_stream(stream, s);
+    stream_close(bs);
+    delete[] data;
+    delete[] h;
+    std::cout << std::setw(width) << std::left << status.str() << (pass ? " OK " : "FAIL") << std::endl;
+    if (!pass)
+      failures++;
+  }
+
   zfp_field_free(output);
   delete[] g;
   stream_close(s);
   delete[] buffer;
-  std::cout << std::setw(width) << std::left << status.str() << (pass ? " OK " : "FAIL") << std::endl;
-  if (!pass)
-    failures++;
 
   return failures;
 }
@@ -567,6 +645,38 @@ update_array3(zfp::array3<Scalar>& a)
         a(0, 0, 0) = std::max(a(0, 0, 0), a(i, j, k));
 }
 
+// perform 4D differencing
+template <typename Scalar>
+inline void
+update_array4(zfp::array4<Scalar>& a)
+{
+  for (uint l = 0; l < a.size_w(); l++)
+    for (uint k = 0; k < a.size_z(); k++)
+      for (uint j = 0; j < a.size_y(); j++)
+        for (uint i = 0; i < a.size_x() - 1; i++)
+          a(i, j, k, l) -= a(i + 1, j, k, l);
+  for (uint l = 0; l < a.size_w(); l++)
+    for (uint k = 0; k < a.size_z(); k++)
+      for (uint j = 0; j < a.size_y() - 1; j++)
+        for (uint i = 0; i < a.size_x(); i++)
+          a(i, j, k, l) -= a(i, j + 1, k, l);
+  for (uint l = 0; l < a.size_w(); l++)
+    for (uint k = 0; k < a.size_z() - 1; k++)
+      for (uint j = 0; j < a.size_y(); j++)
+        for (uint i = 0; i < a.size_x(); i++)
+          a(i, j, k, l) -= a(i, j, k + 1, l);
+  for (uint l = 0; l < a.size_w() - 1; l++)
+    for (uint k = 0; k < a.size_z(); k++)
+      for (uint j = 0; j < a.size_y(); j++)
+        for (uint i = 0; i < a.size_x(); i++)
+          a(i, j, k, l) -= a(i, j, k, l + 1);
+  for (uint l = 0; l < a.size_w() - 1; l++)
+    for (uint k = 0; k < a.size_z() - 1; k++)
+      for (uint j = 0; j < a.size_y() - 1; j++)
+        for (uint i = 0; i < a.size_x() - 1; i++)
+          a(0, 0, 0, 0) = std::max(a(0, 0, 0, 0), a(i, j, k, l));
+}
+
 template <class Array>
 inline void update_array(Array& a);
 
@@ -594,6 +704,14 @@ template <>
 inline void
 update_array(zfp::array3<double>& a) { update_array3(a); }
 
+template <>
+inline void
+update_array(zfp::array4<float>& a) { update_array4(a); }
+
+template <>
+inline void
+update_array(zfp::array4<double>& a) { update_array4(a); }
+
 // test random-accessible array primitive
 template <class Array, typename Scalar>
 inline uint
@@ -642,6 +760,476 @@ test_array(Array& a, const Scalar* f, uint n, double tolerance, double dfmax)
   return failures;
 }
 
+// test variable-rate array in fixed-accuracy mode
+template <class Array, typename Scalar>
+inline uint
+test_variable_rate(Array& a, const Scalar* f, uint n, double tolerance)
+{
+  uint failures = 0;
+
+  // test construction
+  std::ostringstream status;
+  status << "  variable:  ";
+  Scalar tol = static_cast<Scalar>(a.set_accuracy(tolerance));
+  a.set(f);
+  Scalar emax = 0;
+  for (uint i = 0; i < n; i++)
+    emax = std::max(emax, std::abs(f[i] - a[i]));
+  status << " rate=" << std::fixed << std::setprecision(2) << std::setw(5) << a.rate();
+  status << std::scientific << std::setprecision(3);
+  bool pass = true;
+  if (emax <= tol)
+    status << " " << emax << " <= " << tol;
+  else {
+    status << " [" << emax << " > " << tol << "]";
+    pass = false;
+  }
+  std::cout << std::setw(width) << std::left << status.str() << (pass ? " OK " : "FAIL") << std::endl;
+  if (!pass)
+    failures++;
+
+  // overwrite with less compressible values so that blocks are relocated
+  status.str("");
+  status << "  grow:      ";
+  Scalar* g = new Scalar[n];
+  for (uint i = 0; i < n; i++)
+    g[i] = f[i] + static_cast<Scalar>(std::sin(double(i)));
+  a.set_cache_size(2 * n * sizeof(Scalar));
+  for (uint i = 0; i < n; i++)
+    a[i] = g[i];
+  a.flush_cache();
+  emax = 0;
+  for (uint i = 0; i < n; i++)
+    emax = std::max(emax, std::abs(g[i] - a[i]));
+  // make sure deep copy has identical contents
+  Array b(a);
+  for (uint i = 0; i < n; i++)
+    if (a[i] != b[i])
+      emax = std::numeric_limits<Scalar>::max();
+  status << " rate=" << std::fixed << std::setprecision(2) << std::setw(5) << a.rate();
+  status << std::scientific << std::setprecision(3);
+  pass = true;
+  if (emax <= tol)
+    status << " " << emax << " <= " << tol;
+  else {
+    status << " [" << emax << " > " << tol << "]";
+    pass = false;
+  }
+  std::cout << std::setw(width) << std::left << status.str() << (pass ? " OK " : "FAIL") << std::endl;
+  if (!pass)
+    failures++;
+
+  delete[] g;
+  return failures;
+}
+
+// test write-back through private views of variable-rate 3D array, which
+// relocates blocks and reallocates storage shared by all views
+template <typename Scalar>
+inline uint
+test_variable_views(zfp::array3<Scalar>& a, double tolerance)
+{
+  uint failures = 0;
+  uint nx = a.size_x();
+  uint ny = a.size_y();
+  uint nz = a.size_z();
+  uint n = uint(a.size());
+  std::ostringstream status;
+  status << "  views:     ";
+  Scalar tol = static_cast<Scalar>(a.set_accuracy(tolerance));
+  a.set_cache_size(0);
+  // overwrite with values that compress poorly so that storage is reallocated
+  Scalar* h = new Scalar[n];
+  for (uint i = 0; i < n; i++)
+    h[i] = static_cast<Scalar>(std::sin(1.7 * i) * 100);
+  const uchar* data = a.compressed_data();
+  typename zfp::array3<Scalar>::private_const_view r(&a);
+  r.set_cache_size(0);
+  uint threads = 1;
+#ifdef _OPENMP
+  #pragma omp parallel
+#endif
+  {
+    typename zfp::array3<Scalar>::private_view v(&a);
+    v.set_cache_size(0);
+#ifdef _OPENMP
+    threads = uint(omp_get_num_threads());
+    v.partition(uint(omp_get_thread_num()), threads);
+#endif
+    for (uint k = 0; k < v.size_z(); k++)
+      for (uint j = 0; j < v.size_y(); j++)
+        for (uint i = 0; i < v.size_x(); i++)
+          v(i, j, k) = h[v.global_x(i) + nx * (v.global_y(j) + ny * v.global_z(k))];
+    v.flush_cache();
+  }
+  status << " threads=" << threads;
+  // views bypass the array cache; read back through the array and through a
+  // view constructed before the storage was reallocated
+  a.clear_cache();
+  Scalar emax = 0;
+  uint mismatches = 0;
+  for (uint k = 0; k < nz; k++)
+    for (uint j = 0; j < ny; j++)
+      for (uint i = 0; i < nx; i++) {
+        Scalar x = a(i, j, k);
+        emax = std::max(emax, std::abs(h[i + nx * (j + ny * k)] - x));
+        if (r(i, j, k) != x)
+          mismatches++;
+      }
+  bool pass = true;
+  if (a.compressed_data() == data) {
+    status << " [storage not reallocated]";
+    pass = false;
+  }
+  if (emax > tol) {
+    status << " [" << emax << " > " << tol << "]";
+    pass = false;
+  }
+  if (mismatches) {
+    status << " [" << mismatches << " mismatches]";
+    pass = false;
+  }
+  std::cout << std::setw(width) << std::left << status.str() << (pass ? " OK " : "FAIL") << std::endl;
+  if (!pass)
+    failures++;
+  delete[] h;
+  return failures;
+}
+
+// test fixed-rate array whose compressed data is mapped to a file
+template <class Array>
+inline uint
+test_mapped(const Array& a)
+{
+  uint failures = 0;
+  uint n = uint(a.size());
+  const char* path = "testzfp.map";
+  std::remove(path);
+
+  // write array to new file
+  Array m(a);
+  if (m.map(path)) {
+    std::ostringstream status;
+    status << "  mapped:    ";
+    uint mismatches = 0;
+    for (uint i = 0; i < n; i++)
+      if (m[i] != 0)
+        mismatches++;
+    for (uint i = 0; i < n; i++)
+      m[i] = a[i];
+    m.flush_cache();
+    m.clear_cache();
+    // read file without modifying it
+    Array r(a);
+    if (!r.map(path, true))
+      mismatches++;
+    for (uint i = 0; i < n; i++)
+      if (r[i] != m[i])
+        mismatches++;
+    r[0] = r[0] + 1;
+    r.flush_cache();
+    Array s(a);
+    if (!s.map(path, true) || s[0] != m[0])
+      mismatches++;
+    status << " bytes=" << m.compressed_size();
+    bool pass = !mismatches;
+    if (!pass)
+      status << " [" << mismatches << " mismatches]";
+    std::cout << std::setw(width) << std::left << status.str() << (pass ? " OK " : "FAIL") << std::endl;
+    if (!pass)
+      failures++;
+  }
+
+  std::remove(path);
+  return failures;
+}
+
+// compare decoded 3D blocks with element-wise reads of array
+template <typename Scalar>
+class block_checker {
+public:
+  block_checker(const zfp::array3<Scalar>& a, uint& blocks, uint& mismatches) : a(a), blocks(blocks), mismatches(mismatches) {}
+  void operator()(uint i, uint j, uint k, const Scalar* p) const
+  {
+    blocks++;
+    for (uint z = 0; z < 4 && k + z < a.size_z(); z++)
+      for (uint y = 0; y < 4 && j + y < a.size_y(); y++)
+        for (uint x = 0; x < 4 && i + x < a.size_x(); x++)
+          if (p[x + 4 * (y + 4 * z)] != a(i + x, j + y, k + z))
+            mismatches++;
+  }
+protected:
+  const zfp::array3<Scalar>& a;
+  uint& blocks;
+  uint& mismatches;
+};
+
+// negate values of decoded 3D block
+template <typename Scalar>
+inline void
+negate_block(uint, uint, uint, Scalar* p)
+{
+  for (uint n = 0; n < 64; n++)
+    p[n] = -p[n];
+}
+
+// test block-level access to 3D array
+template <typename Scalar>
+inline uint
+test_block_access(const zfp::array3<Scalar>& a)
+{
+  std::ostringstream status;
+  status << "  blocks:    ";
+  uint mismatches = 0;
+  // write back modified blocks so that b and c start from the same data
+  a.flush_cache();
+  zfp::array3<Scalar> b(a);
+  // compare each decoded block with element-wise reads without modifying b
+  uint blocks = 0;
+  static_cast<const zfp::array3<Scalar>&>(b).for_each_block(block_checker<Scalar>(a, blocks, mismatches));
+  if (blocks != ((b.size_x() + 3) / 4) * ((b.size_y() + 3) / 4) * ((b.size_z() + 3) / 4))
+    mismatches++;
+  // negate values block by block and make sure updates are stored
+  b.for_each_block(negate_block<Scalar>);
+  b.flush_cache();
+  // compare with element-wise negation of a copy, visiting one block at a
+  // time so that no block is evicted while partially negated
+  zfp::array3<Scalar> c(a);
+  for (uint k = 0; k < c.size_z(); k += 4)
+    for (uint j = 0; j < c.size_y(); j += 4)
+      for (uint i = 0; i < c.size_x(); i += 4)
+        for (uint z = 0; z < 4 && k + z < c.size_z(); z++)
+          for (uint y = 0; y < 4 && j + y < c.size_y(); y++)
+            for (uint x = 0; x < 4 && i + x < c.size_x(); x++)
+              c(i + x, j + y, k + z) = -c(i + x, j + y, k + z);
+  c.flush_cache();
+  for (uint k = 0; k < b.size_z(); k++)
+    for (uint j = 0; j < b.size_y(); j++)
+      for (uint i = 0; i < b.size_x(); i++)
+        if (b(i, j, k) != c(i, j, k))
+          mismatches++;
+  bool pass = !mismatches;
+  if (!pass)
+    status << " [" << mismatches << " mismatches]";
+  std::cout << std::setw(width) << std::left << status.str() << (pass ? " OK " : "FAIL") << std::endl;
+  return pass ? 0 : 1;
+}
+
+// test strided get and set of 3D subarrays
+template <typename Scalar>
+inline uint
+test_subarray(const zfp::array3<Scalar>& a)
+{
+  std::ostringstream status;
+  status << "  subarray:  ";
+  uint mismatches = 0;
+  // write back modified blocks so that b and c start from the same data
+  a.flush_cache();
+  // subarray with partially and fully covered blocks
+  uint x0 = 3, y0 = 4, z0 = 1;
+  uint nx = a.size_x() - 5, ny = a.size_y() - 4, nz = 9;
+  Scalar* p = new Scalar[nx * ny * nz];
+  // extract subarray in transposed order and compare with element-wise reads
+  zfp::array3<Scalar> b(a);
+  b.get(x0, y0, z0, nx, ny, nz, p, int(nz * ny), int(nz), 1);
+  for (uint k = 0; k < nz; k++)
+    for (uint j = 0; j < ny; j++)
+      for (uint i = 0; i < nx; i++)
+        if (p[k + nz * (j + ny * i)] != a(x0 + i, y0 + j, z0 + k))
+          mismatches++;
+  // inject modified subarray and compare with element-wise writes
+  for (uint i = 0; i < nx * ny * nz; i++)
+    p[i] = -p[i];
+  b.set(x0, y0, z0, nx, ny, nz, p, int(nz * ny), int(nz), 1);
+  b.flush_cache();
+  // write one block at a time so that no block is evicted while partially
+  // updated
+  zfp::array3<Scalar> c(a);
+  for (uint k = z0 & ~3u; k < z0 + nz; k += 4)
+    for (uint j = y0 & ~3u; j < y0 + ny; j += 4)
+      for (uint i = x0 & ~3u; i < x0 + nx; i += 4)
+        for (uint z = std::max(k, z0); z < std::min(k + 4, z0 + nz); z++)
+          for (uint y = std::max(j, y0); y < std::min(j + 4, y0 + ny); y++)
+            for (uint x = std::max(i, x0); x < std::min(i + 4, x0 + nx); x++)
+              c(x, y, z) = p[(z - z0) + nz * ((y - y0) + ny * (x - x0))];
+  c.flush_cache();
+  for (uint i = 0; i < b.size(); i++)
+    if (b[i] != c[i])
+      mismatches++;
+  delete[] p;
+  bool pass = !mismatches;
+  if (!pass)
+    status << " [" << mismatches << " mismatches]";
+  std::cout << std::setw(width) << std::left << status.str() << (pass ? " OK " : "FAIL") << std::endl;
+  return pass ? 0 : 1;
+}
+
+// test parallel whole-array set, get, and cache flush
+template <typename Scalar>
+inline uint
+test_parallel(const zfp::array3<Scalar>& a, const Scalar* f)
+{
+  uint failures = 0;
+  uint n = uint(a.size());
+  zfp::array3<Scalar> b(a);
+  if (b.set_execution(zfp_exec_omp, 4)) {
+    std::ostringstream status;
+    status << "  parallel:   threads=4";
+    uint mismatches = 0;
+    zfp::array3<Scalar> c(a);
+    // compressed data must not depend on execution policy
+    b.set(f);
+    c.set(f);
+    if (std::memcmp(b.compressed_data(), c.compressed_data(), b.compressed_size()))
+      mismatches++;
+    // modify every other value and flush cache
+    for (uint i = 0; i < n; i += 2) {
+      b[i] = -b[i];
+      c[i] = -c[i];
+    }
+    b.flush_cache();
+    c.flush_cache();
+    if (std::memcmp(b.compressed_data(), c.compressed_data(), b.compressed_size()))
+      mismatches++;
+    // decompress with partially populated cache
+    for (uint i = 0; i < n; i += 7)
+      b[i] = 0;
+    Scalar* g = new Scalar[n];
+    Scalar* h = new Scalar[n];
+    b.get(g);
+    b.set_execution(zfp_exec_serial);
+    b.get(h);
+    for (uint i = 0; i < n; i++)
+      if (g[i] != h[i])
+        mismatches++;
+    delete[] g;
+    delete[] h;
+    bool pass = !mismatches;
+    if (!pass)
+      status << " [" << mismatches << " mismatches]";
+    std::cout << std::setw(width) << std::left << status.str() << (pass ? " OK " : "FAIL") << std::endl;
+    if (!pass)
+      failures++;
+  }
+  return failures;
+}
+
+// count hits when cycling through four lines that map to the same cache slot
+// when direct mapped
+template <class Policy>
+inline uint
+cache_hits()
+{
+  Cache<char, Policy> cache(16);
+  uint hits = 0;
+  for (uint n = 0; n < 10; n++)
+    for (uint x = 1; x < 64; x += 16) {
+      char* p;
+      if (cache.access(p, x, false).index() == x)
+        hits++;
+    }
+  return hits;
+}
+
+// count mismatches between a and a copy cached using Policy when both are
+// traversed with the z index varying fastest
+template <typename Scalar, class Policy>
+inline uint
+policy_mismatches(const zfp::array3<Scalar>& a)
+{
+  uint nx = a.size_x(), ny = a.size_y(), nz = a.size_z();
+  zfp::array3<Scalar, zfp::codec<Scalar>, Policy> b(nx, ny, nz, a.rate(), 0, 16 * 64 * sizeof(Scalar));
+  std::memcpy(b.compressed_data(), a.compressed_data(), a.compressed_size());
+  uint mismatches = 0;
+  for (uint i = 0; i < nx; i++)
+    for (uint j = 0; j < ny; j++)
+      for (uint k = 0; k < nz; k++)
+        if (b(i, j, k) != a(i, j, k))
+          mismatches++;
+  return mismatches;
+}
+
+// test cache replacement policies
+template <typename Scalar>
+inline uint
+test_cache_policies(const zfp::array3<Scalar>& a)
+{
+  std::ostringstream status;
+  status << "  policies:  ";
+  uint mismatches = 0;
+  mismatches += policy_mismatches<Scalar, CacheTwoWay>(a);
+  mismatches += policy_mismatches<Scalar, CacheLRU<4> >(a);
+  mismatches += policy_mismatches<Scalar, CacheClock<4> >(a);
+  mismatches += policy_mismatches<Scalar, CacheARC<4> >(a);
+  // set-associative policies keep all four lines; direct mapping keeps none
+  bool pass = !mismatches &&
+              cache_hits<CacheDirectMapped>() == 0 &&
+              cache_hits<CacheLRU<4> >() == 36 &&
+              cache_hits<CacheClock<4> >() == 36 &&
+              cache_hits<CacheARC<4> >() == 36;
+  if (mismatches)
+    status << " [" << mismatches << " mismatches]";
+  std::cout << std::setw(width) << std::left << status.str() << (pass ? " OK " : "FAIL") << std::endl;
+  return pass ? 0 : 1;
+}
+
+// test concurrent reads from 3D or 4D array with shared cache
+template <typename Scalar, class Array>
+inline uint
+test_concurrent(Array& a)
+{
+  uint failures = 0;
+  uint n = uint(a.size());
+
+  // write back modified blocks so that serial and concurrent reads agree
+  a.flush_cache();
+
+  // read values serially
+  Scalar* f = new Scalar[n];
+  for (uint i = 0; i < n; i++)
+    f[i] = a[i];
+
+  // use small cache to force frequent evictions
+  a.set_cache_size(16 * 64 * sizeof(Scalar));
+  if (a.set_concurrent(true)) {
+    std::ostringstream status;
+    status << "  concurrent:";
+    const Array& c = a;
+    uint mismatches = 0;
+#ifdef _OPENMP
+    #pragma omp parallel for reduction(+:mismatches)
+#endif
+    for (int i = 0; i < int(n); i++) {
+      // visit values in scattered order
+      uint j = uint((97 * size_t(i)) % n);
+      if (c[j] != f[j])
+        mismatches++;
+    }
+#ifdef _OPENMP
+    status << " threads=" << omp_get_max_threads();
+#endif
+    bool pass = !mismatches;
+    if (!pass)
+      status << " [" << mismatches << " mismatches]";
+    std::cout << std::setw(width) << std::left << status.str() << (pass ? " OK " : "FAIL") << std::endl;
+    if (!pass)
+      failures++;
+
+    // switching to variable rate must disable concurrent reads
+    double rate = a.rate();
+    a.set_precision(CHAR_BIT * sizeof(Scalar));
+    pass = !a.concurrent() && !a.set_concurrent(true);
+    std::cout << std::setw(width) << std::left << "  concurrent variable rate:" << (pass ? " OK " : "FAIL") << std::endl;
+    if (!pass)
+      failures++;
+    a.set_rate(rate);
+    a.set(f);
+  }
+
+  delete[] f;
+  return failures;
+}
+
 // test small or large d-dimensional arrays of type Scalar
 template <typename Scalar>
 inline uint
@@ -820,28 +1408,28 @@ test(uint dims, ArraySize array_size)
   }
 
   // test compressed array support
-  double emax[2][2][3] = {
+  double emax[2][2][4] = {
     // small
     {
-      {4.578e-05, 7.630e-06, 3.148e-05},
-      {1.832e-04, 8.584e-06, 3.338e-05},
+      {4.578e-05, 7.630e-06, 3.148e-05, 3.598e-03},
+      {1.832e-04, 8.584e-06, 3.338e-05, 3.312e-03},
     },
     // large
     {
-      {0.000e+00, 0.000e+00, 0.000e+00},
-      {2.289e-05, 0.000e+00, 0.000e+00},
+      {0.000e+00, 0.000e+00, 0.000e+00, 1.193e-07},
+      {2.289e-05, 0.000e+00, 0.000e+00, 8.801e-08},
     }
   };
-  double dfmax[2][2][3] = {
+  double dfmax[2][2][4] = {
     // small
     {
-      {2.155e-02, 3.755e-01, 1.846e+00},
-      {2.155e-02, 3.755e-01, 1.846e+00},
+      {2.155e-02, 3.755e-01, 1.846e+00, 4.832e+01},
+      {2.155e-02, 3.755e-01, 1.846e+00, 4.832e+01},
     },
     // large
     {
-      {2.441e-04, 4.883e-04, 1.221e-03},
-      {2.670e-04, 4.883e-04, 1.221e-03},
+      {2.441e-04, 4.883e-04, 1.221e-03, 2.563e-02},
+      {2.670e-04, 4.883e-04, 1.221e-03, 2.563e-02},
     }
   };
   double rate = 16;
@@ -849,19 +1437,37 @@ test(uint dims, ArraySize array_size)
     case 1: {
         zfp::array1<Scalar> a(nx, rate, f);
         failures += test_array(a, f, n, static_cast<Scalar>(emax[array_size][t][dims - 1]), static_cast<Scalar>(dfmax[array_size][t][dims - 1]));
+        failures += test_mapped(a);
+        failures += test_variable_rate(a, f, n, 1e-3);
       }
       break;
     case 2: {
         zfp::array2<Scalar> a(nx, ny, rate, f);
         failures += test_array(a, f, n, static_cast<Scalar>(emax[array_size][t][dims - 1]), static_cast<Scalar>(dfmax[array_size][t][dims - 1]));
+        failures += test_mapped(a);
+        failures += test_variable_rate(a, f, n, 1e-3);
       }
       break;
     case 3: {
         zfp::array3<Scalar> a(nx, ny, nz, rate, f);
         failures += test_array(a, f, n, static_cast<Scalar>(emax[array_size][t][dims - 1]), static_cast<Scalar>(dfmax[array_size][t][dims - 1]));
+        failures += test_mapped(a);
+        failures += test_block_access(a);
+        failures += test_subarray(a);
+        failures += test_parallel(a, f);
+        failures += test_cache_policies(a);
+        failures += test_concurrent<Scalar>(a);
+        failures += test_variable_rate(a, f, n, 1e-3);
+        failures += test_variable_views(a, 1e-3);
       }
       break;
-    case 4: // 4D arrays not yet supported
+    case 4: {
+        zfp::array4<Scalar> a(nx, ny, nz, nw, rate, f);
+        failures += test_array(a, f, n, static_cast<Scalar>(emax[array_size][t][dims - 1]), static_cast<Scalar>(dfmax[array_size][t][dims - 1]));
+        failures += test_mapped(a);
+        failures += test_concurrent<Scalar>(a);
+        failures += test_variable_rate(a, f, n, 1e-3);
+      }
       break;
   }
 
@@ -919,6 +1525,917 @@ common_tests()
   return failures;
 }
 
+// test skipping runs of zero-bits that straddle stream words
+inline uint
+test_skip_zeros()
+{
+  uint failures = 0;
+  uint64 buffer[4] = { 0, 0, 0, 0 };
+  bitstream* s = stream_open(buffer, sizeof(buffer));
+  // write runs of 3, 100, and 10 zeros, each followed by a one-bit
+  stream_write_bits(s, 0x8, 4);
+  stream_pad(s, 100);
+  stream_write_bit(s, 1);
+  stream_write_bits(s, 0x400, 11);
+  stream_flush(s);
+  stream_rewind(s);
+  // skip runs with and without reaching the limit on the zero count
+  uint z[4];
+  z[0] = stream_skip_zeros(s, 200);
+  z[1] = stream_skip_zeros(s, 50);
+  z[2] = stream_skip_zeros(s, 200);
+  z[3] = stream_skip_zeros(s, 10);
+  uint bit = stream_read_bit(s);
+  if (z[0] != 3 || z[1] != 50 || z[2] != 50 || z[3] != 10 || bit != 1 || stream_rtell(s) != 116) {
+    std::cout << "zero-bit skipping failed" << std::endl;
+    failures++;
+  }
+  stream_close(s);
+  return failures;
+}
+
+// test batched block encoding and decoding of count blocks against
+// block-at-a-time coding in each compression mode
+template <typename Scalar>
+inline uint
+test_blocks(uint dims, zfp_type type, size_t (*encode_blocks)(zfp_stream*, const Scalar*, uint), uint (*encode_block)(zfp_stream*, const Scalar*), size_t (*decode_blocks)(zfp_stream*, Scalar*, uint), uint (*decode_block)(zfp_stream*, Scalar*))
+{
+  uint failures = 0;
+  // use a block count that leaves the last batch of blocks partially filled
+  const uint count = 19;
+  const uint size = 1u << (2 * dims);
+  const uint n = size * count;
+  const double scale = type == zfp_type_int32 || type == zfp_type_int64 ? 0x100000 : 1;
+  Scalar* f = new Scalar[3 * n];
+  Scalar* g = f + n;
+  Scalar* h = g + n;
+  for (uint i = 0; i < n; i++)
+    f[i] = Scalar(scale * std::sin(0.1 * i) * std::exp(0.01 * double(i % size)));
+  // include an all-zero block and a block of values below the error tolerance
+  std::fill(f + 5 * size, f + 6 * size, Scalar(0));
+  for (uint i = 7 * size; i < 8 * size; i++)
+    f[i] = Scalar(f[i] * 1e-20);
+  // compare the fastest kernel with the generic one when built with kernels
+  zfp_stream* stream = zfp_stream_open(NULL);
+  zfp_kernel kernel = zfp_stream_kernel(stream);
+  size_t bufsize = 2 * n * sizeof(Scalar) + 64;
+  uchar* buffer = new uchar[2 * bufsize];
+  bitstream* s = stream_open(buffer, bufsize);
+  bitstream* t = stream_open(buffer + bufsize, bufsize);
+  // exercise low-rate and high-precision bit plane coding, padding of
+  // fixed-rate blocks, skipped blocks, and reversible coding
+  for (uint mode = 0; mode < 5; mode++) {
+    switch (mode) {
+      case 0:
+        zfp_stream_set_precision(stream, 4);
+        break;
+      case 1:
+        zfp_stream_set_precision(stream, 64);
+        break;
+      case 2:
+        zfp_stream_set_rate(stream, 8, type, dims, 0);
+        break;
+      case 3:
+        zfp_stream_set_accuracy(stream, 1e-3);
+        break;
+      case 4:
+        zfp_stream_set_reversible(stream);
+        break;
+    }
+    std::fill(buffer, buffer + 2 * bufsize, uchar(0));
+    zfp_stream_set_kernel(stream, kernel);
+    zfp_stream_set_bit_stream(stream, s);
+    zfp_stream_rewind(stream);
+    size_t bits = encode_blocks(stream, f, count);
+    zfp_stream_flush(stream);
+    zfp_stream_set_kernel(stream, zfp_kernel_generic);
+    zfp_stream_set_bit_stream(stream, t);
+    zfp_stream_rewind(stream);
+    size_t sum = 0;
+    for (uint i = 0; i < count; i++)
+      sum += encode_block(stream, f + size * i);
+    zfp_stream_flush(stream);
+    zfp_stream_set_kernel(stream, kernel);
+    zfp_stream_set_bit_stream(stream, s);
+    zfp_stream_rewind(stream);
+    bool pass = (bits == sum && decode_blocks(stream, g, count) == bits);
+    zfp_stream_set_kernel(stream, zfp_kernel_generic);
+    zfp_stream_set_bit_stream(stream, t);
+    zfp_stream_rewind(stream);
+    for (uint i = 0; i < count; i++)
+      decode_block(stream, h + size * i);
+    pass = pass && std::equal(buffer, buffer + bufsize, buffer + bufsize) && std::equal(g, g + n, h);
+    if (!pass) {
+      std::cout << "batched block coding mismatch in " << dims << "D mode " << mode << std::endl;
+      failures++;
+    }
+  }
+  stream_close(t);
+  stream_close(s);
+  zfp_stream_close(stream);
+  delete[] buffer;
+  delete[] f;
+  return failures;
+}
+
+// test batched block coding for all dimensionalities
+inline uint
+test_blocks()
+{
+  uint failures = 0;
+  failures += test_blocks<int32>(1, zfp_type_int32, zfp_encode_blocks_int32_1, zfp_encode_block_int32_1, zfp_decode_blocks_int32_1, zfp_decode_block_int32_1);
+  failures += test_blocks<int64>(2, zfp_type_int64, zfp_encode_blocks_int64_2, zfp_encode_block_int64_2, zfp_decode_blocks_int64_2, zfp_decode_block_int64_2);
+  failures += test_blocks<float>(1, zfp_type_float, zfp_encode_blocks_float_1, zfp_encode_block_float_1, zfp_decode_blocks_float_1, zfp_decode_block_float_1);
+  failures += test_blocks<float>(2, zfp_type_float, zfp_encode_blocks_float_2, zfp_encode_block_float_2, zfp_decode_blocks_float_2, zfp_decode_block_float_2);
+  failures += test_blocks<double>(3, zfp_type_double, zfp_encode_blocks_double_3, zfp_encode_block_double_3, zfp_decode_blocks_double_3, zfp_decode_block_double_3);
+  failures += test_blocks<double>(4, zfp_type_double, zfp_encode_blocks_double_4, zfp_encode_block_double_4, zfp_decode_blocks_double_4, zfp_decode_block_double_4);
+  return failures;
+}
+
+// test decompression of subregion of 3D field in fixed- and variable-rate mode
+inline uint
+test_region()
+{
+  uint failures = 0;
+  const uint nx = 23, ny = 19, nz = 13;
+  const uint x0 = 5, y0 = 3, z0 = 2;
+  const uint mx = 11, my = 9, mz = 7;
+  float* f = new float[nx * ny * nz];
+  float* g = new float[nx * ny * nz];
+  float* h = new float[mx * my * mz];
+  for (uint i = 0; i < nx * ny * nz; i++)
+    f[i] = float(std::sin(0.1 * i) * std::cos(0.03 * i));
+  zfp_field* field = zfp_field_3d(f, zfp_type_float, nx, ny, nz);
+  zfp_stream* stream = zfp_stream_open(NULL);
+  size_t bufsize = 2 * nx * ny * nz * sizeof(float);
+  uchar* buffer = new uchar[bufsize];
+  bitstream* s = stream_open(buffer, bufsize);
+  zfp_stream_set_bit_stream(stream, s);
+  for (uint mode = 0; mode < 3; mode++) {
+    // fixed rate, fixed accuracy, and fixed accuracy with multi-chunk index
+    if (mode == 0)
+      zfp_stream_set_rate(stream, 12, zfp_type_float, 3, 0);
+    else
+      zfp_stream_set_accuracy(stream, 1e-3);
+    zfp_stream_set_index(stream, mode == 2);
+    if (mode == 2 && zfp_stream_set_execution(stream, zfp_exec_omp))
+      zfp_stream_set_omp_chunk_size(stream, 5);
+    zfp_field_set_pointer(field, f);
+    zfp_stream_rewind(stream);
+    bool pass = zfp_compress(stream, field) != 0;
+    zfp_stream_set_execution(stream, zfp_exec_serial);
+    zfp_field_set_pointer(field, g);
+    zfp_stream_rewind(stream);
+    pass = pass && zfp_decompress(stream, field) != 0;
+    zfp_field_set_pointer(field, h);
+    zfp_stream_rewind(stream);
+    pass = pass && zfp_decompress_region(stream, field, x0, y0, z0, mx, my, mz) != 0;
+    for (uint z = 0; z < mz; z++)
+      for (uint y = 0; y < my; y++)
+        for (uint x = 0; x < mx; x++)
+          if (h[x + mx * (y + my * z)] != g[(x0 + x) + nx * ((y0 + y) + ny * (z0 + z))])
+            pass = false;
+    if (!pass) {
+      std::cout << "region decompression mismatch in mode " << mode << std::endl;
+      failures++;
+    }
+  }
+  stream_close(s);
+  zfp_stream_close(stream);
+  zfp_field_free(field);
+  delete[] buffer;
+  delete[] h;
+  delete[] g;
+  delete[] f;
+  return failures;
+}
+
+// test per-thread timings of OpenMP compression and decompression
+inline uint
+test_omp_timings()
+{
+  uint failures = 0;
+  const uint nx = 64, ny = 64;
+  const uint threads = 2;
+  double* f = new double[nx * ny];
+  for (uint i = 0; i < nx * ny; i++)
+    f[i] = i % 3 ? 0.0 : std::sin(0.7 * i);
+  zfp_field* field = zfp_field_2d(f, zfp_type_double, nx, ny);
+  zfp_stream* stream = zfp_stream_open(NULL);
+  zfp_stream_set_accuracy(stream, 1e-6);
+  zfp_stream_set_index(stream, 1);
+  size_t bufsize = 2 * zfp_stream_maximum_size(stream, field);
+  uchar* buffer = new uchar[bufsize];
+  bitstream* s = stream_open(buffer, bufsize);
+  zfp_stream_set_bit_stream(stream, s);
+  if (zfp_stream_set_omp_threads(stream, threads)) {
+    // one extra entry guards against writes past the requested thread count
+    double seconds[threads + 1];
+    zfp_stream_set_omp_chunk_size(stream, 16);
+    zfp_stream_set_omp_timings(stream, seconds);
+    if (zfp_stream_omp_timings(stream) != seconds) {
+      std::cout << "per-thread timings not registered" << std::endl;
+      failures++;
+    }
+    for (uint pass = 0; pass < 2; pass++) {
+      std::fill(seconds, seconds + threads + 1, -1.0);
+      zfp_stream_rewind(stream);
+      bool ok = pass ? zfp_decompress(stream, field) != 0 : zfp_compress(stream, field) != 0;
+      double total = 0;
+      for (uint i = 0; i < threads; i++) {
+        if (!(seconds[i] >= 0))
+          ok = false;
+        total += seconds[i];
+      }
+      if (!ok || !(total > 0) || seconds[threads] != -1.0) {
+        std::cout << "per-thread timings of " << (pass ? "decompression" : "compression") << " not populated" << std::endl;
+        failures++;
+      }
+    }
+  }
+  stream_close(s);
+  zfp_stream_close(stream);
+  zfp_field_free(field);
+  delete[] buffer;
+  delete[] f;
+  return failures;
+}
+
+// sink that appends compressed data to memory buffer
+struct sink {
+  uchar* data;
+  size_t size;
+};
+
+static size_t
+write_sink(void* user, const void* data, size_t size)
+{
+  sink* s = static_cast<sink*>(user);
+  std::copy(static_cast<const uchar*>(data), static_cast<const uchar*>(data) + size, s->data + s->size);
+  s->size += size;
+  return size;
+}
+
+// source that reads compressed data from memory buffer in small pieces
+static size_t
+read_source(void* user, void* data, size_t size)
+{
+  sink* s = static_cast<sink*>(user);
+  size = std::min(std::min(size, s->size), size_t(7));
+  std::copy(s->data, s->data + size, static_cast<uchar*>(data));
+  s->data += size;
+  s->size -= size;
+  return size;
+}
+
+// test streaming slab (de)compression against whole-field (de)compression
+inline uint
+test_slabs()
+{
+  uint failures = 0;
+  const uint nx = 21, ny = 17, nz = 10;
+  double* f = new double[nx * ny * nz];
+  double* g = new double[nx * ny * nz];
+  double* h = new double[nx * ny * 4];
+  for (uint i = 0; i < nx * ny * nz; i++)
+    f[i] = std::sin(0.1 * i) * std::cos(0.03 * i);
+  zfp_field* field = zfp_field_3d(f, zfp_type_double, nx, ny, nz);
+  zfp_stream* stream = zfp_stream_open(NULL);
+  size_t bufsize = 2 * nx * ny * nz * sizeof(double);
+  uchar* buffer = new uchar[2 * bufsize];
+  bitstream* s = stream_open(buffer, bufsize);
+  zfp_stream_set_bit_stream(stream, s);
+  for (uint mode = 0; mode < 3; mode++) {
+    // fixed rate, fixed accuracy with index, and multiple chunks if possible
+    if (mode == 0)
+      zfp_stream_set_rate(stream, 12, zfp_type_double, 3, 0);
+    else
+      zfp_stream_set_accuracy(stream, 1e-4);
+    zfp_stream_set_index(stream, mode != 0);
+    if (mode == 2 && zfp_stream_set_execution(stream, zfp_exec_omp))
+      zfp_stream_set_omp_chunk_size(stream, 3);
+    zfp_field_set_pointer(field, f);
+    zfp_stream_rewind(stream);
+    zfp_write_header(stream, field, ZFP_HEADER_FULL);
+    size_t bytes = zfp_compress(stream, field);
+    zfp_stream_set_execution(stream, zfp_exec_serial);
+    bool pass = true;
+    // compress one slab at a time
+    if (mode < 2) {
+      sink out = { buffer + bufsize, 0 };
+      zfp_slab_writer* writer = zfp_slab_writer_open(stream, field, ZFP_HEADER_FULL, write_sink, &out);
+      pass = writer != 0;
+      for (uint z = 0; pass && z < nz; z += 4)
+        pass = zfp_slab_writer_append(writer, f + nx * ny * z) != 0;
+      pass = writer && zfp_slab_writer_close(writer) == bytes && pass;
+      pass = pass && out.size == bytes && std::equal(buffer, buffer + bytes, buffer + bufsize);
+    }
+    // decompress one slab at a time with metadata taken from header
+    zfp_stream_rewind(stream);
+    zfp_read_header(stream, field, ZFP_HEADER_FULL);
+    zfp_field_set_pointer(field, g);
+    pass = pass && zfp_decompress(stream, field) == bytes;
+    zfp_field* meta = zfp_field_alloc();
+    sink in = { buffer, bytes };
+    zfp_slab_reader* reader = zfp_slab_reader_open(stream, meta, ZFP_HEADER_FULL, read_source, &in);
+    pass = pass && reader && zfp_field_size(meta, NULL) == nx * ny * nz;
+    for (uint z = 0; pass && z < nz; z += 4) {
+      uint layers = zfp_slab_reader_read(reader, h);
+      pass = layers == std::min(nz - z, 4u) && std::equal(h, h + nx * ny * layers, g + nx * ny * z);
+    }
+    pass = pass && !zfp_slab_reader_read(reader, h);
+    pass = reader && zfp_slab_reader_close(reader) == bytes && pass;
+    zfp_field_free(meta);
+    if (!pass) {
+      std::cout << "streaming compression mismatch in mode " << mode << std::endl;
+      failures++;
+    }
+  }
+  stream_close(s);
+  zfp_stream_close(stream);
+  zfp_field_free(field);
+  delete[] buffer;
+  delete[] h;
+  delete[] g;
+  delete[] f;
+  return failures;
+}
+
+// tasks deferred until after (de)compression has completed
+struct deferred {
+  void (*task[64])(void*);
+  void* data[64];
+  uint count;
+};
+
+static void
+submit_deferred(void* user, void (*task)(void*), void* data)
+{
+  deferred* d = static_cast<deferred*>(user);
+  if (d->count < 64) {
+    d->task[d->count] = task;
+    d->data[d->count] = data;
+    d->count++;
+  }
+  else
+    task(data);
+}
+
+// test thread pool execution against serial execution
+inline uint
+test_threads()
+{
+  uint failures = 0;
+  const uint nx = 29, ny = 14, nz = 11;
+  float* f = new float[nx * ny * nz];
+  float* g = new float[nx * ny * nz];
+  float* h = new float[nx * ny * nz];
+  for (uint i = 0; i < nx * ny * nz; i++)
+    f[i] = float(std::sin(0.1 * i) * std::cos(0.03 * i));
+  zfp_field* field = zfp_field_3d(f, zfp_type_float, nx, ny, nz);
+  zfp_stream* stream = zfp_stream_open(NULL);
+  size_t bufsize = 2 * nx * ny * nz * sizeof(float);
+  uchar* buffer = new uchar[bufsize];
+  bitstream* s = stream_open(buffer, bufsize);
+  zfp_stream_set_bit_stream(stream, s);
+  for (uint mode = 0; mode < 4; mode++) {
+    // fixed rate or fixed accuracy with index, run on pool or deferred tasks
+    if (mode & 1u)
+      zfp_stream_set_accuracy(stream, 1e-3);
+    else
+      zfp_stream_set_rate(stream, 11, zfp_type_float, 3, 0);
+    zfp_stream_set_index(stream, mode & 1u);
+    // serial reference
+    zfp_stream_set_execution(stream, zfp_exec_serial);
+    zfp_field_set_pointer(field, f);
+    zfp_stream_rewind(stream);
+    zfp_compress(stream, field);
+    zfp_field_set_pointer(field, g);
+    zfp_stream_rewind(stream);
+    zfp_decompress(stream, field);
+    // parallel compression and decompression
+    deferred tasks;
+    tasks.count = 0;
+    if (!zfp_stream_set_thread_count(stream, 4))
+      break;
+    zfp_stream_set_thread_chunk_size(stream, 5);
+    if (mode & 2u)
+      zfp_stream_set_thread_submit(stream, submit_deferred, &tasks);
+    zfp_field_set_pointer(field, f);
+    zfp_stream_rewind(stream);
+    size_t bytes = zfp_compress(stream, field);
+    zfp_field_set_pointer(field, h);
+    zfp_stream_rewind(stream);
+    bool pass = bytes && zfp_decompress(stream, field) == bytes && std::equal(g, g + nx * ny * nz, h);
+    // serial decompression of parallel stream
+    std::fill(h, h + nx * ny * nz, 0.0f);
+    zfp_stream_set_execution(stream, zfp_exec_serial);
+    zfp_stream_rewind(stream);
+    pass = pass && zfp_decompress(stream, field) == bytes && std::equal(g, g + nx * ny * nz, h);
+    // run tasks that started too late to find work
+    for (uint i = 0; i < tasks.count; i++)
+      tasks.task[i](tasks.data[i]);
+    if (!pass) {
+      std::cout << "thread pool execution mismatch in mode " << mode << std::endl;
+      failures++;
+    }
+  }
+  stream_close(s);
+  zfp_stream_close(stream);
+  zfp_field_free(field);
+  delete[] buffer;
+  delete[] h;
+  delete[] g;
+  delete[] f;
+  return failures;
+}
+
+// test word-aligned chunk layout compressed in place and via copies
+inline uint
+test_aligned()
+{
+  uint failures = 0;
+  const uint nx = 21, ny = 18, nz = 11;
+  const uint x0 = 6, y0 = 5, z0 = 3;
+  const uint mx = 9, my = 8, mz = 6;
+  float* f = new float[nx * ny * nz];
+  float* g = new float[nx * ny * nz];
+  float* h = new float[nx * ny * nz];
+  for (uint i = 0; i < nx * ny * nz; i++)
+    f[i] = float(std::sin(0.1 * i) * std::cos(0.03 * i));
+  zfp_field* field = zfp_field_3d(f, zfp_type_float, nx, ny, nz);
+  zfp_stream* stream = zfp_stream_open(NULL);
+  for (uint mode = 0; mode < 3; mode++) {
+    // fixed rate with and without padding between chunks, and fixed accuracy
+    if (mode == 0)
+      zfp_stream_set_rate(stream, 10.5, zfp_type_float, 3, 0);
+    else if (mode == 1)
+      zfp_stream_set_rate(stream, 16, zfp_type_float, 3, 0);
+    else
+      zfp_stream_set_accuracy(stream, 1e-3);
+    // serial reference
+    size_t bufsize = zfp_stream_maximum_size(stream, field);
+    uchar* buffer = new uchar[bufsize];
+    bitstream* s = stream_open(buffer, bufsize);
+    zfp_stream_set_bit_stream(stream, s);
+    zfp_stream_set_execution(stream, zfp_exec_serial);
+    zfp_stream_set_index(stream, ZFP_INDEX_NONE);
+    zfp_field_set_pointer(field, f);
+    zfp_stream_rewind(stream);
+    zfp_compress(stream, field);
+    zfp_field_set_pointer(field, g);
+    zfp_stream_rewind(stream);
+    zfp_decompress(stream, field);
+    stream_close(s);
+    delete[] buffer;
+    // compress in place within worst-case buffer
+    zfp_stream_set_index(stream, ZFP_INDEX_ALIGNED);
+    if (zfp_stream_set_execution(stream, zfp_exec_omp))
+      zfp_stream_set_omp_chunk_size(stream, 5);
+    else if (zfp_stream_set_thread_count(stream, 3))
+      zfp_stream_set_thread_chunk_size(stream, 5);
+    bufsize = zfp_stream_maximum_size(stream, field);
+    buffer = new uchar[bufsize];
+    s = stream_open(buffer, bufsize);
+    zfp_stream_set_bit_stream(stream, s);
+    zfp_field_set_pointer(field, f);
+    size_t bytes = zfp_compress(stream, field);
+    // compress into buffer too small to hold chunks in place
+    uchar* copy = new uchar[bytes];
+    bitstream* t = stream_open(copy, bytes);
+    zfp_stream_set_bit_stream(stream, t);
+    bool pass = bytes && zfp_compress(stream, field) == bytes && std::equal(buffer, buffer + bytes, copy);
+    // decompress in parallel, serially, and by region
+    zfp_field_set_pointer(field, h);
+    zfp_stream_rewind(stream);
+    pass = pass && zfp_decompress(stream, field) == bytes && std::equal(g, g + nx * ny * nz, h);
+    std::fill(h, h + nx * ny * nz, 0.0f);
+    zfp_stream_set_execution(stream, zfp_exec_serial);
+    zfp_stream_rewind(stream);
+    pass = pass && zfp_decompress(stream, field) == bytes && std::equal(g, g + nx * ny * nz, h);
+    zfp_stream_rewind(stream);
+    pass = pass && zfp_decompress_region(stream, field, x0, y0, z0, mx, my, mz) != 0;
+    for (uint z = 0; z < mz; z++)
+      for (uint y = 0; y < my; y++)
+        for (uint x = 0; x < mx; x++)
+          if (h[x + mx * (y + my * z)] != g[(x0 + x) + nx * ((y0 + y) + ny * (z0 + z))])
+            pass = false;
+    if (!pass) {
+      std::cout << "aligned chunk layout mismatch in mode " << mode << std::endl;
+      failures++;
+    }
+    stream_close(t);
+    stream_close(s);
+    delete[] copy;
+    delete[] buffer;
+  }
+  zfp_stream_close(stream);
+  zfp_field_free(field);
+  delete[] h;
+  delete[] g;
+  delete[] f;
+  return failures;
+}
+
+// test chunked frames with appended chunks, truncation, and corruption
+inline uint
+test_frame()
+{
+  uint failures = 0;
+  const uint nx = 20, ny = 15, nz = 9, n = 1000;
+  float* f = new float[nx * ny * nz];
+  float* g = new float[nx * ny * nz];
+  double* d = new double[n];
+  double* e = new double[n];
+  for (uint i = 0; i < nx * ny * nz; i++)
+    f[i] = float(std::sin(0.1 * i) * std::cos(0.03 * i));
+  for (uint i = 0; i < n; i++)
+    d[i] = std::cos(0.01 * i);
+  zfp_field* field = zfp_field_3d(f, zfp_type_float, nx, ny, nz);
+  zfp_field* line = zfp_field_1d(d, zfp_type_double, n);
+  zfp_stream* stream = zfp_stream_open(NULL);
+  size_t bufsize = 3 * (nx * ny * nz * sizeof(float) + n * sizeof(double) + 64);
+  uchar* buffer = new uchar[bufsize];
+  bitstream* s = stream_open(buffer, bufsize);
+  zfp_stream_set_bit_stream(stream, s);
+  // fixed rate chunk and checksummed fixed accuracy chunk with index
+  zfp_frame_writer* writer = zfp_frame_writer_open(stream, 0);
+  zfp_stream_set_rate(stream, 16, zfp_type_float, 3, 0);
+  bool pass = zfp_frame_writer_append(writer, field, 0) != 0;
+  zfp_stream_set_accuracy(stream, 1e-3);
+  zfp_stream_set_index(stream, ZFP_INDEX_ALIGNED);
+  zfp_stream_set_execution(stream, zfp_exec_omp);
+  pass = pass && zfp_frame_writer_append(writer, field, ZFP_FRAME_CHECKSUM) != 0;
+  size_t bytes = zfp_frame_writer_close(writer);
+  // append checksummed fixed precision chunk to existing frame
+  zfp_stream_set_execution(stream, zfp_exec_serial);
+  zfp_stream_set_index(stream, ZFP_INDEX_NONE);
+  zfp_stream_set_precision(stream, 24);
+  zfp_stream_rewind(stream);
+  writer = zfp_frame_writer_open(stream, bytes);
+  pass = pass && writer && zfp_frame_writer_append(writer, line, ZFP_FRAME_CHECKSUM) != 0;
+  size_t size = zfp_frame_writer_close(writer);
+  // decompress chunks in reverse order
+  zfp_stream_rewind(stream);
+  zfp_frame_reader* reader = zfp_frame_reader_open(stream, size);
+  pass = pass && reader && zfp_frame_reader_chunks(reader) == 3;
+  for (uint c = 3; pass && c-- > 0;) {
+    zfp_field* h = zfp_field_alloc();
+    pass = zfp_frame_reader_field(reader, c, h) && zfp_field_dimensionality(h) == (c == 2 ? 1u : 3u);
+    zfp_field_set_pointer(h, c == 2 ? (void*)e : (void*)g);
+    pass = pass && zfp_frame_reader_decompress(reader, c, h) != 0;
+    if (c == 2)
+      for (uint i = 0; i < n; i++)
+        pass = pass && std::fabs(d[i] - e[i]) < 1e-5;
+    else
+      for (uint i = 0; i < nx * ny * nz; i++)
+        pass = pass && std::fabs(f[i] - g[i]) < 1e-3;
+    zfp_field_free(h);
+  }
+  // chunk type and dimensions must match field
+  pass = pass && !zfp_frame_reader_decompress(reader, 2, field);
+  if (reader)
+    zfp_frame_reader_close(reader);
+  // recover first two chunks of frame truncated within third chunk
+  zfp_stream_rewind(stream);
+  reader = zfp_frame_reader_open(stream, bytes - 32 + 48);
+  pass = pass && reader && zfp_frame_reader_chunks(reader) == 2;
+  zfp_field_set_pointer(field, g);
+  pass = pass && zfp_frame_reader_decompress(reader, 1, field) != 0;
+  if (reader)
+    zfp_frame_reader_close(reader);
+  // detect corruption of checksummed chunk
+  buffer[bytes - 40] ^= 1;
+  zfp_stream_rewind(stream);
+  reader = zfp_frame_reader_open(stream, size);
+  pass = pass && reader && zfp_frame_reader_chunks(reader) == 3;
+  pass = pass && zfp_frame_reader_decompress(reader, 0, field) != 0;
+  pass = pass && !zfp_frame_reader_decompress(reader, 1, field);
+  if (reader)
+    zfp_frame_reader_close(reader);
+  if (!pass) {
+    std::cout << "chunked frame mismatch" << std::endl;
+    failures++;
+  }
+  stream_close(s);
+  zfp_stream_close(stream);
+  zfp_field_free(line);
+  zfp_field_free(field);
+  delete[] buffer;
+  delete[] e;
+  delete[] d;
+  delete[] g;
+  delete[] f;
+  return failures;
+}
+
+// test progressive layout against fixed-rate compression at lower rates
+inline uint
+test_progressive()
+{
+  uint failures = 0;
+  const uint nx = 19, ny = 14, nz = 10;
+  float* f = new float[nx * ny * nz];
+  float* g = new float[nx * ny * nz];
+  float* h = new float[nx * ny * nz];
+  for (uint i = 0; i < nx * ny * nz; i++)
+    f[i] = float(std::sin(0.1 * i) * std::cos(0.03 * i));
+  zfp_field* field = zfp_field_3d(f, zfp_type_float, nx, ny, nz);
+  zfp_stream* stream = zfp_stream_open(NULL);
+  zfp_stream_set_rate(stream, 16, zfp_type_float, 3, 0);
+  size_t bufsize = zfp_stream_maximum_size(stream, field);
+  uchar* buffer = new uchar[bufsize];
+  uchar* layers = new uchar[bufsize];
+  bitstream* s = stream_open(buffer, bufsize);
+  bitstream* t = stream_open(layers, bufsize);
+  zfp_stream_set_bit_stream(stream, t);
+  size_t bytes = zfp_compress_progressive(stream, field);
+  bool pass = bytes != 0;
+  // prefixes of whole layers match compression at corresponding rate
+  for (uint rate = 4; rate <= 16; rate += 4) {
+    zfp_stream_set_rate(stream, rate, zfp_type_float, 3, 0);
+    zfp_stream_set_bit_stream(stream, s);
+    zfp_field_set_pointer(field, f);
+    zfp_stream_rewind(stream);
+    zfp_compress(stream, field);
+    zfp_field_set_pointer(field, g);
+    zfp_stream_rewind(stream);
+    zfp_decompress(stream, field);
+    zfp_stream_set_rate(stream, 16, zfp_type_float, 3, 0);
+    zfp_stream_set_bit_stream(stream, t);
+    zfp_field_set_pointer(field, h);
+    zfp_stream_rewind(stream);
+    pass = pass && zfp_decompress_progressive(stream, field, bytes * rate / 16) != 0;
+    pass = pass && std::equal(g, g + nx * ny * nz, h);
+  }
+  // partial layers and exhausted budget reconstruct every block
+  double error[2];
+  for (uint i = 0; i < 2; i++) {
+    zfp_stream_rewind(stream);
+    pass = pass && zfp_decompress_progressive(stream, field, i ? bytes / 2 + 100 : 7) != 0;
+    error[i] = 0;
+    for (uint j = 0; j < nx * ny * nz; j++)
+      error[i] = std::max(error[i], double(std::fabs(f[j] - h[j])));
+  }
+  pass = pass && error[1] < 4e-2 && error[1] < error[0];
+  if (!pass) {
+    std::cout << "progressive layout mismatch" << std::endl;
+    failures++;
+  }
+  stream_close(t);
+  stream_close(s);
+  zfp_stream_close(stream);
+  zfp_field_free(field);
+  delete[] layers;
+  delete[] buffer;
+  delete[] h;
+  delete[] g;
+  delete[] f;
+  return failures;
+}
+
+// compress and decompress 2^12 values in reversible mode; return compressed size
+template <typename Scalar>
+inline size_t
+reversible_size(const Scalar* f, zfp_type type, uint dims)
+{
+  const uint n = 1u << (12 / dims);
+  Scalar* g = new Scalar[0x1000];
+  zfp_field* field = zfp_field_alloc();
+  zfp_field_set_type(field, type);
+  zfp_field_set_pointer(field, const_cast<Scalar*>(f));
+  switch (dims) {
+    case 1: zfp_field_set_size_1d(field, n); break;
+    case 2: zfp_field_set_size_2d(field, n, n); break;
+    case 3: zfp_field_set_size_3d(field, n, n, n); break;
+    case 4: zfp_field_set_size_4d(field, n, n, n, n); break;
+  }
+  zfp_stream* stream = zfp_stream_open(NULL);
+  zfp_stream_set_reversible(stream);
+  size_t bufsize = zfp_stream_maximum_size(stream, field);
+  uchar* buffer = new uchar[bufsize];
+  bitstream* s = stream_open(buffer, bufsize);
+  zfp_stream_set_bit_stream(stream, s);
+  size_t bytes = zfp_write_header(stream, field, ZFP_HEADER_FULL) ? zfp_compress(stream, field) : 0;
+  // mode is recovered from header and values are reproduced bit for bit
+  zfp_stream_set_accuracy(stream, 1e-3);
+  zfp_field_set_pointer(field, g);
+  zfp_stream_rewind(stream);
+  if (!bytes || !zfp_read_header(stream, field, ZFP_HEADER_FULL) ||
+      zfp_stream_compression_mode(stream) != zfp_mode_reversible ||
+      zfp_decompress(stream, field) != bytes ||
+      std::memcmp(f, g, 0x1000 * sizeof(Scalar)))
+    bytes = 0;
+  stream_close(s);
+  zfp_stream_close(stream);
+  zfp_field_free(field);
+  delete[] buffer;
+  delete[] g;
+  return bytes;
+}
+
+inline uint
+test_reversible()
+{
+  uint failures = 0;
+  const uint n = 0x1000;
+  float* f = new float[n];
+  double* d = new double[n];
+  int32* i = new int32[n];
+  int64* l = new int64[n];
+  bool pass = true;
+  for (uint dims = 1; dims <= 4; dims++) {
+    // smooth multidimensional data compresses
+    for (uint j = 0; j < n; j++) {
+      uint k = 12 / dims;
+      uint x = j & ((1u << k) - 1);
+      uint y = (j >> k) & ((1u << k) - 1);
+      uint z = (j >> (2 * k)) & ((1u << k) - 1);
+      uint w = j >> (3 * k);
+      d[j] = std::sin(0.05 * x + 0.1 * y) * std::cos(0.15 * z + 0.2 * w);
+      f[j] = float(d[j]);
+      i[j] = int32(std::floor(1e6 * d[j]));
+      l[j] = int64(std::floor(1e15 * d[j]));
+    }
+    size_t bytes[4] = {
+      reversible_size(f, zfp_type_float, dims),
+      reversible_size(d, zfp_type_double, dims),
+      reversible_size(i, zfp_type_int32, dims),
+      reversible_size(l, zfp_type_int64, dims),
+    };
+    pass = pass && bytes[0] && bytes[1] && bytes[2] && bytes[3];
+    if (dims > 1) {
+      pass = pass && bytes[0] < n * sizeof(float);
+      pass = pass && bytes[1] < n * sizeof(double);
+      pass = pass && bytes[2] < n * sizeof(int32);
+      pass = pass && bytes[3] < n * sizeof(int64);
+    }
+    // special values and extreme integers survive the round trip
+    for (uint j = 0; j < n; j += 37) {
+      switch (j % 5) {
+        case 0:
+          f[j] = -0.0f;
+          d[j] = -0.0;
+          break;
+        case 1:
+          f[j] = std::numeric_limits<float>::quiet_NaN();
+          d[j] = std::numeric_limits<double>::quiet_NaN();
+          break;
+        case 2:
+          f[j] = std::numeric_limits<float>::denorm_min();
+          d[j] = std::numeric_limits<double>::denorm_min();
+          break;
+        case 3:
+          f[j] = -std::numeric_limits<float>::infinity();
+          d[j] = -std::numeric_limits<double>::infinity();
+          break;
+        case 4:
+          f[j] = std::numeric_limits<float>::max();
+          d[j] = -std::numeric_limits<double>::max();
+          break;
+      }
+      i[j] = j & 1u ? std::numeric_limits<int32>::min() : std::numeric_limits<int32>::max();
+      l[j] = j & 1u ? std::numeric_limits<int64>::min() : std::numeric_limits<int64>::max();
+    }
+    for (uint j = 0; j < 256; j++) {
+      f[j] = 0;
+      d[j] = std::ldexp(double(j), -1070);
+    }
+    pass = pass && reversible_size(f, zfp_type_float, dims);
+    pass = pass && reversible_size(d, zfp_type_double, dims);
+    pass = pass && reversible_size(i, zfp_type_int32, dims);
+    pass = pass && reversible_size(l, zfp_type_int64, dims);
+  }
+  if (!pass) {
+    std::cout << "reversible mode is not lossless" << std::endl;
+    failures++;
+  }
+  delete[] l;
+  delete[] i;
+  delete[] d;
+  delete[] f;
+  return failures;
+}
+
+inline uint
+test_kernels()
+{
+  uint failures = 0;
+  const uint nx = 21, ny = 18, nz = 11, n = nx * ny * nz;
+  double* f = new double[n];
+  double* g = new double[n];
+  double* h = new double[n];
+  for (uint i = 0; i < n; i++)
+    f[i] = std::sin(0.1 * i) * std::cos(0.03 * i);
+  zfp_field* field = zfp_field_3d(f, zfp_type_double, nx, ny, nz);
+  zfp_stream* stream = zfp_stream_open(NULL);
+  zfp_stream_set_accuracy(stream, 1e-6);
+  size_t bufsize = zfp_stream_maximum_size(stream, field);
+  uchar* buffer[2] = { new uchar[bufsize], new uchar[bufsize] };
+  bitstream* s = stream_open(buffer[0], bufsize);
+  zfp_stream_set_bit_stream(stream, s);
+  // generic kernel is always available and unknown kernels are rejected
+  bool pass = zfp_stream_set_kernel(stream, zfp_kernel_generic) && zfp_stream_kernel(stream) == zfp_kernel_generic;
+  pass = pass && !zfp_stream_set_kernel(stream, zfp_kernel(3)) && zfp_stream_kernel(stream) == zfp_kernel_generic;
+  size_t bytes = zfp_compress(stream, field);
+  zfp_field_set_pointer(field, g);
+  zfp_stream_rewind(stream);
+  pass = pass && bytes && zfp_decompress(stream, field) == bytes;
+  // every other supported kernel produces identical output
+  const zfp_kernel kernel[] = { zfp_kernel_avx2, zfp_kernel_avx512 };
+  for (uint k = 0; k < 2; k++) {
+    if (!zfp_stream_set_kernel(stream, kernel[k]))
+      continue;
+    stream_close(s);
+    s = stream_open(buffer[1], bufsize);
+    zfp_stream_set_bit_stream(stream, s);
+    zfp_field_set_pointer(field, f);
+    pass = pass && zfp_compress(stream, field) == bytes && std::equal(buffer[0], buffer[0] + bytes, buffer[1]);
+    zfp_field_set_pointer(field, h);
+    zfp_stream_rewind(stream);
+    pass = pass && zfp_decompress(stream, field) == bytes && std::equal(g, g + n, h);
+  }
+  if (!pass) {
+    std::cout << "codec kernel mismatch" << std::endl;
+    failures++;
+  }
+  stream_close(s);
+  zfp_stream_close(stream);
+  zfp_field_free(field);
+  delete[] buffer[1];
+  delete[] buffer[0];
+  delete[] h;
+  delete[] g;
+  delete[] f;
+  return failures;
+}
+
+// test encoder statistics, which parallel compression must merge exactly
+inline uint
+test_profile()
+{
+  uint failures = 0;
+  const uint nx = 21, ny = 18, nz = 11, n = nx * ny * nz;
+  double* f = new double[n];
+  // first layer of blocks is all zeros
+  for (uint i = 0; i < n; i++)
+    f[i] = i < 4 * nx * ny ? 0 : std::sin(0.1 * i) * std::cos(0.03 * i);
+  zfp_field* field = zfp_field_3d(f, zfp_type_double, nx, ny, nz);
+  zfp_stream* stream = zfp_stream_open(NULL);
+  zfp_stream_set_accuracy(stream, 1e-6);
+  size_t bufsize = zfp_stream_maximum_size(stream, field);
+  uchar* buffer = new uchar[bufsize];
+  bitstream* s = stream_open(buffer, bufsize);
+  zfp_stream_set_bit_stream(stream, s);
+  zfp_stats stats[2];
+  std::memset(stats, 0, sizeof(stats));
+  bool pass = true;
+  if (zfp_stream_set_stats(stream, &stats[0])) {
+    pass = zfp_stream_stats(stream) == &stats[0] && zfp_compress(stream, field);
+    uint64 blocks = 0;
+    for (uint i = 0; i < ZFP_STATS_BINS; i++)
+      blocks += stats[0].histogram[i];
+    pass = pass && stats[0].blocks == 6 * 5 * 3 && blocks == stats[0].blocks;
+    pass = pass && stats[0].zero_blocks == 6 * 5 && stats[0].planes > 0;
+    // parallel compression gathers the same counts
+    const zfp_exec_policy policy[] = { zfp_exec_omp, zfp_exec_threads };
+    for (uint p = 0; p < 2; p++) {
+      if (!zfp_stream_set_execution(stream, policy[p]))
+        continue;
+      std::memset(&stats[1], 0, sizeof(stats[1]));
+      zfp_stream_set_stats(stream, &stats[1]);
+      zfp_stream_rewind(stream);
+      pass = pass && zfp_compress(stream, field);
+      pass = pass && stats[1].blocks == stats[0].blocks && stats[1].zero_blocks == stats[0].zero_blocks && stats[1].planes == stats[0].planes;
+      pass = pass && std::equal(stats[0].histogram, stats[0].histogram + ZFP_STATS_BINS, stats[1].histogram);
+    }
+    // arrays merge the statistics of per-thread streams
+    std::memset(stats, 0, sizeof(stats));
+    zfp::array3d a(nx, ny, nz, 16);
+    zfp::array3d b(nx, ny, nz, 16);
+    pass = pass && a.set_stats(&stats[0]) && b.set_stats(&stats[1]);
+    b.set_execution(zfp_exec_omp);
+    a.set(f);
+    b.set(f);
+    pass = pass && stats[0].blocks == 6 * 5 * 3 && stats[1].blocks == stats[0].blocks && stats[1].zero_blocks == stats[0].zero_blocks && stats[1].planes == stats[0].planes;
+    pass = pass && std::equal(stats[0].histogram, stats[0].histogram + ZFP_STATS_BINS, stats[1].histogram);
+  }
+  else {
+    // without profiling, no statistics can be attached or gathered
+    pass = !zfp_stream_stats(stream) && zfp_stream_set_stats(stream, NULL) && zfp_compress(stream, field) && !stats[0].blocks;
+  }
+  if (!pass) {
+    std::cout << "encoder statistics mismatch" << std::endl;
+    failures++;
+  }
+  stream_close(s);
+  zfp_stream_close(stream);
+  zfp_field_free(field);
+  delete[] buffer;
+  delete[] f;
+  return failures;
+}
+
 int main(int argc, char* argv[])
 {
   std::cout << zfp_version_string << std::endl;
@@ -993,6 +2510,18 @@ int main(int argc, char* argv[])
 
   // test library and compiler
   uint failures = common_tests();
+  failures += test_skip_zeros();
+  failures += test_blocks();
+  failures += test_region();
+  failures += test_omp_timings();
+  failures += test_slabs();
+  failures += test_threads();
+  failures += test_aligned();
+  failures += test_frame();
+  failures += test_progressive();
+  failures += test_reversible();
+  failures += test_kernels();
+  failures += test_profile();
   if (failures)
     return EXIT_FAILURE;
 
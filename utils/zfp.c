@@ -104,6 +104,7 @@ usage()
   fprintf(stderr, "  -r <rate> : fixed rate (# compressed bits per floating-point value)\n");
   fprintf(stderr, "  -p <precision> : fixed precision (# uncompressed bits per value)\n");
   fprintf(stderr, "  -a <tolerance> : fixed accuracy (absolute error tolerance)\n");
+  fprintf(stderr, "  -R : reversible (lossless) compression\n");
   fprintf(stderr, "  -c <minbits> <maxbits> <maxprec> <minexp> : advanced usage\n");
   fprintf(stderr, "      minbits : min # bits per 4^d values in d dimensions\n");
   fprintf(stderr, "      maxbits : max # bits per 4^d values in d dimensions (0 for unlimited)\n");
@@ -111,7 +112,7 @@ usage()
   fprintf(stderr, "      minexp : min bit plane # coded (-1074 for all bit planes)\n");
   fprintf(stderr, "Execution parameters:\n");
   fprintf(stderr, "  -x serial : serial compression (default)\n");
-  fprintf(stderr, "  -x omp[=threads[,chunk_size]] : OpenMP parallel compression\n");
+  fprintf(stderr, "  -x omp[=threads[,chunk_size]] : OpenMP parallel compression (and fixed rate decompression)\n");
   fprintf(stderr, "  -x cuda : CUDA fixed rate parallel compression/decompression\n");
   fprintf(stderr, "Examples:\n");
   fprintf(stderr, "  -i file : read uncompressed file and compress to memory\n");
@@ -125,6 +126,7 @@ usage()
   fprintf(stderr, "  -d -1 1000000 -r 32 : 2x fixed-rate compression of 1M doubles\n");
   fprintf(stderr, "  -d -2 1000 1000 -p 32 : 32-bit precision compression of 1000x1000 doubles\n");
   fprintf(stderr, "  -d -1 1000000 -a 1e-9 : compression of 1M doubles with < 1e-9 max error\n");
+  fprintf(stderr, "  -d -1 1000000 -R : lossless compression of 1M doubles\n");
   fprintf(stderr, "  -d -1 1000000 -c 64 64 0 -1074 : 4x fixed-rate compression of 1M doubles\n");
   fprintf(stderr, "  -x omp=16,256 : parallel compression with 16 threads, 256-block chunks\n");
   exit(EXIT_FAILURE);
@@ -248,6 +250,9 @@ int main(int argc, char* argv[])
       case 'q':
         quiet = 1;
         break;
+      case 'R':
+        mode = 'R';
+        break;
       case 'r':
         if (++i == argc || sscanf(argv[i], "%lf", &rate) != 1)
           usage();
@@ -433,6 +438,9 @@ int main(int argc, char* argv[])
       case 'r':
         zfp_stream_set_rate(zfp, rate, type, dims, 0);
         break;
+      case 'R':
+        zfp_stream_set_reversible(zfp);
+        break;
       case 'c':
         if (!maxbits)
           maxbits = ZFP_MAX_BITS;
@@ -568,9 +576,14 @@ int main(int argc, char* argv[])
 
     /* specify execution policy */
     switch (exec) {
-      case zfp_exec_omp: 
-          fprintf(stderr, "OpenMP decompression not available\n");
+      case zfp_exec_omp:
+        if (!zfp_stream_set_execution(zfp, exec) ||
+            !zfp_stream_set_omp_threads(zfp, threads) ||
+            !zfp_stream_set_omp_chunk_size(zfp, chunk_size)) {
+          fprintf(stderr, "OpenMP execution not available\n");
           return EXIT_FAILURE;
+        }
+        break;
       case zfp_exec_cuda:
         if (!zfp_stream_set_execution(zfp, exec)) {
           fprintf(stderr, "cuda execution not available\n");
@@ -597,7 +610,7 @@ int main(int argc, char* argv[])
     /* decompress data */
     while (!zfp_decompress(zfp, field)) {
       /* fall back on serial decompression if execution policy not supported */
-      if (inpath && zfp_stream_execution(zfp) != zfp_exec_serial) {
+      if ((inpath || exec == zfp_exec_omp) && zfp_stream_execution(zfp) != zfp_exec_serial) {
         if (!zfp_stream_set_execution(zfp, zfp_exec_serial)) {
           fprintf(stderr, "cannot change execution policy\n");
           return EXIT_FAILURE;
@@ -0,0 +1,927 @@
+// zfp_bench: throughput sweep of the (de)compressor and compressed arrays
+
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
+#include "zfp.h"
+#include "zfparray1.h"
+#include "zfparray2.h"
+#include "zfparray3.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+// synthetic input fields
+enum Field {
+  field_smooth = 0, // separable product of sines
+  field_noisy  = 1, // smooth field plus 10% uniform noise
+  field_sparse = 2  // zero except for one in 64 values
+};
+
+static const char* const field_name[] = { "smooth", "noisy", "sparse" };
+static const char* const type_name[] = { "none", "int32", "int64", "float", "double" };
+static const char* const exec_name[] = { "serial", "omp", "cuda", "threads" };
+static const char* const kernel_name[] = { "generic", "avx2", "avx512" };
+
+// array cache replacement policies
+enum Policy {
+  policy_direct = 0, // direct-mapped
+  policy_twoway = 1, // two-way skew-associative
+  policy_lru    = 2, // 4-way set-associative LRU
+  policy_clock  = 3, // 4-way set-associative CLOCK
+  policy_arc    = 4  // 4-way set-associative ARC
+};
+
+static const char* const policy_name[] = { "direct", "twoway", "lru", "clock", "arc" };
+
+// array traversal orders
+enum Access {
+  access_sequential = 0, // first index varies fastest
+  access_strided    = 1, // last index varies fastest
+  access_random     = 2  // uniformly random
+};
+
+static const char* const access_name[] = { "sequential", "strided", "random" };
+
+// compression mode and its parameter
+struct Mode {
+  Mode(zfp_mode mode, double param) : mode(mode), param(param) {}
+  zfp_mode mode;
+  double param;
+};
+
+// result of compressing and decompressing one field
+struct CodecResult {
+  uint dims;               // dimensionality
+  uint n[4];               // field dimensions
+  zfp_type type;           // scalar type
+  Field field;             // synthetic field
+  zfp_mode mode;           // compression mode
+  double param;            // rate, precision, or tolerance
+  zfp_exec_policy exec;    // execution policy
+  uint threads;            // threads used (1 for serial)
+  size_t values;           // number of values
+  size_t blocks;           // number of blocks
+  size_t bytes;            // compressed size
+  double error;            // max error relative to field amplitude
+  double time[2];          // best compression and decompression time (0 if unsupported)
+  double serial[2];        // corresponding serial times
+};
+
+// result of traversing a compressed array
+struct ArrayResult {
+  uint dims;          // dimensionality
+  zfp_type type;      // scalar type
+  double rate;        // rate in bits/value
+  Policy policy;      // cache replacement policy
+  uint cache_blocks;  // requested cache size in blocks
+  size_t cache_bytes; // actual cache size in bytes
+  Access access;      // traversal order
+  bool write;         // write rather than read
+  size_t accesses;    // number of values accessed
+  double hit_rate;    // fraction of accesses that hit in the cache
+  double time;        // best traversal time
+};
+
+// benchmark settings
+struct Settings {
+  size_t values;              // approximate number of values per field
+  uint iterations;            // timed repetitions (best is reported)
+  uint threads;               // threads used by parallel execution policies
+  uint dims;                  // bit mask of dimensionalities to sweep
+  bool kernel;                // force codec kernel
+  zfp_kernel kernel_id;       // kernel to force
+  std::vector<double> rates;  // fixed rates to sweep
+  std::vector<uint> caches;   // array cache sizes in blocks
+  uint policies;              // bit mask of cache policies to sweep
+  bool codec;                 // benchmark (de)compressor
+  bool arrays;                // benchmark compressed arrays
+  bool quiet;                 // suppress table
+  const char* json;           // JSON output path (null for none, "-" for stdout)
+};
+
+// sink that keeps array reads from being optimized away
+static volatile double sink;
+
+// wall clock time in seconds
+static double
+now()
+{
+#if defined(_OPENMP)
+  return omp_get_wtime();
+#elif defined(__unix__) || defined(__APPLE__)
+  timeval t;
+  gettimeofday(&t, 0);
+  return t.tv_sec + 1e-6 * t.tv_usec;
+#else
+  return double(std::clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+// default number of threads, matching zfp's thread pool
+static uint
+default_threads()
+{
+#if defined(_OPENMP)
+  return omp_get_max_threads();
+#elif defined(__unix__) || defined(__APPLE__)
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n > 0 ? uint(n) : 1;
+#else
+  return 1;
+#endif
+}
+
+// pseudo-random number in [0, 2^31)
+inline uint
+random_uint(uint& seed)
+{
+  seed = 1103515245u * seed + 12345u;
+  return (seed >> 1) & 0x7fffffffu;
+}
+
+// pseudo-random number in [-1, 1)
+inline double
+random_double(uint& seed)
+{
+  return std::ldexp(double(random_uint(seed)), -30) - 1;
+}
+
+// field amplitude in units of the scalar type
+static double
+type_scale(zfp_type type)
+{
+  switch (type) {
+    case zfp_type_int32:
+      return std::ldexp(1.0, 24);
+    case zfp_type_int64:
+      return std::ldexp(1.0, 52);
+    default:
+      return 1;
+  }
+}
+
+// generate synthetic field of given shape
+template <typename Scalar>
+static void
+generate(Scalar* p, const uint* n, uint dims, Field field, double scale)
+{
+  const double pi = 3.14159265358979323846;
+  bool integer = scale != 1;
+  uint seed = 1;
+  uint c[4];
+  for (c[3] = 0; c[3] < n[3]; c[3]++)
+    for (c[2] = 0; c[2] < n[2]; c[2]++)
+      for (c[1] = 0; c[1] < n[1]; c[1]++)
+        for (c[0] = 0; c[0] < n[0]; c[0]++) {
+          double v = 1;
+          for (uint d = 0; d < dims; d++)
+            v *= std::sin(pi * (d + 2) * (c[d] + 0.5) / n[d]);
+          switch (field) {
+            case field_noisy:
+              v = 0.9 * v + 0.1 * random_double(seed);
+              break;
+            case field_sparse:
+              v = random_uint(seed) % 64 ? 0 : random_double(seed);
+              break;
+            default:
+              break;
+          }
+          *p++ = integer ? Scalar(std::floor(scale * v + 0.5)) : Scalar(v);
+        }
+}
+
+// maximum absolute difference between two arrays
+template <typename Scalar>
+static double
+max_error(const Scalar* p, const Scalar* q, size_t n)
+{
+  double e = 0;
+  for (size_t i = 0; i < n; i++) {
+    double d = std::fabs(double(p[i]) - double(q[i]));
+    if (d > e)
+      e = d;
+  }
+  return e;
+}
+
+static void
+generate(void* p, zfp_type type, const uint* n, uint dims, Field field)
+{
+  double scale = type_scale(type);
+  switch (type) {
+    case zfp_type_int32:
+      generate(static_cast<int32*>(p), n, dims, field, scale);
+      break;
+    case zfp_type_int64:
+      generate(static_cast<int64*>(p), n, dims, field, scale);
+      break;
+    case zfp_type_float:
+      generate(static_cast<float*>(p), n, dims, field, scale);
+      break;
+    case zfp_type_double:
+      generate(static_cast<double*>(p), n, dims, field, scale);
+      break;
+    default:
+      break;
+  }
+}
+
+static double
+max_error(const void* p, const void* q, zfp_type type, size_t n)
+{
+  double e = 0;
+  switch (type) {
+    case zfp_type_int32:
+      e = max_error(static_cast<const int32*>(p), static_cast<const int32*>(q), n);
+      break;
+    case zfp_type_int64:
+      e = max_error(static_cast<const int64*>(p), static_cast<const int64*>(q), n);
+      break;
+    case zfp_type_float:
+      e = max_error(static_cast<const float*>(p), static_cast<const float*>(q), n);
+      break;
+    case zfp_type_double:
+      e = max_error(static_cast<const double*>(p), static_cast<const double*>(q), n);
+      break;
+    default:
+      break;
+  }
+  return e / type_scale(type);
+}
+
+// field of n values split evenly across dims dimensions, in whole blocks
+static void
+shape(uint* n, uint dims, size_t values)
+{
+  uint side = uint(std::pow(double(values), 1.0 / dims) + 1e-6);
+  side = side < 4 ? 4 : side & ~3u;
+  for (uint d = 0; d < 4; d++)
+    n[d] = d < dims ? side : 1;
+}
+
+static zfp_field*
+make_field(void* p, zfp_type type, const uint* n, uint dims)
+{
+  switch (dims) {
+    case 1:
+      return zfp_field_1d(p, type, n[0]);
+    case 2:
+      return zfp_field_2d(p, type, n[0], n[1]);
+    case 3:
+      return zfp_field_3d(p, type, n[0], n[1], n[2]);
+    default:
+      return zfp_field_4d(p, type, n[0], n[1], n[2], n[3]);
+  }
+}
+
+static void
+set_mode(zfp_stream* zfp, const Mode& m, zfp_type type, uint dims)
+{
+  switch (m.mode) {
+    case zfp_mode_fixed_rate:
+      zfp_stream_set_rate(zfp, m.param, type, dims, 0);
+      break;
+    case zfp_mode_fixed_precision:
+      zfp_stream_set_precision(zfp, uint(m.param));
+      break;
+    case zfp_mode_fixed_accuracy:
+      zfp_stream_set_accuracy(zfp, m.param);
+      break;
+    default:
+      zfp_stream_set_reversible(zfp);
+      break;
+  }
+}
+
+// select execution policy; return false if unavailable
+static bool
+set_execution(zfp_stream* zfp, zfp_exec_policy exec, uint threads)
+{
+  switch (exec) {
+    case zfp_exec_omp:
+      return zfp_stream_set_omp_threads(zfp, threads);
+    case zfp_exec_threads:
+      return zfp_stream_set_thread_count(zfp, threads);
+    default:
+      return zfp_stream_set_execution(zfp, exec);
+  }
+}
+
+// best time of compressing field (0 if unsupported)
+static double
+time_compress(zfp_stream* zfp, const zfp_field* field, uint iterations, size_t& bytes)
+{
+  double best = 0;
+  for (uint i = 0; i < iterations; i++) {
+    zfp_stream_rewind(zfp);
+    double t = now();
+    bytes = zfp_compress(zfp, field);
+    t = now() - t;
+    if (!bytes)
+      return 0;
+    if (!i || t < best)
+      best = t;
+  }
+  return best;
+}
+
+// best time of decompressing field (0 if unsupported)
+static double
+time_decompress(zfp_stream* zfp, zfp_field* field, uint iterations)
+{
+  double best = 0;
+  for (uint i = 0; i < iterations; i++) {
+    zfp_stream_rewind(zfp);
+    double t = now();
+    size_t bytes = zfp_decompress(zfp, field);
+    t = now() - t;
+    if (!bytes)
+      return 0;
+    if (!i || t < best)
+      best = t;
+  }
+  return best;
+}
+
+// compress and decompress one field using each available execution policy
+static void
+bench_codec(std::vector<CodecResult>& results, const Settings& s, uint dims, zfp_type type, Field f, const Mode& m)
+{
+  const zfp_exec_policy policy[] = { zfp_exec_serial, zfp_exec_omp, zfp_exec_threads };
+  CodecResult r;
+  r.dims = dims;
+  shape(r.n, dims, s.values);
+  r.type = type;
+  r.field = f;
+  r.mode = m.mode;
+  r.param = m.param;
+  r.values = size_t(r.n[0]) * r.n[1] * r.n[2] * r.n[3];
+  r.blocks = r.values >> (2 * dims);
+
+  size_t size = r.values * zfp_type_size(type);
+  std::vector<unsigned char> in(size), out(size);
+  generate(&in[0], type, r.n, dims, f);
+  zfp_field* ifield = make_field(&in[0], type, r.n, dims);
+  zfp_field* ofield = make_field(&out[0], type, r.n, dims);
+
+  double serial[2] = { 0, 0 };
+  for (uint p = 0; p < sizeof(policy) / sizeof(*policy); p++) {
+    zfp_stream* zfp = zfp_stream_open(0);
+    if (s.kernel)
+      zfp_stream_set_kernel(zfp, s.kernel_id);
+    set_mode(zfp, m, type, dims);
+    r.exec = policy[p];
+    r.threads = r.exec == zfp_exec_serial ? 1 : s.threads;
+    if (!set_execution(zfp, r.exec, r.threads)) {
+      zfp_stream_close(zfp);
+      continue;
+    }
+    // parallel decompression of variable-rate streams needs chunk offsets
+    if (r.exec != zfp_exec_serial && m.mode != zfp_mode_fixed_rate)
+      zfp_stream_set_index(zfp, ZFP_INDEX_PACKED);
+
+    size_t capacity = zfp_stream_maximum_size(zfp, ifield);
+    void* buffer = std::malloc(capacity);
+    bitstream* stream = stream_open(buffer, capacity);
+    zfp_stream_set_bit_stream(zfp, stream);
+
+    std::memset(&out[0], 0, size);
+    r.bytes = 0;
+    r.time[0] = time_compress(zfp, ifield, s.iterations, r.bytes);
+    r.time[1] = r.time[0] ? time_decompress(zfp, ofield, s.iterations) : 0;
+    r.error = r.time[1] ? max_error(&in[0], &out[0], type, r.values) : 0;
+    if (r.exec == zfp_exec_serial) {
+      serial[0] = r.time[0];
+      serial[1] = r.time[1];
+    }
+    r.serial[0] = serial[0];
+    r.serial[1] = serial[1];
+
+    zfp_stream_close(zfp);
+    stream_close(stream);
+    std::free(buffer);
+
+    if (r.time[0])
+      results.push_back(r);
+  }
+
+  zfp_field_free(ifield);
+  zfp_field_free(ofield);
+}
+
+// best time of reading or writing every value of array once
+template <typename Scalar, class Array>
+static double
+time_array(Array& a, const Scalar* data, const std::vector<uint>& index, bool write, uint iterations)
+{
+  double best = 0;
+  size_t n = index.size();
+  for (uint i = 0; i < iterations; i++) {
+    a.flush_cache();
+    a.clear_cache();
+    double t = now();
+    if (write) {
+      for (size_t k = 0; k < n; k++)
+        a[index[k]] = data[index[k]];
+      a.flush_cache();
+    }
+    else {
+      double sum = 0;
+      for (size_t k = 0; k < n; k++)
+        sum += a[index[k]];
+      sink = sum;
+    }
+    t = now() - t;
+    if (!i || t < best)
+      best = t;
+  }
+  return best;
+}
+
+// fraction of accesses to array of shape n that hit in a cache of given
+// policy and number of lines, obtained by replaying the block accesses
+template <class CachePolicy>
+static double
+hit_rate(const std::vector<uint>& index, const uint* n, uint lines, bool write)
+{
+  Cache<char, CachePolicy> cache(lines);
+  uint bx = (n[0] + 3) / 4;
+  uint by = (n[1] + 3) / 4;
+  size_t hits = 0;
+  for (size_t k = 0; k < index.size(); k++) {
+    uint x = index[k];
+    uint i = x % n[0]; x /= n[0];
+    uint j = x % n[1]; x /= n[1];
+    uint b = (i / 4) + bx * ((j / 4) + by * (x / 4)) + 1;
+    char* p;
+    if (cache.access(p, b, write).index() == b)
+      hits++;
+  }
+  return double(hits) / index.size();
+}
+
+// traverse compressed array in each order using each cache size
+template <class CachePolicy, typename Scalar, class Array>
+static void
+bench_array(std::vector<ArrayResult>& results, const Settings& s, Array& a, const Scalar* data, const uint* shape, uint dims, double rate, Policy policy)
+{
+  size_t n = a.size();
+  std::vector<uint> index[3];
+  uint seed = 1;
+  uint c[3] = { 0, 0, 0 };
+  for (uint k = 0; k < 3; k++)
+    index[k].resize(n);
+  for (size_t k = 0; k < n; k++) {
+    index[access_sequential][k] = uint(k);
+    index[access_strided][k] = c[0] + shape[0] * (c[1] + shape[1] * c[2]);
+    index[access_random][k] = uint((size_t(random_uint(seed)) << 16 ^ random_uint(seed)) % n);
+    // advance last index fastest
+    for (uint d = dims - 1; ++c[d] == shape[d] && d; d--)
+      c[d] = 0;
+  }
+
+  ArrayResult r;
+  r.dims = dims;
+  r.type = zfp::codec<Scalar>::type;
+  r.rate = rate;
+  r.policy = policy;
+  r.accesses = n;
+  for (uint i = 0; i < s.caches.size(); i++) {
+    r.cache_blocks = s.caches[i];
+    a.set_cache_size(size_t(r.cache_blocks) * sizeof(Scalar) << (2 * dims));
+    r.cache_bytes = a.cache_size();
+    uint lines = uint(r.cache_bytes / (sizeof(Scalar) << (2 * dims)));
+    for (uint k = 0; k < 6; k++) {
+      r.access = Access(k % 3);
+      r.write = k / 3;
+      // strided and sequential traversals coincide in 1D
+      if (dims == 1 && r.access == access_strided)
+        continue;
+      r.hit_rate = hit_rate<CachePolicy>(index[r.access], shape, lines, r.write);
+      r.time = time_array(a, data, index[r.access], r.write, s.iterations);
+      results.push_back(r);
+    }
+  }
+}
+
+template <typename Scalar, class CachePolicy>
+static void
+bench_arrays(std::vector<ArrayResult>& results, const Settings& s, uint dims, double rate, Policy policy)
+{
+  typedef zfp::codec<Scalar> Codec;
+  uint n[4];
+  shape(n, dims, s.values);
+  size_t values = size_t(n[0]) * n[1] * n[2];
+  std::vector<Scalar> data(values);
+  generate(&data[0], n, dims, field_smooth, 1);
+  switch (dims) {
+    case 1: {
+      zfp::array1<Scalar, Codec, CachePolicy> a(n[0], rate, &data[0]);
+      bench_array<CachePolicy>(results, s, a, &data[0], n, dims, rate, policy);
+      } break;
+    case 2: {
+      zfp::array2<Scalar, Codec, CachePolicy> a(n[0], n[1], rate, &data[0]);
+      bench_array<CachePolicy>(results, s, a, &data[0], n, dims, rate, policy);
+      } break;
+    case 3: {
+      zfp::array3<Scalar, Codec, CachePolicy> a(n[0], n[1], n[2], rate, &data[0]);
+      bench_array<CachePolicy>(results, s, a, &data[0], n, dims, rate, policy);
+      } break;
+  }
+}
+
+template <typename Scalar>
+static void
+bench_arrays(std::vector<ArrayResult>& results, const Settings& s, uint dims, double rate)
+{
+  for (uint p = 0; p < sizeof(policy_name) / sizeof(*policy_name); p++) {
+    if (!(s.policies & (1u << p)))
+      continue;
+    switch (p) {
+      case policy_direct:
+        bench_arrays<Scalar, CacheDirectMapped>(results, s, dims, rate, Policy(p));
+        break;
+      case policy_twoway:
+        bench_arrays<Scalar, CacheTwoWay>(results, s, dims, rate, Policy(p));
+        break;
+      case policy_lru:
+        bench_arrays<Scalar, CacheLRU<4> >(results, s, dims, rate, Policy(p));
+        break;
+      case policy_clock:
+        bench_arrays<Scalar, CacheClock<4> >(results, s, dims, rate, Policy(p));
+        break;
+      case policy_arc:
+        bench_arrays<Scalar, CacheARC<4> >(results, s, dims, rate, Policy(p));
+        break;
+    }
+  }
+}
+
+static const char*
+mode_name(zfp_mode mode)
+{
+  switch (mode) {
+    case zfp_mode_fixed_rate:
+      return "rate";
+    case zfp_mode_fixed_precision:
+      return "precision";
+    case zfp_mode_fixed_accuracy:
+      return "accuracy";
+    default:
+      return "reversible";
+  }
+}
+
+// uncompressed throughput in GB/s
+inline double
+throughput(size_t values, zfp_type type, double time)
+{
+  return time ? 1e-9 * double(values * zfp_type_size(type)) / time : 0;
+}
+
+// parallel efficiency relative to serial execution
+inline double
+efficiency(double serial, double time, uint threads)
+{
+  return serial && time ? serial / (time * threads) : 0;
+}
+
+static void
+print_codec(FILE* file, const CodecResult& r)
+{
+  std::fprintf(file, "%ud %-6s %-6s %-10s %-8g %-7s %3u %7.3f bits/value",
+              r.dims, type_name[r.type], field_name[r.field], mode_name(r.mode), r.param, exec_name[r.exec], r.threads,
+              CHAR_BIT * double(r.bytes) / r.values);
+  for (uint i = 0; i < 2; i++)
+    if (r.time[i])
+      std::fprintf(file, " | %7.3f GB/s %8.1f ns/block %5.2f eff",
+                  throughput(r.values, r.type, r.time[i]), 1e9 * r.time[i] / r.blocks,
+                  efficiency(r.serial[i], r.time[i], r.threads));
+    else
+      std::fprintf(file, " | %-35s", "unsupported");
+  std::fprintf(file, " | %.3g error\n", r.error);
+}
+
+static void
+print_array(FILE* file, const ArrayResult& r)
+{
+  std::fprintf(file, "%ud %-6s rate=%-4g %-6s cache=%-6u (%9lu bytes) %-10s %-5s %6.2f%% hits %7.1f ns/value %7.3f GB/s\n",
+              r.dims, type_name[r.type], r.rate, policy_name[r.policy], r.cache_blocks, (unsigned long)r.cache_bytes,
+              access_name[r.access], r.write ? "write" : "read", 100 * r.hit_rate,
+              1e9 * r.time / r.accesses, throughput(r.accesses, r.type, r.time));
+}
+
+// write JSON number, or null if not finite or zero when optional
+static void
+json_number(FILE* file, double x, bool optional = false)
+{
+  if ((optional && !x) || x != x || x - x != 0)
+    std::fputs("null", file);
+  else
+    std::fprintf(file, "%.6g", x);
+}
+
+static void
+json_timing(FILE* file, const char* name, const CodecResult& r, uint i)
+{
+  std::fprintf(file, "\"%s\": {\"seconds\": ", name);
+  json_number(file, r.time[i], true);
+  std::fputs(", \"gb_per_s\": ", file);
+  json_number(file, throughput(r.values, r.type, r.time[i]), true);
+  std::fputs(", \"ns_per_block\": ", file);
+  json_number(file, 1e9 * r.time[i] / r.blocks, true);
+  std::fputs(", \"efficiency\": ", file);
+  json_number(file, efficiency(r.serial[i], r.time[i], r.threads), true);
+  std::fputs("}", file);
+}
+
+static void
+write_json(FILE* file, const Settings& s, zfp_kernel kernel, const std::vector<CodecResult>& codec, const std::vector<ArrayResult>& arrays)
+{
+  std::fprintf(file, "{\n");
+  std::fprintf(file, "  \"version\": \"%s\",\n", ZFP_VERSION_STRING);
+  std::fprintf(file, "  \"codec_version\": %u,\n", zfp_codec_version);
+  std::fprintf(file, "  \"stream_word_bits\": %u,\n", uint(stream_word_bits));
+  std::fprintf(file, "  \"kernel\": \"%s\",\n", kernel_name[kernel]);
+  std::fprintf(file, "  \"threads\": %u,\n", s.threads);
+  std::fprintf(file, "  \"iterations\": %u,\n", s.iterations);
+  std::fprintf(file, "  \"codec\": [");
+  for (size_t i = 0; i < codec.size(); i++) {
+    const CodecResult& r = codec[i];
+    std::fprintf(file, "%s\n    {\"dims\": %u, \"shape\": [", i ? "," : "", r.dims);
+    for (uint d = 0; d < r.dims; d++)
+      std::fprintf(file, "%s%u", d ? ", " : "", r.n[d]);
+    std::fprintf(file, "], \"type\": \"%s\", \"field\": \"%s\", \"mode\": \"%s\", \"param\": ",
+                 type_name[r.type], field_name[r.field], mode_name(r.mode));
+    json_number(file, r.param);
+    std::fprintf(file, ", \"exec\": \"%s\", \"threads\": %u, \"bytes\": %lu, \"bits_per_value\": ",
+                 exec_name[r.exec], r.threads, (unsigned long)r.bytes);
+    json_number(file, CHAR_BIT * double(r.bytes) / r.values);
+    std::fputs(", \"max_error\": ", file);
+    json_number(file, r.error);
+    std::fputs(", ", file);
+    json_timing(file, "compress", r, 0);
+    std::fputs(", ", file);
+    json_timing(file, "decompress", r, 1);
+    std::fputs("}", file);
+  }
+  std::fprintf(file, "\n  ],\n");
+  std::fprintf(file, "  \"array\": [");
+  for (size_t i = 0; i < arrays.size(); i++) {
+    const ArrayResult& r = arrays[i];
+    std::fprintf(file, "%s\n    {\"dims\": %u, \"type\": \"%s\", \"rate\": ", i ? "," : "", r.dims, type_name[r.type]);
+    json_number(file, r.rate);
+    std::fprintf(file, ", \"policy\": \"%s\", \"cache_blocks\": %u, \"cache_bytes\": %lu, \"access\": \"%s\", \"op\": \"%s\", \"hit_rate\": ",
+                 policy_name[r.policy], r.cache_blocks, (unsigned long)r.cache_bytes, access_name[r.access], r.write ? "write" : "read");
+    json_number(file, r.hit_rate);
+    std::fputs(", \"ns_per_value\": ", file);
+    json_number(file, 1e9 * r.time / r.accesses);
+    std::fputs(", \"gb_per_s\": ", file);
+    json_number(file, throughput(r.accesses, r.type, r.time));
+    std::fputs("}", file);
+  }
+  std::fprintf(file, "\n  ]\n}\n");
+}
+
+// parse comma-separated list of numbers
+template <typename T>
+static bool
+parse_list(std::vector<T>& list, const char* s)
+{
+  list.clear();
+  while (*s) {
+    char* end;
+    double x = std::strtod(s, &end);
+    if (end == s || x <= 0)
+      return false;
+    list.push_back(T(x));
+    s = *end == ',' ? end + 1 : end;
+    if (*end && *end != ',')
+      return false;
+  }
+  return !list.empty();
+}
+
+// parse comma-separated list of names into bit mask of their positions
+static bool
+parse_names(uint& mask, const char* s, const char* const* name, uint count)
+{
+  mask = 0;
+  while (*s) {
+    size_t n = std::strcspn(s, ",");
+    uint k;
+    for (k = 0; k < count; k++)
+      if (std::strlen(name[k]) == n && !std::strncmp(s, name[k], n))
+        break;
+    if (k == count)
+      return false;
+    mask |= 1u << k;
+    s += n;
+    if (*s && !*++s)
+      return false;
+  }
+  return mask != 0;
+}
+
+static int
+usage()
+{
+  std::fprintf(stderr, "%s\n", zfp_version_string);
+  std::fprintf(stderr, "Usage: zfp_bench <options>\n");
+  std::fprintf(stderr, "Options:\n");
+  std::fprintf(stderr, "  -n <count> : approximate number of values per field (default 1048576)\n");
+  std::fprintf(stderr, "  -i <count> : timed iterations; the fastest is reported (default 3)\n");
+  std::fprintf(stderr, "  -t <count> : threads used by parallel execution policies\n");
+  std::fprintf(stderr, "  -d <dims> : dimensionalities to sweep, e.g. 13 (default 1234)\n");
+  std::fprintf(stderr, "  -r <rate,...> : fixed rates to sweep (default 4,8,16)\n");
+  std::fprintf(stderr, "  -c <blocks,...> : array cache sizes in blocks (default 1,16,256)\n");
+  std::fprintf(stderr, "  -p <policy,...> : array cache policies (direct, twoway, lru, clock, arc; default all)\n");
+  std::fprintf(stderr, "  -k <kernel> : codec kernel (generic, avx2, avx512)\n");
+  std::fprintf(stderr, "  -C : benchmark (de)compressor only\n");
+  std::fprintf(stderr, "  -A : benchmark compressed arrays only\n");
+  std::fprintf(stderr, "  -q : do not print table of results\n");
+  std::fprintf(stderr, "  -j <path> : write results as JSON to path (- for stdout)\n");
+  std::fprintf(stderr, "Examples:\n");
+  std::fprintf(stderr, "  zfp_bench -d 3 -r 8 -j bench.json : sweep 3D fields at 8 bits/value\n");
+  std::fprintf(stderr, "  zfp_bench -C -n 16777216 -t 8 : (de)compress 2^24 values using 8 threads\n");
+  return EXIT_FAILURE;
+}
+
+int main(int argc, char* argv[])
+{
+  Settings s;
+  s.values = 1u << 20;
+  s.iterations = 3;
+  s.threads = default_threads();
+  s.dims = 0xfu;
+  s.kernel = false;
+  s.kernel_id = zfp_kernel_generic;
+  s.rates.push_back(4);
+  s.rates.push_back(8);
+  s.rates.push_back(16);
+  s.caches.push_back(1);
+  s.caches.push_back(16);
+  s.caches.push_back(256);
+  s.policies = (1u << (sizeof(policy_name) / sizeof(*policy_name))) - 1;
+  s.codec = true;
+  s.arrays = true;
+  s.quiet = false;
+  s.json = 0;
+
+  for (int i = 1; i < argc; i++) {
+    if (argv[i][0] != '-' || !argv[i][1] || argv[i][2])
+      return usage();
+    switch (argv[i][1]) {
+      case 'n': {
+        unsigned long n;
+        if (++i == argc || std::sscanf(argv[i], "%lu", &n) != 1 || !n)
+          return usage();
+        s.values = n;
+        } break;
+      case 'i':
+        if (++i == argc || std::sscanf(argv[i], "%u", &s.iterations) != 1 || !s.iterations)
+          return usage();
+        break;
+      case 't':
+        if (++i == argc || std::sscanf(argv[i], "%u", &s.threads) != 1 || !s.threads)
+          return usage();
+        break;
+      case 'd':
+        if (++i == argc || !*argv[i])
+          return usage();
+        s.dims = 0;
+        for (const char* p = argv[i]; *p; p++) {
+          if (*p < '1' || *p > '4')
+            return usage();
+          s.dims |= 1u << (*p - '1');
+        }
+        break;
+      case 'r':
+        if (++i == argc || !parse_list(s.rates, argv[i]))
+          return usage();
+        break;
+      case 'c':
+        if (++i == argc || !parse_list(s.caches, argv[i]))
+          return usage();
+        break;
+      case 'p':
+        if (++i == argc || !parse_names(s.policies, argv[i], policy_name, sizeof(policy_name) / sizeof(*policy_name)))
+          return usage();
+        break;
+      case 'k': {
+        if (++i == argc)
+          return usage();
+        uint k;
+        for (k = 0; k < sizeof(kernel_name) / sizeof(*kernel_name); k++)
+          if (!std::strcmp(argv[i], kernel_name[k]))
+            break;
+        if (k == sizeof(kernel_name) / sizeof(*kernel_name))
+          return usage();
+        s.kernel = true;
+        s.kernel_id = zfp_kernel(k);
+        } break;
+      case 'C':
+        s.arrays = false;
+        break;
+      case 'A':
+        s.codec = false;
+        break;
+      case 'q':
+        s.quiet = true;
+        break;
+      case 'j':
+        if (++i == argc)
+          return usage();
+        s.json = argv[i];
+        break;
+      default:
+        return usage();
+    }
+  }
+
+  // verify that kernel is available
+  zfp_stream* zfp = zfp_stream_open(0);
+  if (s.kernel && !zfp_stream_set_kernel(zfp, s.kernel_id)) {
+    std::fprintf(stderr, "codec kernel %s not available\n", kernel_name[s.kernel_id]);
+    zfp_stream_close(zfp);
+    return EXIT_FAILURE;
+  }
+  zfp_kernel kernel = zfp_stream_kernel(zfp);
+  zfp_stream_close(zfp);
+
+  // when writing JSON to stdout, print table to stderr
+  FILE* table = s.json && !std::strcmp(s.json, "-") ? stderr : stdout;
+  if (!s.quiet)
+    std::fprintf(table, "%s, kernel %s, %u threads\n", zfp_version_string, kernel_name[kernel], s.threads);
+
+  std::vector<CodecResult> codec;
+  if (s.codec) {
+    const zfp_type types[] = { zfp_type_int32, zfp_type_int64, zfp_type_float, zfp_type_double };
+    for (uint dims = 1; dims <= 4; dims++) {
+      if (!(s.dims & (1u << (dims - 1))))
+        continue;
+      for (uint t = 0; t < 4; t++) {
+        zfp_type type = types[t];
+        // integer types have no exponent to bound the error by
+        std::vector<Mode> modes;
+        for (uint i = 0; i < s.rates.size(); i++)
+          modes.push_back(Mode(zfp_mode_fixed_rate, s.rates[i]));
+        modes.push_back(Mode(zfp_mode_fixed_precision, 16));
+        modes.push_back(Mode(zfp_mode_fixed_precision, 32));
+        if (type == zfp_type_float || type == zfp_type_double) {
+          modes.push_back(Mode(zfp_mode_fixed_accuracy, 1e-3));
+          modes.push_back(Mode(zfp_mode_fixed_accuracy, 1e-6));
+        }
+        modes.push_back(Mode(zfp_mode_reversible, 0));
+        for (uint f = 0; f < 3; f++)
+          for (uint m = 0; m < modes.size(); m++) {
+            size_t first = codec.size();
+            bench_codec(codec, s, dims, type, Field(f), modes[m]);
+            if (!s.quiet)
+              for (size_t i = first; i < codec.size(); i++)
+                print_codec(table, codec[i]);
+          }
+      }
+    }
+  }
+
+  std::vector<ArrayResult> arrays;
+  if (s.arrays) {
+    for (uint dims = 1; dims <= 3; dims++) {
+      if (!(s.dims & (1u << (dims - 1))))
+        continue;
+      for (uint i = 0; i < s.rates.size(); i++) {
+        size_t first = arrays.size();
+        bench_arrays<float>(arrays, s, dims, s.rates[i]);
+        bench_arrays<double>(arrays, s, dims, s.rates[i]);
+        if (!s.quiet)
+          for (size_t j = first; j < arrays.size(); j++)
+            print_array(table, arrays[j]);
+      }
+    }
+  }
+
+  if (s.json) {
+    FILE* file = std::strcmp(s.json, "-") ? std::fopen(s.json, "w") : stdout;
+    if (!file) {
+      std::fprintf(stderr, "cannot create file %s\n", s.json);
+      return EXIT_FAILURE;
+    }
+    write_json(file, s, kernel, codec, arrays);
+    if (file != stdout)
+      std::fclose(file);
+  }
+
+  return 0;
+}